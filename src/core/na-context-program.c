@@ -0,0 +1,1990 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gio/gio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glibtop/proclist.h>
+#include <glibtop/procstate.h>
+
+#include <api/na-core-utils.h>
+#include <api/na-object-api.h>
+
+#include "na-context-program.h"
+#include "na-selected-info.h"
+
+#define NA_CONTEXT_PROGRAM_DATA			"na-context-program-data"
+
+/* the snapshot of the running processes is kept during this delay
+ * when it is not requested through a cache (msec)
+ */
+#define RUNNING_PROCESSES_TTL			1000
+
+/* the result of a condition, as stored in the cache
+ */
+enum {
+	CACHE_UNSET = 0,
+	CACHE_FALSE,
+	CACHE_TRUE,
+};
+
+/* the selection is summarized for each kind of condition, basenames
+ * being summarized twice, whether the case is significant or not
+ */
+#define SUMMARY_BASENAMES_NOCASE		NA_CONTEXT_COND_N
+#define SUMMARY_N						( NA_CONTEXT_COND_N+1 )
+
+/* the kind of a mimetype condition
+ */
+enum {
+	MIMETYPE_ALL = 0,					/* all/all and its synonyms */
+	MIMETYPE_ALLFILES,					/* all/allfiles and its synonyms */
+	MIMETYPE_GROUP,						/* image/ *-like */
+	MIMETYPE_EXACT,						/* image/jpeg-like */
+};
+
+/* the kind of a basename condition
+ */
+enum {
+	BASENAME_GLOB = 0,					/* any other pattern */
+	BASENAME_ANY,						/* '*' */
+	BASENAME_EXACT,						/* without any wildcard */
+	BASENAME_SUFFIX,					/* '*' followed by a string without wildcard */
+};
+
+/* the known capabilities
+ */
+enum {
+	CAPABILITY_UNKNOWN = 0,
+	CAPABILITY_OWNER,
+	CAPABILITY_READABLE,
+	CAPABILITY_WRITABLE,
+	CAPABILITY_EXECUTABLE,
+	CAPABILITY_LOCAL,
+};
+
+/* a condition, once compiled:
+ * - pattern: the stripped string, without its negation sign
+ * - interned: for mimetypes and folders, the interned pattern
+ * - positive: whether this is a positive assertion
+ * - kind: for mimetypes, one of the MIMETYPE_xxx values
+ *         for basenames, one of the BASENAME_xxx values
+ *         for folders, whether the pattern contains a wildcard
+ *         for capabilities, one of the CAPABILITY_xxx values
+ * - len: the length of the pattern
+ */
+typedef struct {
+	gchar       *pattern;
+	const gchar *interned;
+	gboolean     positive;
+	guint        kind;
+	guint        len;
+}
+	ContextCond;
+
+typedef struct {
+	ContextCond *conds;
+	guint        count;
+}
+	ContextCondList;
+
+/* the basename patterns of one sign, indexed so that a basename is
+ * checked against all of them in one pass:
+ * - any: whether there is a '*' pattern
+ * - exact: the set of the patterns without wildcard
+ * - suffixes: the set of the suffixes of the '*xxx' patterns,
+ *   suffix_lengths being their distinct lengths
+ * - globs: the other patterns
+ * pointed-to strings are owned by the ContextCondList
+ */
+typedef struct {
+	gboolean     any;
+	GHashTable  *exact;
+	GHashTable  *suffixes;
+	GArray      *suffix_lengths;
+	GPtrArray   *globs;
+}
+	BasenameMatcher;
+
+/* the compiled program
+ * an empty list means that there is no condition to be checked
+ * keys are the interned canonical keys of the conditions, or NULL when
+ * there is no condition
+ */
+struct _NAContextProgram {
+	guint           ref_count;
+	const gchar    *keys[NA_CONTEXT_COND_N];
+	guint           attributes;
+	gboolean        all_mimetypes;
+	ContextCondList mimetypes;
+	gboolean        matchcase;
+	ContextCondList basenames;
+	BasenameMatcher positive_basenames;
+	BasenameMatcher negative_basenames;
+	ContextCondList schemes;
+	ContextCondList folders;
+	ContextCondList capabilities;
+	gchar           count_op;
+	gint            count_limit;
+};
+
+/* a cache of the results of the conditions for a given selection,
+ * indexed by canonical key
+ * count is the count of items of the selection
+ * processes is the set of the basenames of the running processes,
+ * taken once when first needed
+ * mimetypes memoizes the result of a whole mimetypes list for a file
+ * type, while content_types memoizes g_content_type_is_a() for a file
+ * type and a pattern
+ * folders associates each distinct dirname with the set of the folders
+ * patterns it matches, as long as no pattern has been indexed nor
+ * removed since folders_generation
+ * classes holds, for each kind of condition, one representative file of
+ * each equivalence class of the selection, i.e. of the files which
+ * cannot be distinguished by this kind of condition; it is computed on
+ * first need
+ * the capabilities classes are rather computed for each set of tested
+ * capabilities, so that a file is only queried for the capabilities
+ * which are actually tested (mask of kinds -> GList of files)
+ */
+struct _NAContextCache {
+	GHashTable     *results;
+	guint           hits;
+	guint           misses;
+	guint           count;
+	GHashTable     *processes;
+	GHashTable     *mimetypes;
+	GHashTable     *content_types;
+	GHashTable     *folders;
+	guint           folders_generation;
+	GList          *selection;
+	GList          *classes[SUMMARY_N];
+	gboolean        summarized[SUMMARY_N];
+	GHashTable     *capabilities_classes;
+};
+
+/* the key of the mimetypes memos
+ * - ftype: the interned mimetype of the file
+ * - what: the interned canonical key of the list, or the interned pattern
+ * - regular: whether the file is a regular file (only relevant for lists)
+ */
+typedef struct {
+	const gchar    *ftype;
+	const gchar    *what;
+	gboolean        regular;
+}
+	MimetypeMemoKey;
+
+/* the folders patterns of all the compiled programs are indexed in a
+ * trie of path segments, so that all the patterns matched by a dirname
+ * are found in one walk:
+ * - children: the nodes of the next segments
+ * - tails: the patterns without wildcard which end at this node, i.e.
+ *   whose last segment is to be found at the start of the rest of the
+ *   dirname
+ * - globs: the patterns whose first segment with a wildcard is the
+ *   next one
+ * patterns are identified by their interned string
+ *
+ * each pattern is counted once per condition of the living programs,
+ * and removed from the trie with its last condition, so that the trie
+ * only holds the patterns currently in use; the trie is shared by all
+ * the programs, and is so protected by st_folders_mutex
+ */
+typedef struct _FolderNode FolderNode;
+
+struct _FolderNode {
+	GHashTable     *children;
+	GPtrArray      *tails;
+	GPtrArray      *globs;
+};
+
+typedef struct {
+	const gchar    *pattern;
+	const gchar    *tail;
+	guint           len;
+}
+	FolderPattern;
+
+typedef void     ( *ContextCondCompileFn )( ContextCond *cond, void *user_data );
+typedef gboolean ( *ContextCondCheckFn )( const NAContextProgram *program, GList *files, NAContextCache *cache );
+
+static guint st_cache_hits   = 0;		/* cumulated since the plugin startup */
+static guint st_cache_misses = 0;
+
+static GHashTable *st_processes         = NULL;
+static gint64      st_processes_expires = 0;
+
+static GMutex      st_folders_mutex;
+static FolderNode *st_folders_root      = NULL;
+static GHashTable *st_folders_patterns  = NULL;	/* interned pattern -> count of conditions */
+static guint       st_folders_generation = 0;
+
+static NAContextProgram *program_new( const NAIContext *context );
+static NAContextProgram *program_ref( NAContextProgram *program );
+static void              program_unref( NAContextProgram *program );
+static const gchar      *compile_list( ContextCondList *list, GSList *strings, const gchar *prefix, ContextCondCompileFn fn, void *user_data );
+static gint              compare_strings( const gchar **a, const gchar **b );
+static void              compile_mimetype( ContextCond *cond, void *empty );
+static void              compile_basename( ContextCond *cond, NAContextProgram *program );
+static void              compile_basename_matcher( BasenameMatcher *matcher, const ContextCondList *list, gboolean positive );
+static void              free_basename_matcher( BasenameMatcher *matcher );
+static gboolean          is_basename_matched( const BasenameMatcher *matcher, const gchar *bname, guint len );
+static void              compile_scheme( ContextCond *cond, void *empty );
+static void              compile_folder( ContextCond *cond, void *empty );
+static void              compile_capability( ContextCond *cond, void *empty );
+static guint             get_capability_attribute( guint capability );
+static void              free_list( ContextCondList *list );
+static gboolean          is_trivial_list( GSList *strings, const gchar *trivial );
+static gboolean          is_candidate_for_mimetypes( const NAContextProgram *program, GList *files, NAContextCache *cache );
+static gboolean          is_candidate_for_basenames( const NAContextProgram *program, GList *files, NAContextCache *cache );
+static gboolean          is_candidate_for_selection_count( const NAContextProgram *program, GList *files, NAContextCache *cache );
+static gboolean          is_candidate_for_schemes( const NAContextProgram *program, GList *files, NAContextCache *cache );
+static gboolean          is_candidate_for_folders( const NAContextProgram *program, GList *files, NAContextCache *cache );
+static gboolean          is_candidate_for_capabilities( const NAContextProgram *program, GList *files, NAContextCache *cache );
+static gboolean          is_file_mimetype( const gchar *mimetype );
+static gboolean          is_mimetype_candidate( const NAContextProgram *program, const gchar *ftype, gboolean regular, NAContextCache *cache );
+static gboolean          is_mimetype_of( const ContextCond *cond, const gchar *ftype, gboolean is_regular, NAContextCache *cache );
+static guint             memo_key_hash( const MimetypeMemoKey *key );
+static gboolean          memo_key_equal( const MimetypeMemoKey *a, const MimetypeMemoKey *b );
+static gboolean          memo_lookup( GHashTable *memo, const MimetypeMemoKey *key, gboolean *result );
+static void              memo_insert( GHashTable *memo, const MimetypeMemoKey *key, gboolean result );
+static gboolean          is_compatible_scheme( const ContextCond *cond, const gchar *scheme );
+static gboolean          has_capability( const ContextCond *cond, const NASelectedInfo *nsi, const gchar *user );
+static gboolean          match_pattern( const gchar *pattern, const gchar *string );
+static GHashTable       *get_running_processes( void );
+static GList            *get_selection_classes( guint cond, const NAContextProgram *program, GList *files, NAContextCache *cache );
+static GList            *get_classes( guint summary, guint kinds, GList *files );
+static guint             get_capability_kinds( const NAContextProgram *program );
+static gchar            *get_class_key( guint summary, const NASelectedInfo *nsi, const gchar *user, guint kinds );
+static void              index_folder( const gchar *pattern, gboolean has_wildcard );
+static void              unindex_folder( const gchar *pattern, gboolean has_wildcard );
+static void              unindex_folders( const ContextCondList *list );
+static FolderNode       *folder_node_new( void );
+static gboolean          folder_node_is_empty( const FolderNode *node );
+static void              folder_node_free( FolderNode *node );
+static GHashTable       *get_matched_folders( const gchar *dirname, NAContextCache *cache );
+static GHashTable       *match_folders( const gchar *dirname );
+
+static const ContextCondCheckFn st_checks[NA_CONTEXT_COND_N] = {
+		is_candidate_for_mimetypes,
+		is_candidate_for_basenames,
+		is_candidate_for_selection_count,
+		is_candidate_for_schemes,
+		is_candidate_for_folders,
+		is_candidate_for_capabilities
+};
+
+/*
+ * na_context_program_compile:
+ * @context: the #NAIContext object.
+ *
+ * Compiles the conditions of @context, attaching the resulting program
+ * to the object, and replacing the previous one if any.
+ */
+void
+na_context_program_compile( NAIContext *context )
+{
+	NAContextProgram *program;
+
+	g_return_if_fail( NA_IS_ICONTEXT( context ));
+
+	program = program_new( context );
+
+	g_object_set_data_full( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA, program, ( GDestroyNotify ) program_unref );
+}
+
+/*
+ * na_context_program_get:
+ * @context: the #NAIContext object.
+ *
+ * Returns: the #NAContextProgram attached to @context, compiling it if
+ * needed. The returned program is owned by the @context object, and
+ * should not be released by the caller.
+ */
+NAContextProgram *
+na_context_program_get( const NAIContext *context )
+{
+	NAContextProgram *program;
+
+	g_return_val_if_fail( NA_IS_ICONTEXT( context ), NULL );
+
+	program = ( NAContextProgram * ) g_object_get_data( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA );
+
+	if( !program ){
+		na_context_program_compile( NA_ICONTEXT( context ));
+		program = ( NAContextProgram * ) g_object_get_data( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA );
+	}
+
+	return( program );
+}
+
+/*
+ * na_context_program_share:
+ * @context: the target #NAIContext object.
+ * @source: the source #NAIContext object.
+ *
+ * Makes @context share the program of @source, which is safe as long
+ * as @context has just been copied from @source.
+ */
+void
+na_context_program_share( NAIContext *context, const NAIContext *source )
+{
+	NAContextProgram *program;
+
+	g_return_if_fail( NA_IS_ICONTEXT( context ));
+	g_return_if_fail( NA_IS_ICONTEXT( source ));
+
+	program = ( NAContextProgram * ) g_object_get_data( G_OBJECT( source ), NA_CONTEXT_PROGRAM_DATA );
+
+	if( program ){
+		g_object_set_data_full( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA, program_ref( program ), ( GDestroyNotify ) program_unref );
+
+	} else {
+		g_object_set_data( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA, NULL );
+	}
+}
+
+/*
+ * na_context_program_invalidate:
+ * @context: the #NAIContext object.
+ * @name: the name of the modified data, or %NULL.
+ *
+ * Drops the program attached to @context if @name is one of the
+ * conditions it has been compiled from, or unconditionally if @name
+ * is %NULL.
+ */
+void
+na_context_program_invalidate( NAIContext *context, const gchar *name )
+{
+	static const gchar *compiled[] = {
+			NAFO_DATA_MIMETYPES,
+			NAFO_DATA_BASENAMES,
+			NAFO_DATA_MATCHCASE,
+			NAFO_DATA_SELECTION_COUNT,
+			NAFO_DATA_SCHEMES,
+			NAFO_DATA_FOLDERS,
+			NAFO_DATA_CAPABILITITES,
+			NULL };
+	guint i;
+
+	g_return_if_fail( NA_IS_ICONTEXT( context ));
+
+	if( !g_object_get_data( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA )){
+		return;
+	}
+
+	if( name ){
+		for( i = 0 ; compiled[i] ; ++i ){
+			if( !strcmp( name, compiled[i] )){
+				break;
+			}
+		}
+		if( !compiled[i] ){
+			return;
+		}
+	}
+
+	g_object_set_data( G_OBJECT( context ), NA_CONTEXT_PROGRAM_DATA, NULL );
+}
+
+/*
+ * na_context_program_get_required_attributes:
+ * @context: the #NAIContext object.
+ *
+ * Returns: the NA_SELECTED_INFO_ATTRIBUTE_xxx attributes which have to
+ * be known for each selected file in order to evaluate the conditions
+ * of @context.
+ */
+guint
+na_context_program_get_required_attributes( const NAIContext *context )
+{
+	const NAContextProgram *program;
+
+	g_return_val_if_fail( NA_IS_ICONTEXT( context ), 0 );
+
+	program = na_context_program_get( context );
+
+	return( program ? program->attributes : 0 );
+}
+
+/*
+ * na_context_program_is_all_mimetype:
+ * @mimetype: a mimetype condition, without its negation sign.
+ *
+ * Returns: %TRUE if @mimetype is one of the synonyms of 'all/all'.
+ */
+gboolean
+na_context_program_is_all_mimetype( const gchar *mimetype )
+{
+	return( !strcmp( mimetype, "*" ) ||
+			!strcmp( mimetype, "*/*" ) ||
+			!strcmp( mimetype, "*/all" ) ||	/* should be considered as invalid */
+			!strcmp( mimetype, "all" ) ||
+			!strcmp( mimetype, "all/*" ) ||
+			!strcmp( mimetype, "all/all" ));
+}
+
+/*
+ * na_context_program_is_candidate:
+ * @program: the #NAContextProgram.
+ * @files: the current selection, as a #GList of #NASelectedInfo items.
+ * @cache: [allow-none]: a #NAContextCache for this same selection.
+ *
+ * Returns: %TRUE if the current selection satisfies all the conditions
+ * of the @program, %FALSE else.
+ */
+gboolean
+na_context_program_is_candidate( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	gboolean ok;
+	guint i;
+
+	g_return_val_if_fail( program, FALSE );
+
+	ok = TRUE;
+
+	for( i = 0 ; i < NA_CONTEXT_COND_N && ok ; ++i ){
+		ok = na_context_program_is_candidate_for( program, i, files, cache );
+	}
+
+	return( ok );
+}
+
+/*
+ * na_context_program_is_candidate_for:
+ * @program: the #NAContextProgram.
+ * @cond: the NA_CONTEXT_COND_xxx condition to be checked.
+ * @files: the current selection, as a #GList of #NASelectedInfo items.
+ * @cache: [allow-none]: a #NAContextCache for this same selection.
+ *
+ * Returns: %TRUE if the current selection satisfies the @cond condition
+ * of the @program, or if the @program does not have such a condition,
+ * %FALSE else.
+ */
+gboolean
+na_context_program_is_candidate_for( const NAContextProgram *program, guint cond, GList *files, NAContextCache *cache )
+{
+	gboolean ok;
+	guint cached;
+	GHashTable *results;
+
+	g_return_val_if_fail( program, FALSE );
+	g_return_val_if_fail( cond < NA_CONTEXT_COND_N, FALSE );
+
+	if( !program->keys[cond] ){
+		return( TRUE );
+	}
+
+	/* the results are only valid for the selection the cache has been
+	 * created for
+	 */
+	results = ( cache && files == cache->selection ) ? cache->results : NULL;
+
+	if( results ){
+		cached = GPOINTER_TO_UINT( g_hash_table_lookup( results, program->keys[cond] ));
+		if( cached != CACHE_UNSET ){
+			cache->hits += 1;
+			return( cached == CACHE_TRUE );
+		}
+		cache->misses += 1;
+	}
+
+	ok = ( *st_checks[cond] )( program, get_selection_classes( cond, program, files, cache ), cache );
+
+	if( results ){
+		g_hash_table_insert( results,
+				( gpointer ) program->keys[cond], GUINT_TO_POINTER( ok ? CACHE_TRUE : CACHE_FALSE ));
+	}
+
+	return( ok );
+}
+
+/*
+ * na_context_cache_new:
+ * @selection: the current selection, as a #GList of #NASelectedInfo items.
+ *
+ * Returns: a new #NAContextCache, which should be na_context_cache_free()
+ * by the caller.
+ *
+ * The cache is only valid for this @selection. It summarizes it in
+ * equivalence classes, so that most conditions are only checked once for
+ * each distinct mimetype, scheme, dirname, etc.
+ */
+NAContextCache *
+na_context_cache_new( GList *selection )
+{
+	NAContextCache *cache;
+
+	cache = g_new0( NAContextCache, 1 );
+	cache->selection = selection;
+	cache->count = g_list_length( selection );
+
+	/* keys are interned strings */
+	cache->results = g_hash_table_new( g_direct_hash, g_direct_equal );
+	cache->mimetypes = g_hash_table_new_full(( GHashFunc ) memo_key_hash, ( GEqualFunc ) memo_key_equal, g_free, NULL );
+	cache->content_types = g_hash_table_new_full(( GHashFunc ) memo_key_hash, ( GEqualFunc ) memo_key_equal, g_free, NULL );
+	cache->folders = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) g_hash_table_destroy );
+	cache->capabilities_classes = g_hash_table_new_full( g_direct_hash, g_direct_equal, NULL, ( GDestroyNotify ) g_list_free );
+
+	return( cache );
+}
+
+/*
+ * na_context_cache_free:
+ * @cache: the #NAContextCache to be released.
+ *
+ * Releases the @cache, after having dumped its hit rate.
+ */
+void
+na_context_cache_free( NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_cache_free";
+	guint total, i;
+
+	g_return_if_fail( cache );
+
+	st_cache_hits += cache->hits;
+	st_cache_misses += cache->misses;
+
+	total = cache->hits + cache->misses;
+	g_debug( "%s: distinct=%u, hits=%u, misses=%u, hit rate=%u%%",
+			thisfn, g_hash_table_size( cache->results ), cache->hits, cache->misses,
+			total ? ( 100 * cache->hits ) / total : 0 );
+
+	total = st_cache_hits + st_cache_misses;
+	g_debug( "%s: cumulated hits=%u, misses=%u, hit rate=%u%%",
+			thisfn, st_cache_hits, st_cache_misses,
+			total ? ( 100 * st_cache_hits ) / total : 0 );
+
+	g_hash_table_destroy( cache->results );
+	g_hash_table_destroy( cache->mimetypes );
+	g_hash_table_destroy( cache->content_types );
+	g_hash_table_destroy( cache->folders );
+	for( i = 0 ; i < SUMMARY_N ; ++i ){
+		g_list_free( cache->classes[i] );
+	}
+	g_hash_table_destroy( cache->capabilities_classes );
+	if( cache->processes ){
+		g_hash_table_unref( cache->processes );
+	}
+	g_free( cache );
+}
+
+/*
+ * na_context_cache_get_running_processes:
+ * @cache: [allow-none]: a #NAContextCache.
+ *
+ * Returns: the set of the basenames of the running processes.
+ *
+ * The snapshot is taken at most once for a given @cache, i.e. once per
+ * built menu. Without cache, the last snapshot is reused during a short
+ * delay.
+ *
+ * The returned #GHashTable is owned by the @cache, or by this module,
+ * and should not be released by the caller.
+ */
+GHashTable *
+na_context_cache_get_running_processes( NAContextCache *cache )
+{
+	if( !cache ){
+		return( get_running_processes());
+	}
+
+	if( !cache->processes ){
+		cache->processes = g_hash_table_ref( get_running_processes());
+	}
+
+	return( cache->processes );
+}
+
+/*
+ * the snapshot is replaced when it has expired, but the caches which
+ * still reference the previous one keep it alive
+ */
+static GHashTable *
+get_running_processes( void )
+{
+	static const gchar *thisfn = "na_context_program_get_running_processes";
+	glibtop_proclist proclist;
+	glibtop_proc_state procstate;
+	pid_t *pid_list;
+	guint i;
+	gint64 now;
+
+	now = g_get_monotonic_time();
+
+	if( !st_processes || now >= st_processes_expires ){
+		if( st_processes ){
+			g_hash_table_unref( st_processes );
+		}
+		st_processes = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+
+		pid_list = glibtop_get_proclist( &proclist, GLIBTOP_KERN_PROC_ALL, 0 );
+
+		for( i = 0 ; i < proclist.number ; ++i ){
+			glibtop_get_proc_state( &procstate, pid_list[i] );
+			g_hash_table_add( st_processes, g_strdup( procstate.cmd ));
+		}
+
+		g_free( pid_list );
+
+		st_processes_expires = now + RUNNING_PROCESSES_TTL * 1000;
+		g_debug( "%s: %u processes, %u distinct commands",
+				thisfn, ( guint ) proclist.number, g_hash_table_size( st_processes ));
+	}
+
+	return( st_processes );
+}
+
+/*
+ * the checks are run against one representative file of each equivalence
+ * class of the selection: this is only possible for the selection the
+ * cache has been created for, and does not apply to the selection count
+ */
+static GList *
+get_selection_classes( guint cond, const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	guint summary, kinds;
+	GList *classes;
+
+	if( !cache || files != cache->selection || cond == NA_CONTEXT_COND_SELECTION_COUNT ){
+		return( files );
+	}
+
+	if( cond == NA_CONTEXT_COND_CAPABILITIES ){
+		kinds = get_capability_kinds( program );
+		classes = ( GList * ) g_hash_table_lookup( cache->capabilities_classes, GUINT_TO_POINTER( kinds ));
+
+		if( !classes ){
+			classes = get_classes( cond, kinds, files );
+			g_hash_table_insert( cache->capabilities_classes, GUINT_TO_POINTER( kinds ), classes );
+		}
+
+		return( classes );
+	}
+
+	summary = ( cond == NA_CONTEXT_COND_BASENAMES && !program->matchcase ) ? SUMMARY_BASENAMES_NOCASE : cond;
+
+	if( !cache->summarized[summary] ){
+		cache->classes[summary] = get_classes( summary, 0, files );
+		cache->summarized[summary] = TRUE;
+	}
+
+	return( cache->classes[summary] );
+}
+
+/*
+ * Returns: one representative file of each equivalence class of @files
+ * regarding the @summary kind of conditions, as a new list
+ * @kinds: for capabilities, the mask of the tested kinds
+ */
+static GList *
+get_classes( guint summary, guint kinds, GList *files )
+{
+	static const gchar *thisfn = "na_context_program_get_classes";
+	GHashTable *keys;
+	const gchar *user;
+	gchar *key;
+	GList *it, *classes;
+
+	keys = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+	user = ( summary == NA_CONTEXT_COND_CAPABILITIES ) ? getlogin() : NULL;
+	classes = NULL;
+
+	for( it = files ; it ; it = it->next ){
+		key = get_class_key( summary, NA_SELECTED_INFO( it->data ), user, kinds );
+
+		if( !key ){
+			classes = g_list_prepend( classes, it->data );
+
+		} else if( !g_hash_table_contains( keys, key )){
+			g_hash_table_add( keys, key );
+			classes = g_list_prepend( classes, it->data );
+
+		} else {
+			g_free( key );
+		}
+	}
+
+	classes = g_list_reverse( classes );
+
+	g_debug( "%s: cond=%u, kinds=%u, files=%u, classes=%u",
+			thisfn, summary, kinds, g_list_length( files ), g_list_length( classes ));
+
+	g_hash_table_destroy( keys );
+
+	return( classes );
+}
+
+/*
+ * Returns: a key which identifies the equivalence class of the @nsi file
+ * regarding the @summary kind of conditions, or %NULL if the file must be
+ * checked by itself
+ * @kinds: for capabilities, only the tested kinds are queried, so that
+ *  the key does not cost more than the check itself
+ */
+static gchar *
+get_class_key( guint summary, const NASelectedInfo *nsi, const gchar *user, guint kinds )
+{
+	ContextCond cond;
+	const gchar *str;
+	guint mask;
+
+	switch( summary ){
+		case NA_CONTEXT_COND_MIMETYPES:
+			str = na_selected_info_peek_mime_type( nsi );
+			return( str ? g_strdup_printf( "%c%s", na_selected_info_is_regular( nsi ) ? 'r' : '-', str ) : NULL );
+
+		case NA_CONTEXT_COND_BASENAMES:
+			return( g_strdup( na_selected_info_peek_basename_utf8( nsi, TRUE )));
+
+		case SUMMARY_BASENAMES_NOCASE:
+			return( g_strdup( na_selected_info_peek_basename_utf8( nsi, FALSE )));
+
+		case NA_CONTEXT_COND_SCHEMES:
+			return( g_strdup( na_selected_info_peek_uri_scheme( nsi )));
+
+		case NA_CONTEXT_COND_FOLDERS:
+			return( g_strdup( na_selected_info_peek_dirname_utf8( nsi )));
+
+		case NA_CONTEXT_COND_CAPABILITIES:
+			mask = 0;
+			for( cond.kind = CAPABILITY_OWNER ; cond.kind <= CAPABILITY_LOCAL ; ++cond.kind ){
+				if(( kinds & ( 1 << cond.kind )) && has_capability( &cond, nsi, user )){
+					mask |= 1 << cond.kind;
+				}
+			}
+			return( g_strdup_printf( "%u", mask ));
+	}
+
+	return( NULL );
+}
+
+/*
+ * Returns: the mask of the capability kinds tested by the @program
+ */
+static guint
+get_capability_kinds( const NAContextProgram *program )
+{
+	guint kinds, i;
+
+	kinds = 0;
+
+	for( i = 0 ; i < program->capabilities.count ; ++i ){
+		kinds |= 1 << program->capabilities.conds[i].kind;
+	}
+
+	return( kinds );
+}
+
+/*
+ * object may embed a list of - possibly negated - mimetypes
+ * each file of the selection must satisfy all conditions of this list
+ * an empty list is considered the same as '*' or '* / *'
+ *
+ * most time, we will just have '*' - so try to optimize the code to
+ * be as fast as possible when we don't filter on mimetype
+ *
+ * mimetypes are of type : "image/ *; !image/jpeg"
+ * file mimetype must be compatible with at least one positive assertion
+ * (they are ORed), while not being of any negative assertions (they are
+ * ANDed)
+ *
+ * here, for each mimetype of the selection, do
+ * . match is FALSE while this mimetype has not matched a positive assertion
+ * . nomatch is FALSE while this mimetype has not matched a negative assertion
+ * we are going to check each mimetype filter
+ *  while we have not found a match among positive conditions (i.e. while !match)
+ *  we have to check all negative conditions to verify that the current
+ *  examined mimetype never match these
+ */
+static gboolean
+is_candidate_for_mimetypes( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_candidate_for_mimetypes";
+	gboolean ok = TRUE;
+	GList *it;
+
+	g_debug( "%s: all=%s", thisfn, program->all_mimetypes ? "True":"False" );
+
+	if( !program->all_mimetypes ){
+
+		for( it = files ; it && ok ; it = it->next ){
+			const NASelectedInfo *nsi = NA_SELECTED_INFO( it->data );
+			const gchar *ftype = na_selected_info_peek_mime_type( nsi );
+
+			if( !ftype ){
+				g_warning( "%s: null mimetype found for %s", thisfn, na_selected_info_peek_uri( nsi ));
+				ok = FALSE;
+				break;
+			}
+
+			ok = is_mimetype_candidate( program, ftype, na_selected_info_is_regular( nsi ), cache );
+		}
+	}
+
+	return( ok );
+}
+
+static gboolean
+is_candidate_for_basenames( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_candidate_for_basenames";
+	gboolean ok = TRUE;
+	GList *it;
+
+	for( it = files ; it && ok && program->basenames.count ; it = it->next ){
+		const gchar *bname = na_selected_info_peek_basename_utf8( NA_SELECTED_INFO( it->data ), program->matchcase );
+		guint len = strlen( bname );
+
+		if( is_basename_matched( &program->negative_basenames, bname, len )){
+			g_debug( "%s: negative match found for basename=%s", thisfn, bname );
+			ok = FALSE;
+
+		} else if( !is_basename_matched( &program->positive_basenames, bname, len )){
+			g_debug( "%s: no positive match found for basename=%s", thisfn, bname );
+			ok = FALSE;
+		}
+	}
+
+	return( ok );
+}
+
+static gboolean
+is_candidate_for_selection_count( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_candidate_for_selection_count";
+	gboolean ok = TRUE;
+	gint count;
+
+	if( program->count_op ){
+		count = ( gint )(( cache && files == cache->selection ) ? cache->count : g_list_length( files ));
+
+		switch( program->count_op ){
+			case '<':
+				ok = ( count < program->count_limit );
+				break;
+			case '=':
+				ok = ( count == program->count_limit );
+				break;
+			case '>':
+				ok = ( count > program->count_limit );
+				break;
+			default:
+				ok = FALSE;
+				break;
+		}
+
+		if( !ok ){
+			g_debug( "%s: object is not candidate because SelectionCount=%c%d",
+					thisfn, program->count_op, program->count_limit );
+		}
+	}
+
+	return( ok );
+}
+
+/*
+ * it is likely that all selected items have the same scheme, because they
+ * are all in the same location and the scheme mainly depends on location
+ * so we only check a scheme when it is not the same than the one of the
+ * previous selected item
+ */
+static gboolean
+is_candidate_for_schemes( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_candidate_for_schemes";
+	gboolean ok = TRUE;
+	const gchar *prev = NULL;
+	GList *it;
+	guint i;
+
+	for( it = files ; it && ok && program->schemes.count ; it = it->next ){
+		const gchar *scheme = na_selected_info_peek_uri_scheme( NA_SELECTED_INFO( it->data ));
+		gboolean match = FALSE;
+
+		if( prev && !g_strcmp0( prev, scheme )){
+			continue;
+		}
+		prev = scheme;
+
+		for( i = 0 ; i < program->schemes.count && ok ; ++i ){
+			const ContextCond *cond = &program->schemes.conds[i];
+
+			if( !cond->positive || !match ){
+				if( is_compatible_scheme( cond, scheme )){
+					if( cond->positive ){
+						match = TRUE;
+					} else {
+						ok = FALSE;
+					}
+				}
+			}
+		}
+
+		ok &= match;
+
+		if( !ok ){
+			g_debug( "%s: object is not candidate because of scheme=%s", thisfn, scheme );
+		}
+	}
+
+	return( ok );
+}
+
+/*
+ * assuming here the same sort of optimization than for schemes
+ * i.e. we assume that all selected items are most probably located
+ * in the same dirname
+ */
+static gboolean
+is_candidate_for_folders( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_candidate_for_folders";
+	gboolean ok = TRUE;
+	GHashTable *distincts, *matched;
+	GList *it;
+	guint i;
+
+	if( !program->folders.count ){
+		return( TRUE );
+	}
+
+	distincts = g_hash_table_new( g_str_hash, g_str_equal );
+
+	for( it = files ; it && ok ; it = it->next ){
+		const gchar *dirname = na_selected_info_peek_dirname_utf8( NA_SELECTED_INFO( it->data ));
+
+		if( g_hash_table_contains( distincts, dirname )){
+			continue;
+		}
+		g_hash_table_add( distincts, ( gpointer ) dirname );
+
+		matched = get_matched_folders( dirname, cache );
+
+		for( i = 0 ; i < program->folders.count && ok ; ++i ){
+			const ContextCond *cond = &program->folders.conds[i];
+			gboolean match = g_hash_table_contains( matched, cond->interned );
+
+			ok &= ( match && cond->positive ) || ( !match && !cond->positive );
+		}
+
+		if( !cache ){
+			g_hash_table_destroy( matched );
+		}
+
+		if( !ok ){
+			g_debug( "%s: object is not candidate because of dirname=%s", thisfn, dirname );
+		}
+	}
+
+	g_hash_table_destroy( distincts );
+
+	return( ok );
+}
+
+static gboolean
+is_candidate_for_capabilities( const NAContextProgram *program, GList *files, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_candidate_for_capabilities";
+	gboolean ok = TRUE;
+	const gchar *user = NULL;
+	GList *it;
+	guint i;
+
+	if( program->capabilities.count ){
+		user = getlogin();
+	}
+
+	for( it = files ; it && ok && program->capabilities.count ; it = it->next ){
+		for( i = 0 ; i < program->capabilities.count && ok ; ++i ){
+			const ContextCond *cond = &program->capabilities.conds[i];
+			gboolean match = has_capability( cond, NA_SELECTED_INFO( it->data ), user );
+
+			ok &= (( cond->positive && match ) || ( !cond->positive && !match ));
+
+			if( !ok ){
+				g_debug( "%s: object is not candidate because of capability %s%s",
+						thisfn, cond->positive ? "" : "!", cond->pattern );
+			}
+		}
+	}
+
+	return( ok );
+}
+
+static NAContextProgram *
+program_new( const NAIContext *context )
+{
+	static const gchar *thisfn = "na_context_program_new";
+	NAContextProgram *program;
+	GSList *strings;
+	gchar *selection_count;
+	gchar *key;
+	guint i;
+
+	program = g_new0( NAContextProgram, 1 );
+	program->ref_count = 1;
+
+	strings = na_object_get_mimetypes( context );
+	program->keys[NA_CONTEXT_COND_MIMETYPES] =
+			compile_list( &program->mimetypes, strings, "MimeTypes", ( ContextCondCompileFn ) compile_mimetype, NULL );
+	na_core_utils_slist_free( strings );
+
+	/* a negated 'all/all' condition matches nothing: it must be kept
+	 */
+	program->all_mimetypes = TRUE;
+	for( i = 0 ; i < program->mimetypes.count ; ++i ){
+		if( !program->mimetypes.conds[i].positive || program->mimetypes.conds[i].kind != MIMETYPE_ALL ){
+			program->all_mimetypes = FALSE;
+			break;
+		}
+	}
+	if( program->all_mimetypes ){
+		program->keys[NA_CONTEXT_COND_MIMETYPES] = NULL;
+
+	} else {
+		program->attributes |= NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE;
+		for( i = 0 ; i < program->mimetypes.count ; ++i ){
+			if( program->mimetypes.conds[i].kind == MIMETYPE_ALLFILES ){
+				program->attributes |= NA_SELECTED_INFO_ATTRIBUTE_TYPE;
+			}
+		}
+	}
+
+	program->matchcase = na_object_get_matchcase( context );
+	strings = na_object_get_basenames( context );
+	if( !is_trivial_list( strings, "*" )){
+		program->keys[NA_CONTEXT_COND_BASENAMES] =
+				compile_list( &program->basenames, strings,
+						program->matchcase ? "Basenames" : "Basenames(nocase)", ( ContextCondCompileFn ) compile_basename, program );
+		compile_basename_matcher( &program->positive_basenames, &program->basenames, TRUE );
+		compile_basename_matcher( &program->negative_basenames, &program->basenames, FALSE );
+	}
+	na_core_utils_slist_free( strings );
+
+	strings = na_object_get_schemes( context );
+	if( !is_trivial_list( strings, "*" )){
+		program->keys[NA_CONTEXT_COND_SCHEMES] =
+				compile_list( &program->schemes, strings, "Schemes", ( ContextCondCompileFn ) compile_scheme, NULL );
+	}
+	na_core_utils_slist_free( strings );
+
+	strings = na_object_get_folders( context );
+	if( !is_trivial_list( strings, "/" )){
+		program->keys[NA_CONTEXT_COND_FOLDERS] =
+				compile_list( &program->folders, strings, "Folders", ( ContextCondCompileFn ) compile_folder, NULL );
+	}
+	na_core_utils_slist_free( strings );
+
+	strings = na_object_get_capabilities( context );
+	program->keys[NA_CONTEXT_COND_CAPABILITIES] =
+			compile_list( &program->capabilities, strings, "Capabilities", ( ContextCondCompileFn ) compile_capability, NULL );
+	na_core_utils_slist_free( strings );
+
+	for( i = 0 ; i < program->capabilities.count ; ++i ){
+		program->attributes |= get_capability_attribute( program->capabilities.conds[i].kind );
+	}
+
+	selection_count = na_object_get_selection_count( context );
+	if( selection_count && strlen( selection_count )){
+		program->count_op = selection_count[0];
+		program->count_limit = atoi( selection_count+1 );
+		key = g_strdup_printf( "SelectionCount=%c%d", program->count_op, program->count_limit );
+		program->keys[NA_CONTEXT_COND_SELECTION_COUNT] = g_intern_string( key );
+		g_free( key );
+	}
+	g_free( selection_count );
+
+	g_debug( "%s: context=%p, mimetypes=%u (all=%s), basenames=%u, schemes=%u, folders=%u, capabilities=%u, count=%c%d",
+			thisfn, ( void * ) context,
+			program->mimetypes.count, program->all_mimetypes ? "True":"False",
+			program->basenames.count, program->schemes.count, program->folders.count,
+			program->capabilities.count,
+			program->count_op ? program->count_op : ' ', program->count_limit );
+
+	return( program );
+}
+
+static NAContextProgram *
+program_ref( NAContextProgram *program )
+{
+	program->ref_count += 1;
+
+	return( program );
+}
+
+static void
+program_unref( NAContextProgram *program )
+{
+	program->ref_count -= 1;
+
+	if( !program->ref_count ){
+		free_list( &program->mimetypes );
+		free_list( &program->basenames );
+		free_basename_matcher( &program->positive_basenames );
+		free_basename_matcher( &program->negative_basenames );
+		free_list( &program->schemes );
+		unindex_folders( &program->folders );
+		free_list( &program->folders );
+		free_list( &program->capabilities );
+		g_free( program );
+	}
+}
+
+/*
+ * "image/ *" is a positive assertion
+ * "!image/jpeg" is a negative one
+ *
+ * empty strings are ignored
+ *
+ * the result of a list of conditions does not depend of the order of
+ * these conditions, so the canonical key is built from the sorted list
+ * of distinct compiled conditions
+ *
+ * Returns: the interned canonical key, or %NULL if the list is empty.
+ */
+static const gchar *
+compile_list( ContextCondList *list, GSList *strings, const gchar *prefix, ContextCondCompileFn fn, void *user_data )
+{
+	GSList *is;
+	gchar *stripped;
+	GPtrArray *sorted;
+	GString *key;
+	const gchar *interned;
+	guint i;
+
+	list->conds = g_new0( ContextCond, g_slist_length( strings ));
+	list->count = 0;
+
+	for( is = strings ; is ; is = is->next ){
+		stripped = g_strstrip( g_strdup(( const gchar * ) is->data ));
+
+		if( strlen( stripped )){
+			ContextCond *cond = &list->conds[list->count];
+			cond->positive = ( stripped[0] != '!' );
+			cond->pattern = g_strdup( cond->positive ? stripped : stripped+1 );
+			cond->len = strlen( cond->pattern );
+			cond->kind = 0;
+			( *fn )( cond, user_data );
+			list->count += 1;
+		}
+
+		g_free( stripped );
+	}
+
+	if( !list->count ){
+		return( NULL );
+	}
+
+	sorted = g_ptr_array_sized_new( list->count );
+	for( i = 0 ; i < list->count ; ++i ){
+		g_ptr_array_add( sorted, g_strdup_printf( "%c%s", list->conds[i].positive ? '+' : '-', list->conds[i].pattern ));
+	}
+	g_ptr_array_sort( sorted, ( GCompareFunc ) compare_strings );
+
+	key = g_string_new( prefix );
+	for( i = 0 ; i < sorted->len ; ++i ){
+		if( i == 0 || strcmp( g_ptr_array_index( sorted, i ), g_ptr_array_index( sorted, i-1 ))){
+			g_string_append_printf( key, ";%s", ( const gchar * ) g_ptr_array_index( sorted, i ));
+		}
+	}
+	interned = g_intern_string( key->str );
+
+	g_string_free( key, TRUE );
+	g_ptr_array_foreach( sorted, ( GFunc ) g_free, NULL );
+	g_ptr_array_free( sorted, TRUE );
+
+	return( interned );
+}
+
+/*
+ * g_ptr_array_sort() provides pointers to the elements
+ */
+static gint
+compare_strings( const gchar **a, const gchar **b )
+{
+	return( strcmp( *a, *b ));
+}
+
+static void
+compile_mimetype( ContextCond *cond, void *empty )
+{
+	cond->interned = g_intern_string( cond->pattern );
+
+	if( na_context_program_is_all_mimetype( cond->pattern )){
+		cond->kind = MIMETYPE_ALL;
+
+	} else if( is_file_mimetype( cond->pattern )){
+		cond->kind = MIMETYPE_ALLFILES;
+
+	} else if( g_str_has_suffix( cond->pattern, "/*" )){
+		cond->kind = MIMETYPE_GROUP;
+		cond->len -= 1;
+
+	} else {
+		cond->kind = MIMETYPE_EXACT;
+	}
+}
+
+static void
+compile_basename( ContextCond *cond, NAContextProgram *program )
+{
+	gchar *tmp;
+
+	tmp = g_filename_to_utf8( cond->pattern, -1, NULL, NULL, NULL );
+	if( tmp ){
+		g_free( cond->pattern );
+		cond->pattern = tmp;
+	}
+
+	if( !program->matchcase ){
+		tmp = g_utf8_strdown( cond->pattern, -1 );
+		g_free( cond->pattern );
+		cond->pattern = tmp;
+	}
+
+	cond->len = strlen( cond->pattern );
+
+	if( !strcmp( cond->pattern, "*" )){
+		cond->kind = BASENAME_ANY;
+
+	} else if( !strpbrk( cond->pattern, "*?" )){
+		cond->kind = BASENAME_EXACT;
+
+	} else if( cond->pattern[0] == '*' && !strpbrk( cond->pattern+1, "*?" )){
+		cond->kind = BASENAME_SUFFIX;
+
+	} else {
+		cond->kind = BASENAME_GLOB;
+	}
+}
+
+/*
+ * index the patterns of the given sign
+ */
+static void
+compile_basename_matcher( BasenameMatcher *matcher, const ContextCondList *list, gboolean positive )
+{
+	guint i, j, len;
+
+	for( i = 0 ; i < list->count ; ++i ){
+		const ContextCond *cond = &list->conds[i];
+
+		if( cond->positive != positive ){
+			continue;
+		}
+
+		switch( cond->kind ){
+			case BASENAME_ANY:
+				matcher->any = TRUE;
+				break;
+
+			case BASENAME_EXACT:
+				if( !matcher->exact ){
+					matcher->exact = g_hash_table_new( g_str_hash, g_str_equal );
+				}
+				g_hash_table_add( matcher->exact, cond->pattern );
+				break;
+
+			case BASENAME_SUFFIX:
+				if( !matcher->suffixes ){
+					matcher->suffixes = g_hash_table_new( g_str_hash, g_str_equal );
+					matcher->suffix_lengths = g_array_new( FALSE, FALSE, sizeof( guint ));
+				}
+				g_hash_table_add( matcher->suffixes, cond->pattern+1 );
+				len = cond->len-1;
+				for( j = 0 ; j < matcher->suffix_lengths->len ; ++j ){
+					if( g_array_index( matcher->suffix_lengths, guint, j ) == len ){
+						break;
+					}
+				}
+				if( j == matcher->suffix_lengths->len ){
+					g_array_append_val( matcher->suffix_lengths, len );
+				}
+				break;
+
+			default:
+				if( !matcher->globs ){
+					matcher->globs = g_ptr_array_new();
+				}
+				g_ptr_array_add( matcher->globs, cond->pattern );
+				break;
+		}
+	}
+}
+
+static void
+free_basename_matcher( BasenameMatcher *matcher )
+{
+	if( matcher->exact ){
+		g_hash_table_destroy( matcher->exact );
+	}
+	if( matcher->suffixes ){
+		g_hash_table_destroy( matcher->suffixes );
+		g_array_free( matcher->suffix_lengths, TRUE );
+	}
+	if( matcher->globs ){
+		g_ptr_array_free( matcher->globs, TRUE );
+	}
+}
+
+/*
+ * Returns: %TRUE if the basename matches at least one of the patterns:
+ * one lookup for all exact patterns, one lookup per distinct length for
+ * all suffix patterns, and only the other patterns one by one
+ */
+static gboolean
+is_basename_matched( const BasenameMatcher *matcher, const gchar *bname, guint len )
+{
+	guint i, suffix_len;
+
+	if( matcher->any ){
+		return( TRUE );
+	}
+
+	if( matcher->exact && g_hash_table_contains( matcher->exact, bname )){
+		return( TRUE );
+	}
+
+	if( matcher->suffixes ){
+		for( i = 0 ; i < matcher->suffix_lengths->len ; ++i ){
+			suffix_len = g_array_index( matcher->suffix_lengths, guint, i );
+			if( suffix_len <= len && g_hash_table_contains( matcher->suffixes, bname+len-suffix_len )){
+				return( TRUE );
+			}
+		}
+	}
+
+	if( matcher->globs ){
+		for( i = 0 ; i < matcher->globs->len ; ++i ){
+			if( match_pattern(( const gchar * ) g_ptr_array_index( matcher->globs, i ), bname )){
+				return( TRUE );
+			}
+		}
+	}
+
+	return( FALSE );
+}
+
+static void
+compile_scheme( ContextCond *cond, void *empty )
+{
+	cond->kind = ( strcmp( cond->pattern, "*" ) == 0 );
+}
+
+static void
+compile_folder( ContextCond *cond, void *empty )
+{
+	gchar *tmp;
+
+	tmp = g_filename_to_utf8( cond->pattern, -1, NULL, NULL, NULL );
+	if( tmp ){
+		g_free( cond->pattern );
+		cond->pattern = tmp;
+		cond->len = strlen( cond->pattern );
+	}
+
+	cond->kind = ( strchr( cond->pattern, '*' ) != NULL );
+	cond->interned = g_intern_string( cond->pattern );
+
+	index_folder( cond->interned, cond->kind );
+}
+
+/*
+ * add the pattern to the trie, unless it is already there, and count
+ * this new condition
+ *
+ * a pattern without wildcard matches a dirname if it is a prefix of it,
+ * so we go down while the segments of the pattern are followed by a
+ * slash, the last one being kept as the tail
+ *
+ * a pattern with a wildcard may also match a dirname as a glob, so we
+ * only go down while the segments do not contain a wildcard
+ */
+static void
+index_folder( const gchar *pattern, gboolean has_wildcard )
+{
+	FolderNode *node, *child;
+	FolderPattern *folder;
+	const gchar *segment, *slash, *wildcard;
+	gchar *key;
+	guint count;
+
+	g_mutex_lock( &st_folders_mutex );
+
+	if( !st_folders_root ){
+		st_folders_root = folder_node_new();
+		st_folders_patterns = g_hash_table_new( g_direct_hash, g_direct_equal );
+	}
+
+	count = GPOINTER_TO_UINT( g_hash_table_lookup( st_folders_patterns, pattern ));
+	g_hash_table_insert( st_folders_patterns, ( gpointer ) pattern, GUINT_TO_POINTER( count+1 ));
+
+	if( count ){
+		g_mutex_unlock( &st_folders_mutex );
+		return;
+	}
+	st_folders_generation += 1;
+
+	node = st_folders_root;
+	segment = pattern;
+	wildcard = has_wildcard ? strchr( pattern, '*' ) : NULL;
+
+	while(( slash = strchr( segment, '/' )) != NULL && ( !wildcard || slash < wildcard )){
+		key = g_strndup( segment, slash-segment );
+		child = ( FolderNode * ) g_hash_table_lookup( node->children, key );
+		if( !child ){
+			child = folder_node_new();
+			g_hash_table_insert( node->children, key, child );
+		} else {
+			g_free( key );
+		}
+		node = child;
+		segment = slash+1;
+	}
+
+	folder = g_new0( FolderPattern, 1 );
+	folder->pattern = pattern;
+	folder->tail = segment;
+
+	if( wildcard ){
+		folder->len = strlen( pattern );
+		g_ptr_array_add( node->globs, folder );
+
+	} else {
+		folder->len = strlen( segment );
+		g_ptr_array_add( node->tails, folder );
+	}
+
+	g_mutex_unlock( &st_folders_mutex );
+}
+
+/*
+ * forget a condition on the pattern, removing the pattern from the trie
+ * with its last condition
+ *
+ * we go down the same way as when indexing the pattern, then prune
+ * the nodes which have become empty on the way back up
+ */
+static void
+unindex_folder( const gchar *pattern, gboolean has_wildcard )
+{
+	FolderNode *node;
+	FolderPattern *folder;
+	GPtrArray *nodes, *keys, *patterns;
+	const gchar *segment, *slash, *wildcard;
+	gchar *key;
+	guint count, i;
+
+	g_mutex_lock( &st_folders_mutex );
+
+	count = st_folders_patterns ? GPOINTER_TO_UINT( g_hash_table_lookup( st_folders_patterns, pattern )) : 0;
+
+	if( count > 1 ){
+		g_hash_table_insert( st_folders_patterns, ( gpointer ) pattern, GUINT_TO_POINTER( count-1 ));
+	}
+
+	if( count != 1 ){
+		g_mutex_unlock( &st_folders_mutex );
+		return;
+	}
+	g_hash_table_remove( st_folders_patterns, pattern );
+	st_folders_generation += 1;
+
+	nodes = g_ptr_array_new();
+	keys = g_ptr_array_new_with_free_func( g_free );
+	node = st_folders_root;
+	segment = pattern;
+	wildcard = has_wildcard ? strchr( pattern, '*' ) : NULL;
+
+	while( node && ( slash = strchr( segment, '/' )) != NULL && ( !wildcard || slash < wildcard )){
+		key = g_strndup( segment, slash-segment );
+		g_ptr_array_add( nodes, node );
+		g_ptr_array_add( keys, key );
+		node = ( FolderNode * ) g_hash_table_lookup( node->children, key );
+		segment = slash+1;
+	}
+
+	if( node ){
+		patterns = wildcard ? node->globs : node->tails;
+		for( i = 0 ; i < patterns->len ; ++i ){
+			folder = ( FolderPattern * ) g_ptr_array_index( patterns, i );
+			if( folder->pattern == pattern ){
+				g_ptr_array_remove_index_fast( patterns, i );
+				break;
+			}
+		}
+
+		/* removing a child from its parent frees it
+		 */
+		for( i = nodes->len ; i > 0 && folder_node_is_empty( node ) ; --i ){
+			node = ( FolderNode * ) g_ptr_array_index( nodes, i-1 );
+			g_hash_table_remove( node->children, g_ptr_array_index( keys, i-1 ));
+		}
+	}
+
+	g_ptr_array_free( keys, TRUE );
+	g_ptr_array_free( nodes, TRUE );
+
+	if( !g_hash_table_size( st_folders_patterns )){
+		folder_node_free( st_folders_root );
+		st_folders_root = NULL;
+		g_hash_table_destroy( st_folders_patterns );
+		st_folders_patterns = NULL;
+	}
+
+	g_mutex_unlock( &st_folders_mutex );
+}
+
+static void
+unindex_folders( const ContextCondList *list )
+{
+	guint i;
+
+	for( i = 0 ; i < list->count ; ++i ){
+		unindex_folder( list->conds[i].interned, list->conds[i].kind );
+	}
+}
+
+static FolderNode *
+folder_node_new( void )
+{
+	FolderNode *node;
+
+	node = g_new0( FolderNode, 1 );
+	node->children = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) folder_node_free );
+	node->tails = g_ptr_array_new_with_free_func( g_free );
+	node->globs = g_ptr_array_new_with_free_func( g_free );
+
+	return( node );
+}
+
+static gboolean
+folder_node_is_empty( const FolderNode *node )
+{
+	return( !g_hash_table_size( node->children ) && !node->tails->len && !node->globs->len );
+}
+
+static void
+folder_node_free( FolderNode *node )
+{
+	g_hash_table_destroy( node->children );
+	g_ptr_array_free( node->tails, TRUE );
+	g_ptr_array_free( node->globs, TRUE );
+	g_free( node );
+}
+
+/*
+ * Returns: the set of the interned folders patterns matched by the
+ * dirname, either from the cache, or as a new set which has to be
+ * g_hash_table_destroy() by the caller when there is no cache.
+ */
+static GHashTable *
+get_matched_folders( const gchar *dirname, NAContextCache *cache )
+{
+	GHashTable *matched;
+
+	g_mutex_lock( &st_folders_mutex );
+
+	if( !cache ){
+		matched = match_folders( dirname );
+
+	} else {
+		/* a program may have been compiled or released since the sets
+		 * have been computed
+		 */
+		if( cache->folders_generation != st_folders_generation ){
+			g_hash_table_remove_all( cache->folders );
+			cache->folders_generation = st_folders_generation;
+		}
+
+		matched = ( GHashTable * ) g_hash_table_lookup( cache->folders, dirname );
+
+		if( !matched ){
+			matched = match_folders( dirname );
+			g_hash_table_insert( cache->folders, g_strdup( dirname ), matched );
+		}
+	}
+
+	g_mutex_unlock( &st_folders_mutex );
+
+	return( matched );
+}
+
+/*
+ * walk down the trie along the segments of the dirname, collecting
+ * the matched patterns at each visited node
+ *
+ * st_folders_mutex is expected to be held by the caller
+ */
+static GHashTable *
+match_folders( const gchar *dirname )
+{
+	GHashTable *matched;
+	FolderNode *node;
+	FolderPattern *folder;
+	const gchar *segment, *slash;
+	gchar *key;
+	guint i;
+
+	matched = g_hash_table_new( g_direct_hash, g_direct_equal );
+	node = st_folders_root;
+	segment = dirname;
+
+	while( node ){
+		for( i = 0 ; i < node->tails->len ; ++i ){
+			folder = ( FolderPattern * ) g_ptr_array_index( node->tails, i );
+			if( !strncmp( segment, folder->tail, folder->len )){
+				g_hash_table_add( matched, ( gpointer ) folder->pattern );
+			}
+		}
+
+		for( i = 0 ; i < node->globs->len ; ++i ){
+			folder = ( FolderPattern * ) g_ptr_array_index( node->globs, i );
+			if( match_pattern( folder->pattern, dirname ) || !strncmp( dirname, folder->pattern, folder->len )){
+				g_hash_table_add( matched, ( gpointer ) folder->pattern );
+			}
+		}
+
+		slash = strchr( segment, '/' );
+		if( !slash ){
+			break;
+		}
+
+		key = g_strndup( segment, slash-segment );
+		node = ( FolderNode * ) g_hash_table_lookup( node->children, key );
+		g_free( key );
+		segment = slash+1;
+	}
+
+	return( matched );
+}
+
+static void
+compile_capability( ContextCond *cond, void *empty )
+{
+	static const gchar *thisfn = "na_context_program_compile_capability";
+
+	if( !strcmp( cond->pattern, "Owner" )){
+		cond->kind = CAPABILITY_OWNER;
+
+	} else if( !strcmp( cond->pattern, "Readable" )){
+		cond->kind = CAPABILITY_READABLE;
+
+	} else if( !strcmp( cond->pattern, "Writable" )){
+		cond->kind = CAPABILITY_WRITABLE;
+
+	} else if( !strcmp( cond->pattern, "Executable" )){
+		cond->kind = CAPABILITY_EXECUTABLE;
+
+	} else if( !strcmp( cond->pattern, "Local" )){
+		cond->kind = CAPABILITY_LOCAL;
+
+	} else {
+		g_warning( "%s: unknown capability %s", thisfn, cond->pattern );
+		cond->kind = CAPABILITY_UNKNOWN;
+	}
+}
+
+/*
+ * the Local capability only depends of the URI scheme
+ */
+static guint
+get_capability_attribute( guint capability )
+{
+	switch( capability ){
+		case CAPABILITY_OWNER:
+			return( NA_SELECTED_INFO_ATTRIBUTE_OWNER );
+		case CAPABILITY_READABLE:
+			return( NA_SELECTED_INFO_ATTRIBUTE_CAN_READ );
+		case CAPABILITY_WRITABLE:
+			return( NA_SELECTED_INFO_ATTRIBUTE_CAN_WRITE );
+		case CAPABILITY_EXECUTABLE:
+			return( NA_SELECTED_INFO_ATTRIBUTE_CAN_EXECUTE );
+	}
+
+	return( 0 );
+}
+
+static void
+free_list( ContextCondList *list )
+{
+	guint i;
+
+	for( i = 0 ; i < list->count ; ++i ){
+		g_free( list->conds[i].pattern );
+	}
+
+	g_free( list->conds );
+}
+
+/*
+ * a list which only contains the trivial pattern is not a condition
+ */
+static gboolean
+is_trivial_list( GSList *strings, const gchar *trivial )
+{
+	return( !strings || ( !strings->next && !strcmp(( const gchar * ) strings->data, trivial )));
+}
+
+static gboolean
+is_file_mimetype( const gchar *mimetype )
+{
+	return( !strcmp( mimetype, "allfiles" ) ||
+			!strcmp( mimetype, "*/allfiles" ) ||	/* should be considered as invalid */
+			!strcmp( mimetype, "allfiles/*" ) ||
+			!strcmp( mimetype, "allfiles/all" ) ||
+			!strcmp( mimetype, "all/allfiles" ));
+}
+
+/*
+ * whether a file of the given type satisfies the mimetypes list
+ *
+ * as a selection usually only contains a few distinct types, the result
+ * is memoized per (file type, mimetypes list) for the current popup
+ */
+static gboolean
+is_mimetype_candidate( const NAContextProgram *program, const gchar *ftype, gboolean regular, NAContextCache *cache )
+{
+	static const gchar *thisfn = "na_context_program_is_mimetype_candidate";
+	MimetypeMemoKey key;
+	gboolean ok, match;
+	guint i;
+
+	if( cache ){
+		key.ftype = g_intern_string( ftype );
+		key.what = program->keys[NA_CONTEXT_COND_MIMETYPES];
+		key.regular = regular;
+
+		if( memo_lookup( cache->mimetypes, &key, &ok )){
+			return( ok );
+		}
+		ftype = key.ftype;
+	}
+
+	ok = TRUE;
+	match = FALSE;
+
+	for( i = 0 ; i < program->mimetypes.count && ok ; ++i ){
+		const ContextCond *cond = &program->mimetypes.conds[i];
+
+		if( !cond->positive || !match ){
+			if( is_mimetype_of( cond, ftype, regular, cache )){
+				if( cond->positive ){
+					match = TRUE;
+				} else {
+					ok = FALSE;
+				}
+			}
+		}
+	}
+
+	if( !match ){
+		g_debug( "%s: no positive match found for mimetype=%s", thisfn, ftype );
+		ok = FALSE;
+	}
+
+	if( cache ){
+		memo_insert( cache->mimetypes, &key, ok );
+	}
+
+	return( ok );
+}
+
+/*
+ * does the file fgroup/fsubgroup have a mimetype which is 'a sort of'
+ *  mimetype specified one ?
+ * for example, "image/jpeg" is clearly a sort of "image/ *"
+ *
+ * content type if the same as the mime type in *nix;
+ * this is not true on Win32 platforms
+ *
+ * the exact and group matches are checked first, as they do not need
+ * any lookup in the shared mime database
+ *
+ * when a cache is provided, ftype is interned
+ */
+static gboolean
+is_mimetype_of( const ContextCond *cond, const gchar *ftype, gboolean is_regular, NAContextCache *cache )
+{
+	MimetypeMemoKey key;
+	gboolean is_a;
+
+	switch( cond->kind ){
+		case MIMETYPE_ALL:
+			return( TRUE );
+
+		case MIMETYPE_ALLFILES:
+			return( is_regular );
+
+		case MIMETYPE_GROUP:
+			if( !strncmp( ftype, cond->pattern, cond->len )){
+				return( TRUE );
+			}
+			break;
+
+		default:
+			if( ftype == cond->interned || !strcmp( ftype, cond->pattern )){
+				return( TRUE );
+			}
+			break;
+	}
+
+	if( !cache ){
+		return( g_content_type_is_a( ftype, cond->pattern ));
+	}
+
+	key.ftype = ftype;
+	key.what = cond->interned;
+	key.regular = FALSE;
+
+	if( !memo_lookup( cache->content_types, &key, &is_a )){
+		is_a = g_content_type_is_a( ftype, cond->pattern );
+		memo_insert( cache->content_types, &key, is_a );
+	}
+
+	return( is_a );
+}
+
+static guint
+memo_key_hash( const MimetypeMemoKey *key )
+{
+	return( g_direct_hash( key->ftype ) * 31 + g_direct_hash( key->what ) * 2 + ( key->regular ? 1 : 0 ));
+}
+
+static gboolean
+memo_key_equal( const MimetypeMemoKey *a, const MimetypeMemoKey *b )
+{
+	return( a->ftype == b->ftype && a->what == b->what && a->regular == b->regular );
+}
+
+static gboolean
+memo_lookup( GHashTable *memo, const MimetypeMemoKey *key, gboolean *result )
+{
+	gpointer value;
+
+	if( g_hash_table_lookup_extended( memo, key, NULL, &value )){
+		*result = GPOINTER_TO_UINT( value );
+		return( TRUE );
+	}
+
+	return( FALSE );
+}
+
+static void
+memo_insert( GHashTable *memo, const MimetypeMemoKey *key, gboolean result )
+{
+	MimetypeMemoKey *copy;
+
+	copy = g_new( MimetypeMemoKey, 1 );
+	*copy = *key;
+	g_hash_table_insert( memo, copy, GUINT_TO_POINTER( result ));
+}
+
+static gboolean
+is_compatible_scheme( const ContextCond *cond, const gchar *scheme )
+{
+	return( cond->kind || !g_strcmp0( cond->pattern, scheme ));
+}
+
+static gboolean
+has_capability( const ContextCond *cond, const NASelectedInfo *nsi, const gchar *user )
+{
+	const gchar *owner;
+
+	switch( cond->kind ){
+		case CAPABILITY_OWNER:
+			owner = na_selected_info_peek_owner( nsi );
+			return( user && owner && !strcmp( owner, user ));
+
+		case CAPABILITY_READABLE:
+			return( na_selected_info_is_readable( nsi ));
+
+		case CAPABILITY_WRITABLE:
+			return( na_selected_info_is_writable( nsi ));
+
+		case CAPABILITY_EXECUTABLE:
+			return( na_selected_info_is_executable( nsi ));
+
+		case CAPABILITY_LOCAL:
+			return( na_selected_info_is_local( nsi ));
+	}
+
+	return( FALSE );
+}
+
+/*
+ * the same than g_pattern_match_simple(), i.e. '*' and '?' wildcards
+ * on UTF-8 strings, without compiling a GPatternSpec each time
+ *
+ * literal characters are compared byte per byte, which is safe with
+ * UTF-8 as we only ever restart the comparison on a character boundary
+ */
+static gboolean
+match_pattern( const gchar *pattern, const gchar *string )
+{
+	const gchar *star_pattern = NULL;
+	const gchar *star_string = NULL;
+
+	while( *string ){
+		if( *pattern == '*' ){
+			star_pattern = ++pattern;
+			star_string = string;
+
+		} else if( *pattern == '?' ){
+			pattern++;
+			string = g_utf8_next_char( string );
+
+		} else if( *pattern && *pattern == *string ){
+			pattern++;
+			string++;
+
+		} else if( star_pattern ){
+			pattern = star_pattern;
+			star_string = g_utf8_next_char( star_string );
+			string = star_string;
+
+		} else {
+			return( FALSE );
+		}
+	}
+
+	while( *pattern == '*' ){
+		pattern++;
+	}
+
+	return( *pattern == '\0' );
+}
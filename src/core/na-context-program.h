@@ -0,0 +1,105 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __CORE_NA_CONTEXT_PROGRAM_H__
+#define __CORE_NA_CONTEXT_PROGRAM_H__
+
+/* @title: NAContextProgram
+ * @short_description: The compiled conditions of a #NAIContext
+ * @include: core/na-context-program.h
+ *
+ * The list-based conditions of a #NAIContext object (mimetypes,
+ * basenames, schemes, folders and capabilities), along with the
+ * selection count, are parsed once, when the object has been read,
+ * into a #NAContextProgram attached to the object.
+ *
+ * Evaluating a program against the current selection does not
+ * allocate any memory.
+ *
+ * The program is dropped as soon as one of the conditions it has been
+ * compiled from is modified, and compiled again on next use.
+ *
+ * Each compiled condition is identified by a canonical key, which only
+ * depends on its content. As many actions and profiles share the same
+ * conditions, a #NAContextCache may be used while building a menu, so
+ * that each distinct condition is only evaluated once for a given
+ * selection.
+ *
+ * The same #NAContextCache also holds the snapshot of the running
+ * processes used to check the ShowIfRunning conditions, so that the
+ * process table is only scanned once per menu.
+ *
+ * Declare the function only accessed from core library, i.e. not
+ * published as API.
+ */
+
+#include <api/na-icontext.h>
+
+G_BEGIN_DECLS
+
+typedef struct _NAContextProgram NAContextProgram;
+typedef struct _NAContextCache   NAContextCache;
+
+/* the compiled conditions, in the order they are checked by
+ * na_context_program_is_candidate()
+ */
+enum {
+	NA_CONTEXT_COND_MIMETYPES = 0,
+	NA_CONTEXT_COND_BASENAMES,
+	NA_CONTEXT_COND_SELECTION_COUNT,
+	NA_CONTEXT_COND_SCHEMES,
+	NA_CONTEXT_COND_FOLDERS,
+	NA_CONTEXT_COND_CAPABILITIES,
+	NA_CONTEXT_COND_N
+};
+
+void              na_context_program_compile   ( NAIContext *context );
+NAContextProgram *na_context_program_get       ( const NAIContext *context );
+void              na_context_program_share     ( NAIContext *context, const NAIContext *source );
+void              na_context_program_invalidate( NAIContext *context, const gchar *name );
+
+guint             na_context_program_get_required_attributes( const NAIContext *context );
+gboolean          na_context_program_is_all_mimetype        ( const gchar *mimetype );
+
+gboolean          na_context_program_is_candidate    ( const NAContextProgram *program, GList *files, NAContextCache *cache );
+gboolean          na_context_program_is_candidate_for( const NAContextProgram *program, guint cond, GList *files, NAContextCache *cache );
+
+NAContextCache   *na_context_cache_new ( GList *selection );
+void              na_context_cache_free( NAContextCache *cache );
+
+GHashTable       *na_context_cache_get_running_processes( NAContextCache *cache );
+
+/* implemented in na-icontext.c
+ */
+gboolean          na_icontext_is_candidate_cached( const NAIContext *context, guint target, GList *selection, NAContextCache *cache );
+gboolean          na_icontext_is_candidate_cheap ( const NAIContext *context, guint target, GList *selection, NAContextCache *cache );
+
+G_END_DECLS
+
+#endif /* __CORE_NA_CONTEXT_PROGRAM_H__ */
@@ -42,6 +42,7 @@
 #include <api/na-ifactory-provider.h>
 #include <api/na-object-api.h>
 
+#include "na-context-program.h"
 #include "na-factory-object.h"
 #include "na-factory-provider.h"
 
@@ -92,6 +93,15 @@ typedef struct {
 extern gboolean                   ifactory_object_initialized;
 extern gboolean                   ifactory_object_finalized;
 
+/* each NADataDef name is given a slot, i.e. an index in a dense per-object
+ * array of NADataBoxed; slots are assigned at class initialization, and
+ * are shared by all the classes which define the same name
+ */
+static GHashTable                *st_slots       = NULL;	/* name -> slot+1 */
+static guint                      st_slots_count = 0;
+static GHashTable                *st_defs        = NULL;	/* NADataGroup -> GPtrArray of NADataDef, indexed by slot */
+static GQuark                     st_boxed_quark = 0;		/* NAIFactoryObject -> GPtrArray of NADataBoxed, indexed by slot */
+
 static gboolean     define_class_properties_iter( const NADataDef *def, GObjectClass *class );
 static gboolean     set_defaults_iter( NADataDef *def, NafoDefaultIter *data );
 static gboolean     is_valid_mandatory_iter( const NADataDef *def, NafoValidIter *data );
@@ -107,7 +117,12 @@ static void         v_read_done( NAIFactoryObject *serializable, const NAIFactor
 static guint        v_write_start( NAIFactoryObject *serializable, const NAIFactoryProvider *reader, void *reader_data, GSList **messages );
 static guint        v_write_done( NAIFactoryObject *serializable, const NAIFactoryProvider *reader, void *reader_data, GSList **messages );
 
+static void         register_slots( const NADataGroup *groups );
+static GPtrArray   *get_boxed_slots( const NAIFactoryObject *object );
+static void         set_boxed_slot( NAIFactoryObject *object, const NADataDef *def, NADataBoxed *boxed );
 static void         attach_boxed_to_object( NAIFactoryObject *object, NADataBoxed *boxed );
+static NADataBoxed *get_writable_boxed( NAIFactoryObject *object, NADataBoxed *boxed );
+static void         invalidate_context( NAIFactoryObject *object, const gchar *name );
 static void         free_data_boxed_list( NAIFactoryObject *object );
 static void         iter_on_data_defs( const NADataGroup *idgroups, guint mode, NADataDefIterFunc pfn, void *user_data );
 
@@ -116,7 +131,8 @@ static void         iter_on_data_defs( const NADataGroup *idgroups, guint mode,
  * @class: the #GObjectClass.
  * @groups: the list of #NADataGroup structure which define the data of the class.
  *
- * Initializes all the properties for the class.
+ * Initializes all the properties for the class, and registers the slots
+ * of its data.
  */
 void
 na_factory_object_define_properties( GObjectClass *class, const NADataGroup *groups )
@@ -131,6 +147,8 @@ na_factory_object_define_properties( GObjectClass *class, const NADataGroup *gro
 	/* define class properties
 	 */
 	iter_on_data_defs( groups, DATA_DEF_ITER_SET_PROPERTIES, ( NADataDefIterFunc ) define_class_properties_iter, class );
+
+	register_slots( groups );
 }
 
 static gboolean
@@ -167,12 +185,24 @@ NADataDef *
 na_factory_object_get_data_def( const NAIFactoryObject *object, const gchar *name )
 {
 	NADataDef *def;
+	GPtrArray *defs;
+	guint slot;
 
 	g_return_val_if_fail( NA_IS_IFACTORY_OBJECT( object ), NULL );
 
 	def = NULL;
 
 	NADataGroup *groups = v_get_groups( object );
+
+	defs = st_defs ? ( GPtrArray * ) g_hash_table_lookup( st_defs, groups ) : NULL;
+	if( defs ){
+		slot = na_factory_object_get_slot( name );
+		if( slot < defs->len ){
+			def = ( NADataDef * ) g_ptr_array_index( defs, slot );
+		}
+		return( def );
+	}
+
 	while( groups->group ){
 
 		NADataDef *def = groups->def;
@@ -191,6 +221,101 @@ na_factory_object_get_data_def( const NAIFactoryObject *object, const gchar *nam
 	return( def );
 }
 
+/*
+ * na_factory_object_get_slot:
+ * @name: the name of a #NADataDef.
+ *
+ * Returns: the slot assigned to this @name, or %NA_FACTORY_OBJECT_NO_SLOT
+ * if no class has registered it.
+ *
+ * The slot is stable for the life of the program, and so may be cached
+ * by the caller.
+ */
+guint
+na_factory_object_get_slot( const gchar *name )
+{
+	guint slot;
+
+	slot = st_slots ? GPOINTER_TO_UINT( g_hash_table_lookup( st_slots, name )) : 0;
+
+	return( slot ? slot-1 : NA_FACTORY_OBJECT_NO_SLOT );
+}
+
+/*
+ * na_factory_object_get_boxed_by_slot:
+ * @object: this #NAIFactoryObject object.
+ * @slot: the slot of the searched data.
+ *
+ * Returns: the #NADataBoxed attached to the @object at this @slot, or
+ * %NULL. The returned reference is owned by the @object.
+ */
+NADataBoxed *
+na_factory_object_get_boxed_by_slot( const NAIFactoryObject *object, guint slot )
+{
+	GPtrArray *slots;
+
+	slots = get_boxed_slots( object );
+
+	if( slots && slot < slots->len ){
+		return( NA_DATA_BOXED( g_ptr_array_index( slots, slot )));
+	}
+
+	return( NULL );
+}
+
+/*
+ * na_factory_object_get_boxed:
+ * @object: this #NAIFactoryObject object.
+ * @name: the name of the searched data.
+ *
+ * Returns: the #NADataBoxed attached to the @object for this @name, or
+ * %NULL. The returned reference is owned by the @object.
+ */
+NADataBoxed *
+na_factory_object_get_boxed( const NAIFactoryObject *object, const gchar *name )
+{
+	GList *list, *ip;
+	guint slot;
+
+	slot = na_factory_object_get_slot( name );
+	if( slot != NA_FACTORY_OBJECT_NO_SLOT ){
+		return( na_factory_object_get_boxed_by_slot( object, slot ));
+	}
+
+	/* a class which has not registered its data
+	 */
+	list = g_object_get_data( G_OBJECT( object ), NA_IFACTORY_OBJECT_PROP_DATA );
+
+	for( ip = list ; ip ; ip = ip->next ){
+		NADataBoxed *boxed = NA_DATA_BOXED( ip->data );
+		const NADataDef *def = na_data_boxed_get_data_def( boxed );
+
+		if( !strcmp( def->name, name )){
+			return( boxed );
+		}
+	}
+
+	return( NULL );
+}
+
+/*
+ * na_factory_object_peek_by_slot:
+ * @object: this #NAIFactoryObject instance.
+ * @slot: the slot of the elementary data whose value is to be got.
+ *
+ * Returns: the searched value, as a pointer which is owned by the
+ * @object (see na_factory_object_peek_as_void()).
+ */
+gconstpointer
+na_factory_object_peek_by_slot( const NAIFactoryObject *object, guint slot )
+{
+	NADataBoxed *boxed;
+
+	boxed = na_factory_object_get_boxed_by_slot( object, slot );
+
+	return( boxed ? na_boxed_get_pointer( NA_BOXED( boxed )) : NULL );
+}
+
 /*
  * na_factory_object_get_data_groups:
  * @object: the #NAIFactoryObject instance.
@@ -311,6 +436,7 @@ set_defaults_iter( NADataDef *def, NafoDefaultIter *data )
 		boxed = na_data_boxed_new( def );
 		attach_boxed_to_object( data->object, boxed );
 		na_boxed_set_from_string( NA_BOXED( boxed ), def->default_value );
+		invalidate_context( data->object, def->name );
 	}
 
 	/* do not stop */
@@ -335,14 +461,18 @@ na_factory_object_move_boxed( NAIFactoryObject *target, const NAIFactoryObject *
 	GList *src_list = g_object_get_data( G_OBJECT( source ), NA_IFACTORY_OBJECT_PROP_DATA );
 
 	if( g_list_find( src_list, boxed )){
+		boxed = get_writable_boxed(( NAIFactoryObject * ) source, boxed );
+		src_list = g_object_get_data( G_OBJECT( source ), NA_IFACTORY_OBJECT_PROP_DATA );
 		src_list = g_list_remove( src_list, boxed );
 		g_object_set_data( G_OBJECT( source ), NA_IFACTORY_OBJECT_PROP_DATA, src_list );
 
-		attach_boxed_to_object( target, boxed );
-
 		const NADataDef *src_def = na_data_boxed_get_data_def( boxed );
+		set_boxed_slot(( NAIFactoryObject * ) source, src_def, NULL );
+
 		NADataDef *tgt_def = na_factory_object_get_data_def( target, src_def->name );
 		na_data_boxed_set_data_def( boxed, tgt_def );
+
+		attach_boxed_to_object( target, boxed );
 	}
 }
 
@@ -353,6 +483,11 @@ na_factory_object_move_boxed( NAIFactoryObject *target, const NAIFactoryObject *
  *
  * Copies one instance to another.
  * Takes care of not overriding provider data.
+ *
+ * The copyable #NADataBoxed of @source are shared with @target rather
+ * than duplicated: each of them is only copied when it is first set in
+ * either object (see get_writable_boxed()). So a duplicate which only
+ * has a few data modified only allocates these ones.
  */
 void
 na_factory_object_copy( NAIFactoryObject *target, const NAIFactoryObject *source )
@@ -383,12 +518,14 @@ na_factory_object_copy( NAIFactoryObject *target, const NAIFactoryObject *source
 		inext = idest->next;
 		def = na_data_boxed_get_data_def( boxed );
 		if( def->copyable ){
+			set_boxed_slot( target, def, NULL );
 			dest_list = g_list_remove_link( dest_list, idest );
 			g_object_unref( idest->data );
 		}
 		idest = inext;
 	}
 	g_object_set_data( G_OBJECT( target ), NA_IFACTORY_OBJECT_PROP_DATA, dest_list );
+	invalidate_context( target, NULL );
 
 	/* only then copy copyable data from source
 	 */
@@ -399,10 +536,12 @@ na_factory_object_copy( NAIFactoryObject *target, const NAIFactoryObject *source
 		if( def->copyable ){
 			NADataBoxed *tgt_boxed = na_ifactory_object_get_data_boxed( target, def->name );
 			if( !tgt_boxed ){
-				tgt_boxed = na_data_boxed_new( def );
-				attach_boxed_to_object( target, tgt_boxed );
+				attach_boxed_to_object( target, g_object_ref( boxed ));
+
+			} else {
+				tgt_boxed = get_writable_boxed( target, tgt_boxed );
+				na_boxed_set_from_boxed( NA_BOXED( tgt_boxed ), NA_BOXED( boxed ));
 			}
-			na_boxed_set_from_boxed( NA_BOXED( tgt_boxed ), NA_BOXED( boxed ));
 		}
 	}
 
@@ -639,6 +778,7 @@ read_data_iter( NADataDef *def, NafoReadIter *iter )
 		NADataBoxed *exist = na_ifactory_object_get_data_boxed( iter->object, def->name );
 
 		if( exist ){
+			exist = get_writable_boxed( iter->object, exist );
 			na_boxed_set_from_boxed( NA_BOXED( exist ), NA_BOXED( boxed ));
 			g_object_unref( boxed );
 
@@ -747,6 +887,35 @@ na_factory_object_get_as_value( const NAIFactoryObject *object, const gchar *nam
 	}
 }
 
+/*
+ * na_factory_object_peek_as_void:
+ * @object: this #NAIFactoryObject instance.
+ * @name: the elementary data whose value is to be got.
+ *
+ * Returns: the searched value, without any copy.
+ *
+ * The returned value is owned by the @object, and is only valid until
+ * this data is set again, or the @object is finalized. It should not be
+ * modified nor released by the caller.
+ */
+gconstpointer
+na_factory_object_peek_as_void( const NAIFactoryObject *object, const gchar *name )
+{
+	gconstpointer value;
+	NADataBoxed *boxed;
+
+	g_return_val_if_fail( NA_IS_IFACTORY_OBJECT( object ), NULL );
+
+	value = NULL;
+
+	boxed = na_ifactory_object_get_data_boxed( object, name );
+	if( boxed ){
+		value = na_boxed_get_pointer( NA_BOXED( boxed ));
+	}
+
+	return( value );
+}
+
 /*
  * na_factory_object_get_as_void:
  * @object: this #NAIFactoryObject instance.
@@ -814,6 +983,7 @@ na_factory_object_set_from_value( NAIFactoryObject *object, const gchar *name, c
 
 	NADataBoxed *boxed = na_ifactory_object_get_data_boxed( object, name );
 	if( boxed ){
+		boxed = get_writable_boxed( object, boxed );
 		na_boxed_set_from_value( NA_BOXED( boxed ), value );
 
 	} else {
@@ -827,6 +997,8 @@ na_factory_object_set_from_value( NAIFactoryObject *object, const gchar *name, c
 			attach_boxed_to_object( object, boxed );
 		}
 	}
+
+	invalidate_context( object, name );
 }
 
 /*
@@ -846,6 +1018,7 @@ na_factory_object_set_from_void( NAIFactoryObject *object, const gchar *name, co
 
 	NADataBoxed *boxed = na_ifactory_object_get_data_boxed( object, name );
 	if( boxed ){
+		boxed = get_writable_boxed( object, boxed );
 		na_boxed_set_from_void( NA_BOXED( boxed ), data );
 
 	} else {
@@ -859,6 +1032,8 @@ na_factory_object_set_from_void( NAIFactoryObject *object, const gchar *name, co
 			attach_boxed_to_object( object, boxed );
 		}
 	}
+
+	invalidate_context( object, name );
 }
 
 static NADataGroup *
@@ -939,12 +1114,138 @@ v_write_done( NAIFactoryObject *serializable, const NAIFactoryProvider *writer,
 	return( code );
 }
 
+/*
+ * assign a slot to each data of the groups, whether it has a property
+ * or not, and keep the defs of this class indexed by these slots
+ */
+static void
+register_slots( const NADataGroup *groups )
+{
+	const NADataGroup *igroup;
+	NADataDef *def;
+	GPtrArray *defs;
+	guint slot;
+
+	if( !st_slots ){
+		st_slots = g_hash_table_new( g_str_hash, g_str_equal );
+		st_defs = g_hash_table_new_full( g_direct_hash, g_direct_equal, NULL, ( GDestroyNotify ) g_ptr_array_unref );
+		st_boxed_quark = g_quark_from_static_string( "na-ifactory-object-prop-slots" );
+	}
+
+	for( igroup = groups ; igroup->group ; igroup++ ){
+		for( def = igroup->def ; def && def->name ; def++ ){
+			if( !g_hash_table_lookup( st_slots, def->name )){
+				g_hash_table_insert( st_slots, def->name, GUINT_TO_POINTER( ++st_slots_count ));
+			}
+		}
+	}
+
+	defs = g_ptr_array_sized_new( st_slots_count );
+	g_ptr_array_set_size( defs, st_slots_count );
+
+	for( igroup = groups ; igroup->group ; igroup++ ){
+		for( def = igroup->def ; def && def->name ; def++ ){
+			slot = na_factory_object_get_slot( def->name );
+			if( !g_ptr_array_index( defs, slot )){
+				g_ptr_array_index( defs, slot ) = def;
+			}
+		}
+	}
+
+	g_hash_table_replace( st_defs, ( gpointer ) groups, defs );
+}
+
+static GPtrArray *
+get_boxed_slots( const NAIFactoryObject *object )
+{
+	return( st_boxed_quark ? ( GPtrArray * ) g_object_get_qdata( G_OBJECT( object ), st_boxed_quark ) : NULL );
+}
+
+/*
+ * the array is grown on demand, as a class may have been registered
+ * after the object has been allocated
+ */
+static void
+set_boxed_slot( NAIFactoryObject *object, const NADataDef *def, NADataBoxed *boxed )
+{
+	GPtrArray *slots;
+	guint slot;
+
+	slot = na_factory_object_get_slot( def->name );
+	if( slot == NA_FACTORY_OBJECT_NO_SLOT ){
+		return;
+	}
+
+	slots = get_boxed_slots( object );
+
+	if( !slots ){
+		if( !boxed ){
+			return;
+		}
+		slots = g_ptr_array_sized_new( st_slots_count );
+		g_object_set_qdata( G_OBJECT( object ), st_boxed_quark, slots );
+	}
+
+	if( slot >= slots->len ){
+		if( !boxed ){
+			return;
+		}
+		g_ptr_array_set_size( slots, st_slots_count );
+	}
+
+	g_ptr_array_index( slots, slot ) = boxed;
+}
+
 static void
 attach_boxed_to_object( NAIFactoryObject *object, NADataBoxed *boxed )
 {
 	GList *list = g_object_get_data( G_OBJECT( object ), NA_IFACTORY_OBJECT_PROP_DATA );
 	list = g_list_prepend( list, boxed );
 	g_object_set_data( G_OBJECT( object ), NA_IFACTORY_OBJECT_PROP_DATA, list );
+
+	set_boxed_slot( object, na_data_boxed_get_data_def( boxed ), boxed );
+}
+
+/*
+ * a NADataBoxed may be shared between an object and its duplicates:
+ * replace it with a private copy before it be modified
+ *
+ * Returns: the NADataBoxed which may be modified.
+ */
+static NADataBoxed *
+get_writable_boxed( NAIFactoryObject *object, NADataBoxed *boxed )
+{
+	NADataBoxed *private;
+	GList *list, *ibox;
+
+	list = g_object_get_data( G_OBJECT( object ), NA_IFACTORY_OBJECT_PROP_DATA );
+	ibox = g_list_find( list, boxed );
+
+	if( !ibox || G_OBJECT( boxed )->ref_count == 1 ){
+		return( boxed );
+	}
+
+	private = na_data_boxed_new( na_data_boxed_get_data_def( boxed ));
+	na_boxed_set_from_boxed( NA_BOXED( private ), NA_BOXED( boxed ));
+
+	ibox->data = private;
+	set_boxed_slot( object, na_data_boxed_get_data_def( private ), private );
+
+	g_object_unref( boxed );
+
+	return( private );
+}
+
+/*
+ * the compiled conditions of a NAIContext are no more valid when one
+ * of these conditions is modified
+ */
+static void
+invalidate_context( NAIFactoryObject *object, const gchar *name )
+{
+	if( NA_IS_ICONTEXT( object )){
+		na_context_program_invalidate( NA_ICONTEXT( object ), name );
+	}
 }
 
 static void
@@ -958,6 +1259,11 @@ free_data_boxed_list( NAIFactoryObject *object )
 	g_list_free( list );
 
 	g_object_set_data( G_OBJECT( object ), NA_IFACTORY_OBJECT_PROP_DATA, NULL );
+
+	if( get_boxed_slots( object )){
+		g_ptr_array_free( get_boxed_slots( object ), TRUE );
+		g_object_set_qdata( G_OBJECT( object ), st_boxed_quark, NULL );
+	}
 }
 
 /*
@@ -46,11 +46,20 @@ typedef gboolean ( *NAFactoryObjectIterBoxedFn )( const NAIFactoryObject *object
 
 #define NA_IFACTORY_OBJECT_PROP_DATA			"na-ifactory-object-prop-data"
 
+/* the slot returned for a name which has not been registered by any class
+ */
+#define NA_FACTORY_OBJECT_NO_SLOT				G_MAXUINT
+
 void         na_factory_object_define_properties( GObjectClass *class, const NADataGroup *groups );
 NADataDef   *na_factory_object_get_data_def     ( const NAIFactoryObject *object, const gchar *name );
 NADataGroup *na_factory_object_get_data_groups  ( const NAIFactoryObject *object );
 void         na_factory_object_iter_on_boxed    ( const NAIFactoryObject *object, NAFactoryObjectIterBoxedFn pfn, void *user_data );
 
+guint        na_factory_object_get_slot         ( const gchar *name );
+NADataBoxed *na_factory_object_get_boxed        ( const NAIFactoryObject *object, const gchar *name );
+NADataBoxed *na_factory_object_get_boxed_by_slot( const NAIFactoryObject *object, guint slot );
+gconstpointer na_factory_object_peek_by_slot    ( const NAIFactoryObject *object, guint slot );
+
 gchar       *na_factory_object_get_default      ( NAIFactoryObject *object, const gchar *name );
 void         na_factory_object_set_defaults     ( NAIFactoryObject *object );
 
@@ -66,6 +75,7 @@ void         na_factory_object_read_item        ( NAIFactoryObject *object, cons
 guint        na_factory_object_write_item       ( NAIFactoryObject *object, const NAIFactoryProvider *writer, void *writer_data, GSList **messages );
 
 void        *na_factory_object_get_as_void      ( const NAIFactoryObject *object, const gchar *name );
+gconstpointer na_factory_object_peek_as_void    ( const NAIFactoryObject *object, const gchar *name );
 void         na_factory_object_get_as_value     ( const NAIFactoryObject *object, const gchar *name, GValue *value );
 gboolean     na_factory_object_is_set           ( const NAIFactoryObject *object, const gchar *name );
 
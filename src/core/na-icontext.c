@@ -36,18 +36,19 @@
 #include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
-#include <glibtop/proclist.h>
-#include <glibtop/procstate.h>
 
 #include <libcaja-extension/caja-file-info.h>
 
 #include <api/na-core-utils.h>
 #include <api/na-object-api.h>
 
+#include "na-context-program.h"
 #include "na-desktop-environment.h"
 #include "na-mate-vfs-uri.h"
 #include "na-selected-info.h"
 #include "na-settings.h"
+#include "na-show-if-true.h"
+#include "na-try-exec.h"
 
 /* private interface data
  */
@@ -55,6 +56,39 @@ struct _NAIContextInterfacePrivate {
 	void *empty;						/* so that gcc -pedantic is happy */
 };
 
+/* the cost classes of the predicates
+ * the predicates are always checked by increasing cost class, so that
+ * a syscall, a process spawn or a process-table scan is only run when
+ * all cheaper predicates have succeeded
+ */
+enum {
+	PREDICATE_COST_CONSTANT = 0,		/* O(1) */
+	PREDICATE_COST_MEMORY,				/* in-memory, may iterate on the selection */
+	PREDICATE_COST_SYSCALL,				/* stat or similar */
+	PREDICATE_COST_SPAWN,				/* spawn a child process */
+	PREDICATE_COST_SCAN,				/* scan the process table */
+};
+
+/* a predicate is either one of the functions below, or one of the
+ * compiled NA_CONTEXT_COND_xxx conditions when fn is NULL
+ */
+typedef gboolean ( *PredicateFn )( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+
+typedef struct {
+	const gchar *name;
+	guint        cost;
+	PredicateFn  fn;
+	guint        cond;
+	guint        evaluated;
+	guint        rejected;
+}
+	ContextPredicate;
+
+/* the order of the predicates is adapted each time this count of
+ * candidates has been checked
+ */
+#define PREDICATE_ADAPT_PERIOD			128
+
 static guint st_initializations = 0;	/* interface initialization count */
 
 static GType        register_type( void );
@@ -63,29 +97,41 @@ static void         interface_base_finalize( NAIContextInterface *klass );
 
 static gboolean     v_is_candidate( NAIContext *object, guint target, GList *selection );
 
-static gboolean     is_candidate_for_target( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_show_in( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_try_exec( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_show_if_registered( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_show_if_true( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_show_if_running( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_mimetypes( const NAIContext *object, guint target, GList *files );
-static gboolean     is_all_mimetype( const gchar *mimetype );
-static gboolean     is_file_mimetype( const gchar *mimetype );
-static gboolean     is_mimetype_of( const gchar *file_type, const gchar *ftype, gboolean is_regular );
-static gboolean     is_candidate_for_basenames( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_selection_count( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_schemes( const NAIContext *object, guint target, GList *files );
-static gboolean     is_compatible_scheme( const gchar *pattern, const gchar *scheme );
-static gboolean     is_candidate_for_folders( const NAIContext *object, guint target, GList *files );
-static gboolean     is_candidate_for_capabilities( const NAIContext *object, guint target, GList *files );
+static gboolean     is_candidate_for_target( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+static gboolean     is_candidate_for_show_in( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+static gboolean     is_candidate_for_try_exec( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+static gboolean     is_candidate_for_show_if_registered( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+static gboolean     is_candidate_for_show_if_true( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+static gboolean     is_candidate_for_show_if_running( const NAIContext *object, guint target, GList *files, NAContextCache *cache );
+
+static gboolean     is_candidate_up_to( const NAIContext *context, guint target, GList *selection, NAContextCache *cache, guint max_cost, gboolean record );
+static gboolean     is_candidate_for_predicate( const NAIContext *object, guint target, GList *files, NAContextCache *cache, const NAContextProgram *program, ContextPredicate *predicate, gboolean record );
+static void         adapt_predicates_order( void );
+static gint         compare_predicates( const ContextPredicate *a, const ContextPredicate *b );
 
 static gboolean     is_valid_basenames( const NAIContext *object );
 static gboolean     is_valid_mimetypes( const NAIContext *object );
 static gboolean     is_valid_schemes( const NAIContext *object );
 static gboolean     is_valid_folders( const NAIContext *object );
 
-static gboolean     is_positive_assertion( const gchar *assertion );
+static ContextPredicate st_predicates[] = {
+		{ "Target",           PREDICATE_COST_CONSTANT, is_candidate_for_target,             0 },
+		{ "SelectionCount",   PREDICATE_COST_CONSTANT, NULL, NA_CONTEXT_COND_SELECTION_COUNT },
+		{ "ShowIn",           PREDICATE_COST_MEMORY,   is_candidate_for_show_in,            0 },
+		{ "ShowIfRegistered", PREDICATE_COST_MEMORY,   is_candidate_for_show_if_registered, 0 },
+		{ "Schemes",          PREDICATE_COST_MEMORY,   NULL, NA_CONTEXT_COND_SCHEMES },
+		{ "MimeTypes",        PREDICATE_COST_MEMORY,   NULL, NA_CONTEXT_COND_MIMETYPES },
+		{ "Basenames",        PREDICATE_COST_MEMORY,   NULL, NA_CONTEXT_COND_BASENAMES },
+		{ "Folders",          PREDICATE_COST_MEMORY,   NULL, NA_CONTEXT_COND_FOLDERS },
+		{ "Capabilities",     PREDICATE_COST_MEMORY,   NULL, NA_CONTEXT_COND_CAPABILITIES },
+		{ "TryExec",          PREDICATE_COST_SYSCALL,  is_candidate_for_try_exec,           0 },
+		{ "ShowIfTrue",       PREDICATE_COST_SPAWN,    is_candidate_for_show_if_true,       0 },
+		{ "ShowIfRunning",    PREDICATE_COST_SCAN,     is_candidate_for_show_if_running,    0 }
+};
+
+#define PREDICATES_COUNT				G_N_ELEMENTS( st_predicates )
+
+static guint st_candidates_count = 0;	/* count of checked candidates */
 
 /**
  * na_icontext_get_type:
@@ -213,34 +259,56 @@ na_icontext_are_equal( const NAIContext *a, const NAIContext *b )
  */
 gboolean
 na_icontext_is_candidate( const NAIContext *context, guint target, GList *selection )
+{
+	return( na_icontext_is_candidate_cached( context, target, selection, NULL ));
+}
+
+/*
+ * na_icontext_is_candidate_cached:
+ * @context: a #NAIContext to be checked.
+ * @target: the current target.
+ * @selection: the currently selected items, as a #GList of NASelectedInfo items.
+ * @cache: [allow-none]: a #NAContextCache for this same @selection.
+ *
+ * Same than na_icontext_is_candidate(), but the results of the compiled
+ * conditions are searched for in, and recorded into, the @cache.
+ *
+ * Returns: %TRUE if this @context is a valid candidate.
+ */
+gboolean
+na_icontext_is_candidate_cached( const NAIContext *context, guint target, GList *selection, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate";
-	gboolean is_candidate;
 
 	g_return_val_if_fail( NA_IS_ICONTEXT( context ), FALSE );
 
 	g_debug( "%s: object=%p (%s), target=%d, selection=%p (count=%d)",
 			thisfn, ( void * ) context, G_OBJECT_TYPE_NAME( context ), target, (void * ) selection, g_list_length( selection ));
 
-	is_candidate = v_is_candidate( NA_ICONTEXT( context ), target, selection );
+	return( is_candidate_up_to( context, target, selection, cache, PREDICATE_COST_SCAN, TRUE ));
+}
 
-	if( is_candidate ){
-		is_candidate =
-				is_candidate_for_target( context, target, selection ) &&
-				is_candidate_for_show_in( context, target, selection ) &&
-				is_candidate_for_try_exec( context, target, selection ) &&
-				is_candidate_for_show_if_registered( context, target, selection ) &&
-				is_candidate_for_show_if_true( context, target, selection ) &&
-				is_candidate_for_show_if_running( context, target, selection ) &&
-				is_candidate_for_mimetypes( context, target, selection ) &&
-				is_candidate_for_basenames( context, target, selection ) &&
-				is_candidate_for_selection_count( context, target, selection ) &&
-				is_candidate_for_schemes( context, target, selection ) &&
-				is_candidate_for_folders( context, target, selection ) &&
-				is_candidate_for_capabilities( context, target, selection );
-	}
+/*
+ * na_icontext_is_candidate_cheap:
+ * @context: a #NAIContext to be checked.
+ * @target: the current target.
+ * @selection: the currently selected items, as a #GList of NASelectedInfo items.
+ * @cache: [allow-none]: a #NAContextCache for this same @selection.
+ *
+ * Only checks the predicates which neither spawn nor scan processes.
+ *
+ * This is a pre-filter: the statistics are only recorded by the full
+ * check, which takes the final decision.
+ *
+ * Returns: %TRUE if this @context may be a valid candidate, %FALSE if
+ * it is known to not be a candidate.
+ */
+gboolean
+na_icontext_is_candidate_cheap( const NAIContext *context, guint target, GList *selection, NAContextCache *cache )
+{
+	g_return_val_if_fail( NA_IS_ICONTEXT( context ), FALSE );
 
-	return( is_candidate );
+	return( is_candidate_up_to( context, target, selection, cache, PREDICATE_COST_SYSCALL, FALSE ));
 }
 
 /**
@@ -295,7 +363,7 @@ na_icontext_check_mimetypes( const NAIContext *context )
 	g_return_if_fail( NA_IS_ICONTEXT( context ));
 
 	is_all = TRUE;
-	mimetypes = na_object_get_mimetypes( context );
+	mimetypes = na_object_peek_mimetypes( context );
 
 	for( im = mimetypes ; im ; im = im->next ){
 		if( !im->data || !strlen( im->data )){
@@ -303,7 +371,7 @@ na_icontext_check_mimetypes( const NAIContext *context )
 			continue;
 		}
 		const gchar *imtype = ( const gchar * ) im->data;
-		if( is_all_mimetype( imtype )){
+		if( na_context_program_is_all_mimetype( imtype )){
 			continue;
 		}
 		is_all = FALSE;
@@ -311,8 +379,6 @@ na_icontext_check_mimetypes( const NAIContext *context )
 	}
 
 	na_object_set_all_mimetypes( context, is_all );
-
-	na_core_utils_slist_free( mimetypes );
 }
 
 /**
@@ -327,7 +393,10 @@ na_icontext_check_mimetypes( const NAIContext *context )
 void
 na_icontext_copy( NAIContext *context, const NAIContext *source )
 {
-	/* nothing to do for now */
+	g_return_if_fail( NA_IS_ICONTEXT( context ));
+	g_return_if_fail( NA_IS_ICONTEXT( source ));
+
+	na_context_program_share( context, source );
 }
 
 /**
@@ -343,6 +412,13 @@ na_icontext_copy( NAIContext *context, const NAIContext *source )
  *       in order to optimize computation time;
  *     </para>
  *   </listitem>
+ *   <listitem>
+ *     <para>
+ *       This compiles the conditions which are checked against each
+ *       selected item, so that they do not have to be parsed again
+ *       each time the Caja context menu is built.
+ *     </para>
+ *   </listitem>
  * </itemizedlist>
  *
  * Since: 2.30
@@ -351,6 +427,8 @@ void
 na_icontext_read_done( NAIContext *context )
 {
 	na_object_check_mimetypes( context );
+
+	na_context_program_compile( context );
 }
 
 /**
@@ -460,13 +538,125 @@ v_is_candidate( NAIContext *context, guint target, GList *selection )
 	return( is_candidate );
 }
 
+/*
+ * check the predicates whose cost class is not greater than max_cost
+ */
+static gboolean
+is_candidate_up_to( const NAIContext *context, guint target, GList *selection, NAContextCache *cache, guint max_cost, gboolean record )
+{
+	gboolean is_candidate;
+	const NAContextProgram *program;
+	guint i;
+
+	is_candidate = v_is_candidate( NA_ICONTEXT( context ), target, selection );
+
+	if( is_candidate ){
+		program = na_context_program_get( context );
+
+		for( i = 0 ; i < PREDICATES_COUNT && is_candidate && st_predicates[i].cost <= max_cost ; ++i ){
+			is_candidate = is_candidate_for_predicate( context, target, selection, cache, program, &st_predicates[i], record );
+		}
+
+		if( record ){
+			st_candidates_count += 1;
+			if( st_candidates_count % PREDICATE_ADAPT_PERIOD == 0 ){
+				adapt_predicates_order();
+			}
+		}
+	}
+
+	return( is_candidate );
+}
+
+/*
+ * check one predicate, recording its statistics if asked for
+ */
+static gboolean
+is_candidate_for_predicate( const NAIContext *object, guint target, GList *files, NAContextCache *cache, const NAContextProgram *program, ContextPredicate *predicate, gboolean record )
+{
+	gboolean ok;
+
+	if( predicate->fn ){
+		ok = ( *predicate->fn )( object, target, files, cache );
+
+	} else {
+		ok = na_context_program_is_candidate_for( program, predicate->cond, files, cache );
+	}
+
+	if( record ){
+		predicate->evaluated += 1;
+		if( !ok ){
+			predicate->rejected += 1;
+		}
+	}
+
+	return( ok );
+}
+
+/*
+ * inside of each cost class, have first the predicates which have
+ * rejected the most candidates until now, as they are the most likely
+ * to stop the evaluation early
+ *
+ * the statistics are then halved, so that the order follows the recent
+ * changes of the loaded items or of the selections
+ */
+static void
+adapt_predicates_order( void )
+{
+	static const gchar *thisfn = "na_icontext_adapt_predicates_order";
+	ContextPredicate current;
+	guint i, j;
+
+	/* an insertion sort is stable and cheap on a dozen of already
+	 * (almost) sorted elements
+	 */
+	for( i = 1 ; i < PREDICATES_COUNT ; ++i ){
+		current = st_predicates[i];
+		for( j = i ; j > 0 && compare_predicates( &st_predicates[j-1], &current ) > 0 ; --j ){
+			st_predicates[j] = st_predicates[j-1];
+		}
+		st_predicates[j] = current;
+	}
+
+	for( i = 0 ; i < PREDICATES_COUNT ; ++i ){
+		g_debug( "%s: %s: cost=%u, evaluated=%u, rejected=%u",
+				thisfn, st_predicates[i].name, st_predicates[i].cost, st_predicates[i].evaluated, st_predicates[i].rejected );
+		st_predicates[i].evaluated /= 2;
+		st_predicates[i].rejected /= 2;
+	}
+}
+
+/*
+ * compare the rejection rates as rejected_a/evaluated_a vs. rejected_b/evaluated_b
+ * without any division
+ */
+static gint
+compare_predicates( const ContextPredicate *a, const ContextPredicate *b )
+{
+	guint64 rate_a, rate_b;
+
+	if( a->cost != b->cost ){
+		return( a->cost < b->cost ? -1 : 1 );
+	}
+
+	rate_a = ( guint64 ) a->rejected * MAX( b->evaluated, 1 );
+	rate_b = ( guint64 ) b->rejected * MAX( a->evaluated, 1 );
+
+	if( rate_a == rate_b ){
+		return( 0 );
+	}
+
+	return( rate_a > rate_b ? -1 : 1 );
+}
+
 /*
  * whether the given NAIContext object is candidate for this target
  * target is context menu for location, context menu for selection or toolbar for location
  * only actions are concerned by this check
  */
 static gboolean
-is_candidate_for_target( const NAIContext *object, guint target, GList *files )
+is_candidate_for_target( const NAIContext *object, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate_for_target";
 	gboolean ok = TRUE;
@@ -508,12 +698,12 @@ is_candidate_for_target( const NAIContext *object, guint target, GList *files )
  * only one of these two data may be set
  */
 static gboolean
-is_candidate_for_show_in( const NAIContext *object, guint target, GList *files )
+is_candidate_for_show_in( const NAIContext *object, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate_for_show_in";
 	gboolean ok = TRUE;
-	GSList *only_in = na_object_get_only_show_in( object );
-	GSList *not_in = na_object_get_not_show_in( object );
+	GSList *only_in = na_object_peek_only_show_in( object );
+	GSList *not_in = na_object_peek_not_show_in( object );
 	static gchar *environment = NULL;
 
 	/* there is a memory leak here when desktop comes from user preferences
@@ -542,9 +732,6 @@ is_candidate_for_show_in( const NAIContext *object, guint target, GList *files )
 		g_free( only_str );
 	}
 
-	na_core_utils_slist_free( not_in );
-	na_core_utils_slist_free( only_in );
-
 	return( ok );
 }
 
@@ -552,47 +739,29 @@ is_candidate_for_show_in( const NAIContext *object, guint target, GList *files )
  * if the data is set, it should be the path of an executable file
  */
 static gboolean
-is_candidate_for_try_exec( const NAIContext *object, guint target, GList *files )
+is_candidate_for_try_exec( const NAIContext *object, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate_for_try_exec";
 	gboolean ok = TRUE;
-	GError *error = NULL;
-	gchar *tryexec = na_object_get_try_exec( object );
+	const gchar *tryexec = na_object_peek_try_exec( object );
 
 	if( tryexec && strlen( tryexec )){
-		ok = FALSE;
-		GFile *file = g_file_new_for_path( tryexec );
-		GFileInfo *info = g_file_query_info( file, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE, G_FILE_QUERY_INFO_NONE, NULL, &error );
-		if( error ){
-			g_debug( "%s: %s", thisfn, error->message );
-			g_error_free( error );
-
-		} else {
-			ok = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE );
-		}
-
-		if( info ){
-			g_object_unref( info );
-		}
-
-		g_object_unref( file );
+		ok = na_try_exec_is_executable( tryexec );
 	}
 
 	if( !ok ){
 		g_debug( "%s: object is not candidate because TryExec=%s", thisfn, tryexec );
 	}
 
-	g_free( tryexec );
-
 	return( ok );
 }
 
 static gboolean
-is_candidate_for_show_if_registered( const NAIContext *object, guint target, GList *files )
+is_candidate_for_show_if_registered( const NAIContext *object, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate_for_show_if_registered";
 	gboolean ok = TRUE;
-	gchar *name = na_object_get_show_if_registered( object );
+	const gchar *name = na_object_peek_show_if_registered( object );
 
 	if( name && strlen( name )){
 		ok = FALSE;
@@ -602,66 +771,38 @@ is_candidate_for_show_if_registered( const NAIContext *object, guint target, GLi
 		g_debug( "%s: object is not candidate because ShowIfRegistered=%s", thisfn, name );
 	}
 
-	g_free( name );
-
 	return( ok );
 }
 
 static gboolean
-is_candidate_for_show_if_true( const NAIContext *object, guint target, GList *files )
+is_candidate_for_show_if_true( const NAIContext *object, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate_for_show_if_true";
 	gboolean ok = TRUE;
-	gchar *command = na_object_get_show_if_true( object );
+	const gchar *command = na_object_peek_show_if_true( object );
 
 	if( command && strlen( command )){
-		ok = FALSE;
-		gchar *stdout = NULL;
-		g_spawn_command_line_sync( command, &stdout, NULL, NULL, NULL );
-
-		if( stdout && !strcmp( stdout, "true" )){
-			ok = TRUE;
-		}
-
-		g_free( stdout );
+		ok = na_show_if_true_evaluate( command );
 	}
 
 	if( !ok ){
 		g_debug( "%s: object is not candidate because ShowIfTrue=%s", thisfn, command );
 	}
 
-	g_free( command );
-
 	return( ok );
 }
 
 static gboolean
-is_candidate_for_show_if_running( const NAIContext *object, guint target, GList *files )
+is_candidate_for_show_if_running( const NAIContext *object, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "na_icontext_is_candidate_for_show_if_running";
 	gboolean ok = TRUE;
 	gchar *searched;
-	glibtop_proclist proclist;
-	glibtop_proc_state procstate;
-	pid_t *pid_list;
-	guint i;
-	gchar *running = na_object_get_show_if_running( object );
+	const gchar *running = na_object_peek_show_if_running( object );
 
 	if( running && strlen( running )){
-		ok = FALSE;
 		searched = g_path_get_basename( running );
-		pid_list = glibtop_get_proclist( &proclist, GLIBTOP_KERN_PROC_ALL, 0 );
-
-		for( i=0 ; i<proclist.number && !ok ; ++i ){
-			glibtop_get_proc_state( &procstate, pid_list[i] );
-			/*g_debug( "%s: i=%d, cmd=%s", thisfn, i, procstate.cmd );*/
-			if( strcmp( procstate.cmd, searched ) == 0 ){
-				g_debug( "%s: i=%d, cmd=%s", thisfn, i, procstate.cmd );
-				ok = TRUE;
-			}
-		}
-
-		g_free( pid_list );
+		ok = g_hash_table_contains( na_context_cache_get_running_processes( cache ), searched );
 		g_free( searched );
 	}
 
@@ -669,470 +810,6 @@ is_candidate_for_show_if_running( const NAIContext *object, guint target, GList
 		g_debug( "%s: object is not candidate because ShowIfRunning=%s", thisfn, running );
 	}
 
-	g_free( running );
-
-	return( ok );
-}
-
-/*
- * object may embed a list of - possibly negated - mimetypes
- * each file of the selection must satisfy all conditions of this list
- * an empty list is considered the same as '*' or '* / *'
- *
- * most time, we will just have '*' - so try to optimize the code to
- * be as fast as possible when we don't filter on mimetype
- *
- * mimetypes are of type : "image/ *; !image/jpeg"
- * file mimetype must be compatible with at least one positive assertion
- * (they are ORed), while not being of any negative assertions (they are
- * ANDed)
- *
- * here, for each mimetype of the selection, do
- * . match is FALSE while this mimetype has not matched a positive assertion
- * . nomatch is FALSE while this mimetype has not matched a negative assertion
- * we are going to check each mimetype filter
- *  while we have not found a match among positive conditions (i.e. while !match)
- *  we have to check all negative conditions to verify that the current
- *  examined mimetype never match these
- */
-static gboolean
-is_candidate_for_mimetypes( const NAIContext *object, guint target, GList *files )
-{
-	static const gchar *thisfn = "na_icontext_is_candidate_for_mimetypes";
-	gboolean ok = TRUE;
-	gboolean all = na_object_get_all_mimetypes( object );
-
-	g_debug( "%s: all=%s", thisfn, all ? "True":"False" );
-
-	if( !all ){
-		GSList *mimetypes = na_object_get_mimetypes( object );
-		GSList *im;
-		GList *it;
-
-		for( it = files ; it && ok ; it = it->next ){
-			gchar *ftype;
-			gboolean regular, match, positive;
-
-			match = FALSE;
-			ftype = na_selected_info_get_mime_type( NA_SELECTED_INFO( it->data ));
-			regular = na_selected_info_is_regular( NA_SELECTED_INFO( it->data ));
-
-			if( ftype ){
-				for( im = mimetypes ; im && ok ; im = im->next ){
-					const gchar *imtype = ( const gchar * ) im->data;
-					positive = is_positive_assertion( imtype );
-
-					if( !positive || !match ){
-						if( is_mimetype_of( positive ? imtype : imtype+1, ftype, regular )){
-							g_debug( "%s: condition=%s, positive=%s, ftype=%s, matched",
-									thisfn, imtype, positive ? "True":"False", ftype );
-							if( positive ){
-								match = TRUE;
-							} else {
-								ok = FALSE;
-							}
-						}
-					}
-				}
-
-				if( !match ){
-					gchar *mimetypes_str = na_core_utils_slist_to_text( mimetypes );
-					g_debug( "%s: no positive match found for Mimetypes=%s", thisfn, mimetypes_str );
-					g_free( mimetypes_str );
-					ok = FALSE;
-				}
-
-			} else {
-				gchar *uri = na_selected_info_get_uri( NA_SELECTED_INFO( it->data ));
-				g_warning( "%s: null mimetype found for %s", thisfn, uri );
-				g_free( uri );
-				ok = FALSE;
-			}
-
-			g_free( ftype );
-		}
-
-		na_core_utils_slist_free( mimetypes );
-	}
-
-	return( ok );
-}
-
-static gboolean
-is_all_mimetype( const gchar *mimetype )
-{
-	return( !strcmp( mimetype, "*" ) ||
-			!strcmp( mimetype, "*/*" ) ||
-			!strcmp( mimetype, "*/all" ) ||	/* should be considered as invalid */
-			!strcmp( mimetype, "all" ) ||
-			!strcmp( mimetype, "all/*" ) ||
-			!strcmp( mimetype, "all/all" ));
-}
-
-static gboolean
-is_file_mimetype( const gchar *mimetype )
-{
-	return( !strcmp( mimetype, "allfiles" ) ||
-			!strcmp( mimetype, "*/allfiles" ) ||	/* should be considered as invalid */
-			!strcmp( mimetype, "allfiles/*" ) ||
-			!strcmp( mimetype, "allfiles/all" ) ||
-			!strcmp( mimetype, "all/allfiles" ));
-}
-
-/*
- * does the file fgroup/fsubgroup have a mimetype which is 'a sort of'
- *  mimetype specified one ?
- * for example, "image/jpeg" is clearly a sort of "image/ *"
- *
- * content type if the same as the mime type in *nix;
- * this is not true on Win32 platforms
- */
-static gboolean
-is_mimetype_of( const gchar *mimetype, const gchar *ftype, gboolean is_regular )
-{
-	static const gchar *thisfn = "na_icontext_is_mimetype_of";
-	gboolean is_type_of;
-	gchar *file_content_type, *def_content_type;
-
-	if( is_all_mimetype( mimetype )){
-		return( TRUE );
-	}
-
-	if( is_file_mimetype( mimetype ) && is_regular ){
-		return( TRUE );
-	}
-
-	is_type_of = FALSE;
-	file_content_type = g_content_type_from_mime_type( ftype );
-	def_content_type = g_content_type_from_mime_type( mimetype );
-
-	if( file_content_type && def_content_type ){
-		is_type_of = g_content_type_is_a( file_content_type, def_content_type );
-		g_debug( "%s: def_mimetype=%s content_type=%s file_mimetype=%s content_type=%s is_a=%s",
-				thisfn, mimetype, def_content_type, ftype, file_content_type,
-				is_type_of ? "True":"False" );
-	}
-
-	g_free( file_content_type );
-	g_free( def_content_type );
-
-	return( is_type_of );
-}
-
-static gboolean
-is_candidate_for_basenames( const NAIContext *object, guint target, GList *files )
-{
-	static const gchar *thisfn = "na_icontext_is_candidate_for_basenames";
-	gboolean ok = TRUE;
-	GSList *basenames = na_object_get_basenames( object );
-
-	if( basenames ){
-		if( strcmp( basenames->data, "*" ) != 0 || g_slist_length( basenames ) > 1 ){
-			gboolean matchcase = na_object_get_matchcase( object );
-			GSList *ib;
-			GList *it;
-			gchar *tmp;
-
-			for( it = files ; it && ok ; it = it->next ){
-				gchar *pattern, *bname, *bname_utf8;
-				gboolean match, positive;
-				gchar *pattern_utf8;
-
-				bname = na_selected_info_get_basename( NA_SELECTED_INFO( it->data ));
-				bname_utf8 = g_filename_to_utf8( bname, -1, NULL, NULL, NULL );
-				if( !matchcase ){
-					tmp = g_utf8_strdown( bname_utf8, -1 );
-					g_free( bname_utf8 );
-					bname_utf8 = tmp;
-				}
-				match = FALSE;
-
-				for( ib = basenames ; ib && ok ; ib = ib->next ){
-					pattern = matchcase ?
-						g_strdup(( gchar * ) ib->data ) :
-						g_utf8_strdown(( gchar * ) ib->data, -1 );
-					positive = is_positive_assertion( pattern );
-					pattern_utf8 = g_filename_to_utf8( positive ? pattern : pattern+1, -1, NULL, NULL, NULL );
-
-					if( !positive || !match ){
-						if( g_pattern_match_simple( pattern_utf8, bname_utf8 )){
-							g_debug( "%s: condition=%s, positive=%s, basename=%s: matched",
-									thisfn, pattern_utf8, positive ? "True":"False", bname_utf8 );
-							if( positive ){
-								match = TRUE;
-							} else {
-								ok = FALSE;
-							}
-						}
-					}
-
-					g_free( pattern_utf8 );
-					g_free( pattern );
-				}
-
-				if( !match ){
-					gchar *basenames_str = na_core_utils_slist_to_text( basenames );
-					g_debug( "%s: no positive match found for Basenames=%s", thisfn, basenames_str );
-					g_free( basenames_str );
-					ok = FALSE;
-				}
-
-				g_free( bname_utf8 );
-				g_free( bname );
-			}
-		}
-
-		na_core_utils_slist_free( basenames );
-	}
-
-	return( ok );
-}
-
-static gboolean
-is_candidate_for_selection_count( const NAIContext *object, guint target, GList *files )
-{
-	static const gchar *thisfn = "na_icontext_is_candidate_for_selection_count";
-	gboolean ok = TRUE;
-	gint limit;
-	guint count;
-	gchar *selection_count = na_object_get_selection_count( object );
-
-	if( selection_count && strlen( selection_count )){
-		limit = atoi( selection_count+1 );
-		count = g_list_length( files );
-		ok = FALSE;
-
-		switch( selection_count[0] ){
-			case '<':
-				ok = ( count < limit );
-				break;
-			case '=':
-				ok = ( count == limit );
-				break;
-			case '>':
-				ok = ( count > limit );
-				break;
-			default:
-				break;
-		}
-	}
-
-	if( !ok ){
-		g_debug( "%s: object is not candidate because SelectionCount=%s", thisfn, selection_count );
-	}
-
-	g_free( selection_count );
-
-	return( ok );
-}
-
-/*
- * it is likely that all selected items have the same scheme, because they
- * are all in the same location and the scheme mainly depends on location
- * so we have here a great possible optimization by only testing the
- * first selected item.
- * note that this optimization may be wrong, for example when ran from the
- * command-line with a random set of pseudo-selected items
- * so we take care of only checking _distincts_ schemes of provided selection
- * against schemes conditions.
- */
-static gboolean
-is_candidate_for_schemes( const NAIContext *object, guint target, GList *files )
-{
-	static const gchar *thisfn = "na_icontext_is_candidate_for_schemes";
-	gboolean ok = TRUE;
-	GSList *schemes = na_object_get_schemes( object );
-
-	if( schemes ){
-		if( strcmp( schemes->data, "*" ) != 0 || g_slist_length( schemes ) > 1 ){
-			GSList *distincts = NULL;
-			GList *it;
-
-			for( it = files ; it && ok ; it = it->next ){
-				gchar *scheme = na_selected_info_get_uri_scheme( NA_SELECTED_INFO( it->data ));
-
-				if( na_core_utils_slist_count( distincts, scheme ) == 0 ){
-					GSList *is;
-					gchar *pattern;
-					gboolean match, positive;
-
-					match = FALSE;
-					distincts = g_slist_prepend( distincts, g_strdup( scheme ));
-
-					for( is = schemes ; is && ok ; is = is->next ){
-						pattern = ( gchar * ) is->data;
-						positive = is_positive_assertion( pattern );
-
-						if( !positive || !match ){
-							if( is_compatible_scheme( positive ? pattern : pattern+1, scheme )){
-								if( positive ){
-									match = TRUE;
-								} else {
-									ok = FALSE;
-								}
-							}
-						}
-					}
-
-					ok &= match;
-				}
-
-				g_free( scheme );
-			}
-
-			na_core_utils_slist_free( distincts );
-		}
-
-		if( !ok ){
-			gchar *schemes_str = na_core_utils_slist_to_text( schemes );
-			g_debug( "%s: object is not candidate because Schemes=%s", thisfn, schemes_str );
-			g_free( schemes_str );
-		}
-
-		na_core_utils_slist_free( schemes );
-	}
-
-	g_debug( "%s: ok=%s", thisfn, ok ? "True":"False" );
-	return( ok );
-}
-
-static gboolean
-is_compatible_scheme( const gchar *pattern, const gchar *scheme )
-{
-	gboolean compatible;
-
-	compatible = FALSE;
-
-	if( strcmp( pattern, "*" ) == 0 ){
-		compatible = TRUE;
-	} else {
-		compatible = ( strcmp( pattern, scheme ) == 0 );
-	}
-
-	return( compatible );
-}
-
-/*
- * assuming here the same sort of optimization than for schemes
- * i.e. we assume that all selected items are most probably located
- * in the same dirname
- * so we take care of only checking _distinct_ dirnames against folder
- * conditions
- */
-static gboolean
-is_candidate_for_folders( const NAIContext *object, guint target, GList *files )
-{
-	static const gchar *thisfn = "na_icontext_is_candidate_for_folders";
-	gboolean ok = TRUE;
-	GSList *folders = na_object_get_folders( object );
-
-	if( folders ){
-		if( strcmp( folders->data, "/" ) != 0 || g_slist_length( folders ) > 1 ){
-			GSList *distincts = NULL;
-			GList *it;
-
-			for( it = files ; it && ok ; it = it->next ){
-				gchar *dirname = na_selected_info_get_dirname( NA_SELECTED_INFO( it->data ));
-
-				if( na_core_utils_slist_count( distincts, dirname ) == 0 ){
-					g_debug( "%s: examining new distinct selected dirname=%s", thisfn, dirname );
-
-					GSList *id;
-					gchar *dirname_utf8, *pattern_utf8;
-					const gchar *pattern;
-					gboolean match, positive;
-					gboolean has_pattern;
-
-					distincts = g_slist_prepend( distincts, g_strdup( dirname ));
-					dirname_utf8 = g_filename_to_utf8( dirname, -1, NULL, NULL, NULL );
-
-					for( id = folders ; id && ok ; id = id->next ){
-						pattern = ( const gchar * ) id->data;
-						g_debug( "%s: examining new condition pattern=%s", thisfn, pattern );
-						positive = is_positive_assertion( pattern );
-						pattern_utf8 = g_filename_to_utf8( positive ? pattern : pattern+1, -1, NULL, NULL, NULL );
-						has_pattern = ( g_strstr_len( pattern_utf8, -1, "*" ) != NULL );
-
-						match = ( has_pattern && g_pattern_match_simple( pattern_utf8, dirname_utf8 )) ||
-								g_str_has_prefix( dirname_utf8, pattern_utf8 );
-
-						ok &= ( match && positive ) || ( !match && !positive );
-
-						g_free( pattern_utf8 );
-					}
-
-					g_free( dirname_utf8 );
-				}
-
-				g_free( dirname );
-			}
-
-			na_core_utils_slist_free( distincts );
-		}
-
-		if( !ok ){
-			gchar *folders_str = na_core_utils_slist_to_text( folders );
-			g_debug( "%s: object is not candidate because Folders=%s", thisfn, folders_str );
-			g_free( folders_str );
-		}
-
-		na_core_utils_slist_free( folders );
-	}
-
-	return( ok );
-}
-
-static gboolean
-is_candidate_for_capabilities( const NAIContext *object, guint target, GList *files )
-{
-	static const gchar *thisfn = "na_icontext_is_candidate_for_capabilities";
-	gboolean ok = TRUE;
-	GSList *capabilities = na_object_get_capabilities( object );
-
-	if( capabilities ){
-		GSList *ic;
-		GList *it;
-		const gchar *cap;
-		gboolean match, positive;
-
-		for( it = files ; it && ok ; it = it->next ){
-			for( ic = capabilities ; ic && ok ; ic = ic->next ){
-				cap = ( const gchar * ) ic->data;
-				positive = is_positive_assertion( cap );
-				match = FALSE;
-
-				if( !strcmp( positive ? cap : cap+1, "Owner" )){
-					match = na_selected_info_is_owner( NA_SELECTED_INFO( it->data ), getlogin());
-
-				} else if( !strcmp( positive ? cap : cap+1, "Readable" )){
-					match = na_selected_info_is_readable( NA_SELECTED_INFO( it->data ));
-
-				} else if( !strcmp( positive ? cap : cap+1, "Writable" )){
-					match = na_selected_info_is_writable( NA_SELECTED_INFO( it->data ));
-
-				} else if( !strcmp( positive ? cap : cap+1, "Executable" )){
-					match = na_selected_info_is_executable( NA_SELECTED_INFO( it->data ));
-
-				} else if( !strcmp( positive ? cap : cap+1, "Local" )){
-					match = na_selected_info_is_local( NA_SELECTED_INFO( it->data ));
-
-				} else {
-					g_warning( "%s: unknown capability %s", thisfn, cap );
-				}
-
-				ok &= (( positive && match ) || ( !positive && !match ));
-			}
-		}
-
-		if( !ok ){
-			gchar *capabilities_str = na_core_utils_slist_to_text( capabilities );
-			g_debug( "%s: object is not candidate because Capabilities=%s", thisfn, capabilities_str );
-			g_free( capabilities_str );
-		}
-
-		na_core_utils_slist_free( capabilities );
-	}
-
 	return( ok );
 }
 
@@ -1142,9 +819,8 @@ is_valid_basenames( const NAIContext *object )
 	gboolean valid;
 	GSList *basenames;
 
-	basenames = na_object_get_basenames( object );
+	basenames = na_object_peek_basenames( object );
 	valid = basenames && g_slist_length( basenames ) > 0;
-	na_core_utils_slist_free( basenames );
 
 	if( !valid ){
 		na_object_debug_invalid( object, "basenames" );
@@ -1168,7 +844,7 @@ is_valid_mimetypes( const NAIContext *object )
 	guint count_ok, count_errs;
 	const gchar *imtype;
 
-	mimetypes = na_object_get_mimetypes( object );
+	mimetypes = na_object_peek_mimetypes( object );
 	count_ok = 0;
 	count_errs = 0;
 
@@ -1204,8 +880,6 @@ is_valid_mimetypes( const NAIContext *object )
 		na_object_debug_invalid( object, "mimetypes" );
 	}
 
-	na_core_utils_slist_free( mimetypes );
-
 	return( valid );
 }
 
@@ -1215,9 +889,8 @@ is_valid_schemes( const NAIContext *object )
 	gboolean valid;
 	GSList *schemes;
 
-	schemes = na_object_get_schemes( object );
+	schemes = na_object_peek_schemes( object );
 	valid = schemes && g_slist_length( schemes ) > 0;
-	na_core_utils_slist_free( schemes );
 
 	if( !valid ){
 		na_object_debug_invalid( object, "schemes" );
@@ -1232,9 +905,8 @@ is_valid_folders( const NAIContext *object )
 	gboolean valid;
 	GSList *folders;
 
-	folders = na_object_get_folders( object );
+	folders = na_object_peek_folders( object );
 	valid = folders && g_slist_length( folders ) > 0;
-	na_core_utils_slist_free( folders );
 
 	if( !valid ){
 		na_object_debug_invalid( object, "folders" );
@@ -1242,24 +914,3 @@ is_valid_folders( const NAIContext *object )
 
 	return( valid );
 }
-
-/*
- * "image/ *" is a positive assertion
- * "!image/jpeg" is a negative one
- */
-static gboolean
-is_positive_assertion( const gchar *assertion )
-{
-	gboolean positive = TRUE;
-
-	if( assertion ){
-		gchar *dupped = g_strdup( assertion );
-		const gchar *stripped = g_strstrip( dupped );
-		if( stripped ){
-			positive = ( stripped[0] != '!' );
-		}
-		g_free( dupped );
-	}
-
-	return( positive );
-}
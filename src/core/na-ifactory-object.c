@@ -31,8 +31,6 @@
 #include <config.h>
 #endif
 
-#include <string.h>
-
 #include <api/na-ifactory-object.h>
 
 #include "na-factory-object.h"
@@ -147,6 +145,10 @@ ifactory_object_get_version( const NAIFactoryObject *instance )
  * The returned #NADataBoxed is owned by #NAIFactoryObject @object, and
  * should not be released by the caller.
  *
+ * Starting with 3.2, the #NADataBoxed may be shared between @object and
+ * its duplicates; it should so not be modified directly, but through
+ * na_ifactory_object_set_from_void().
+ *
  * Returns: The #NADataBoxed object which contains the specified data,
  * or %NULL.
  *
@@ -155,23 +157,9 @@ ifactory_object_get_version( const NAIFactoryObject *instance )
 NADataBoxed *
 na_ifactory_object_get_data_boxed( const NAIFactoryObject *object, const gchar *name )
 {
-	GList *list, *ip;
-
 	g_return_val_if_fail( NA_IS_IFACTORY_OBJECT( object ), NULL );
 
-	list = g_object_get_data( G_OBJECT( object ), NA_IFACTORY_OBJECT_PROP_DATA );
-	/*g_debug( "list=%p (count=%u)", ( void * ) list, g_list_length( list ));*/
-
-	for( ip = list ; ip ; ip = ip->next ){
-		NADataBoxed *boxed = NA_DATA_BOXED( ip->data );
-		const NADataDef *def = na_data_boxed_get_data_def( boxed );
-
-		if( !strcmp( def->name, name )){
-			return( boxed );
-		}
-	}
-
-	return( NULL );
+	return( na_factory_object_get_boxed( object, name ));
 }
 
 /**
@@ -223,6 +211,29 @@ na_ifactory_object_get_as_void( const NAIFactoryObject *object, const gchar *nam
 	return( na_factory_object_get_as_void( object, name ));
 }
 
+/**
+ * na_ifactory_object_peek_as_void:
+ * @object: this #NAIFactoryObject instance.
+ * @name: the elementary data whose value is to be got.
+ *
+ * Contrarily to na_ifactory_object_get_as_void(), strings and string
+ * lists are not copied: the returned value is owned by the @object, and
+ * stays valid until this same elementary data is set again, or the
+ * @object is finalized. It should not be modified nor released by the
+ * caller.
+ *
+ * Returns: the searched value.
+ *
+ * Since: 3.2
+ */
+gconstpointer
+na_ifactory_object_peek_as_void( const NAIFactoryObject *object, const gchar *name )
+{
+	g_return_val_if_fail( NA_IS_IFACTORY_OBJECT( object ), NULL );
+
+	return( na_factory_object_peek_as_void( object, name ));
+}
+
 /**
  * na_ifactory_object_set_from_void:
  * @object: this #NAIFactoryObject instance.
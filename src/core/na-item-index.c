@@ -0,0 +1,616 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gio/gio.h>
+#include <string.h>
+
+#include <api/na-core-utils.h>
+#include <api/na-object-api.h>
+
+#include "na-context-program.h"
+#include "na-item-index.h"
+#include "na-selected-info.h"
+
+/* the features of the selection which are indexed
+ */
+enum {
+	INDEX_SCHEME = 0,
+	INDEX_MIMETYPE,
+	INDEX_EXTENSION,
+	INDEX_N
+};
+
+/* the index
+ * - postings: for each feature, a hash table which maps a key (a scheme,
+ *   an exact or a group mimetype, a lowered extension) to the set of the
+ *   items which may accept it
+ * - any: for each feature, the set of the items which are not restricted
+ *   on it
+ * - targets: maps each indexed item to the mask of the accepted targets
+ */
+struct _NAItemIndex {
+	GHashTable *postings[INDEX_N];
+	GHashTable *any[INDEX_N];
+	GHashTable *targets;
+};
+
+static void        index_tree( NAItemIndex *index, GList *tree );
+static void        index_item( NAItemIndex *index, NAObjectItem *item );
+static void        index_feature( NAItemIndex *index, NAObjectItem *item, guint feature );
+static gboolean    get_item_keys( NAObjectItem *item, guint feature, GSList **keys );
+static gboolean    get_context_keys( const NAIContext *context, guint feature, GSList **keys );
+static gchar      *get_key( guint feature, const gchar *condition );
+static gchar      *get_scheme_key( const gchar *condition );
+static gchar      *get_mimetype_key( const gchar *condition );
+static gchar      *get_extension_key( const gchar *condition );
+static guint       get_targets_mask( NAObjectItem *item );
+static GHashTable *get_selection_values( GList *selection, guint feature );
+static GHashTable *get_accepting_items( const NAItemIndex *index, guint feature, GHashTable *values );
+static GHashTable *get_matching_items( const NAItemIndex *index, guint feature, const gchar *value );
+static gboolean    is_mimetype_key_of( const gchar *key, const gchar *mimetype );
+static GHashTable *set_new( void );
+static void        set_add_all( GHashTable *set, GHashTable *other );
+static GHashTable *set_intersect( GHashTable *a, GHashTable *b );
+
+/*
+ * na_item_index_new:
+ * @tree: the list of the loaded #NAObjectItem items.
+ *
+ * Returns: a newly allocated #NAItemIndex, which should be released with
+ * na_item_index_free().
+ */
+NAItemIndex *
+na_item_index_new( GList *tree )
+{
+	static const gchar *thisfn = "na_item_index_new";
+	NAItemIndex *index;
+	guint i;
+
+	index = g_new0( NAItemIndex, 1 );
+
+	for( i = 0 ; i < INDEX_N ; ++i ){
+		index->postings[i] = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) g_hash_table_destroy );
+		index->any[i] = set_new();
+	}
+
+	index->targets = g_hash_table_new( g_direct_hash, g_direct_equal );
+
+	index_tree( index, tree );
+
+	g_debug( "%s: items=%u, schemes=%u, mimetypes=%u, extensions=%u", thisfn,
+			g_hash_table_size( index->targets ),
+			g_hash_table_size( index->postings[INDEX_SCHEME] ),
+			g_hash_table_size( index->postings[INDEX_MIMETYPE] ),
+			g_hash_table_size( index->postings[INDEX_EXTENSION] ));
+
+	return( index );
+}
+
+/*
+ * na_item_index_free:
+ * @index: this #NAItemIndex.
+ */
+void
+na_item_index_free( NAItemIndex *index )
+{
+	guint i;
+
+	if( index ){
+		for( i = 0 ; i < INDEX_N ; ++i ){
+			g_hash_table_destroy( index->postings[i] );
+			g_hash_table_destroy( index->any[i] );
+		}
+		g_hash_table_destroy( index->targets );
+		g_free( index );
+	}
+}
+
+/*
+ * na_item_index_get_candidates:
+ * @index: this #NAItemIndex.
+ * @target: the current target.
+ * @selection: the current selection as a #GList of #NASelectedInfo.
+ *
+ * Intersects the posting lists of each feature of the @selection.
+ *
+ * Returns: a new set of the #NAObjectItem items which may be candidate
+ * for the @selection, to be released with g_hash_table_destroy().
+ */
+GHashTable *
+na_item_index_get_candidates( const NAItemIndex *index, guint target, GList *selection )
+{
+	static const gchar *thisfn = "na_item_index_get_candidates";
+	GHashTable *candidates, *values, *accepting;
+	GHashTableIter iter;
+	gpointer item;
+	guint i, mask;
+
+	g_return_val_if_fail( index, NULL );
+
+	candidates = NULL;
+
+	for( i = 0 ; i < INDEX_N ; ++i ){
+		values = get_selection_values( selection, i );
+
+		if( values ){
+			accepting = get_accepting_items( index, i, values );
+			candidates = candidates ? set_intersect( candidates, accepting ) : accepting;
+			g_hash_table_destroy( values );
+		}
+	}
+
+	if( !candidates ){
+		candidates = set_new();
+		set_add_all( candidates, index->targets );
+	}
+
+	if( target != ITEM_TARGET_ANY ){
+		g_hash_table_iter_init( &iter, candidates );
+		while( g_hash_table_iter_next( &iter, &item, NULL )){
+			mask = GPOINTER_TO_UINT( g_hash_table_lookup( index->targets, item ));
+			if( !( mask & ( 1 << target ))){
+				g_hash_table_iter_remove( &iter );
+			}
+		}
+	}
+
+	g_debug( "%s: candidates=%u/%u", thisfn, g_hash_table_size( candidates ), g_hash_table_size( index->targets ));
+
+	return( candidates );
+}
+
+static void
+index_tree( NAItemIndex *index, GList *tree )
+{
+	GList *it;
+
+	for( it = tree ; it ; it = it->next ){
+		index_item( index, NA_OBJECT_ITEM( it->data ));
+
+		if( NA_IS_OBJECT_MENU( it->data )){
+			index_tree( index, na_object_get_items( it->data ));
+		}
+	}
+}
+
+static void
+index_item( NAItemIndex *index, NAObjectItem *item )
+{
+	guint i;
+
+	g_hash_table_insert( index->targets, item, GUINT_TO_POINTER( get_targets_mask( item )));
+
+	for( i = 0 ; i < INDEX_N ; ++i ){
+		index_feature( index, item, i );
+	}
+}
+
+static void
+index_feature( NAItemIndex *index, NAObjectItem *item, guint feature )
+{
+	GSList *keys, *ik;
+	GHashTable *posting;
+
+	keys = NULL;
+
+	if( !get_item_keys( item, feature, &keys )){
+		g_hash_table_add( index->any[feature], item );
+
+	} else {
+		for( ik = keys ; ik ; ik = ik->next ){
+			posting = ( GHashTable * ) g_hash_table_lookup( index->postings[feature], ik->data );
+			if( !posting ){
+				posting = set_new();
+				g_hash_table_insert( index->postings[feature], g_strdup( ik->data ), posting );
+			}
+			g_hash_table_add( posting, item );
+		}
+	}
+
+	na_core_utils_slist_free( keys );
+}
+
+/*
+ * the conditions of an action are ANDed with those of any of its
+ * profiles: when the action itself is not restricted on this feature,
+ * it accepts the union of the keys of its profiles
+ *
+ * Returns: %TRUE if the @item only accepts the returned @keys, %FALSE
+ * if it may accept any value
+ */
+static gboolean
+get_item_keys( NAObjectItem *item, guint feature, GSList **keys )
+{
+	GList *ip;
+	GSList *profile_keys;
+
+	if( get_context_keys( NA_ICONTEXT( item ), feature, keys )){
+		return( TRUE );
+	}
+
+	if( !NA_IS_OBJECT_ACTION( item )){
+		return( FALSE );
+	}
+
+	for( ip = na_object_get_items( item ) ; ip ; ip = ip->next ){
+		profile_keys = NULL;
+
+		if( !get_context_keys( NA_ICONTEXT( ip->data ), feature, &profile_keys )){
+			na_core_utils_slist_free( *keys );
+			*keys = NULL;
+			return( FALSE );
+		}
+
+		*keys = g_slist_concat( *keys, profile_keys );
+	}
+
+	return( *keys != NULL );
+}
+
+/*
+ * a list of conditions only restricts the accepted values when all its
+ * conditions are positive, and each of them can be indexed
+ */
+static gboolean
+get_context_keys( const NAIContext *context, guint feature, GSList **keys )
+{
+	GSList *conditions, *ic;
+	gboolean restricted;
+	gchar *key;
+
+	switch( feature ){
+		case INDEX_SCHEME:
+			conditions = na_object_get_schemes( context );
+			break;
+
+		case INDEX_MIMETYPE:
+			conditions = na_object_get_mimetypes( context );
+			break;
+
+		default:
+			conditions = na_object_get_basenames( context );
+			break;
+	}
+
+	restricted = ( conditions != NULL );
+
+	for( ic = conditions ; ic && restricted ; ic = ic->next ){
+		key = get_key( feature, g_strstrip(( gchar * ) ic->data ));
+
+		if( key ){
+			*keys = g_slist_prepend( *keys, key );
+		} else {
+			restricted = FALSE;
+		}
+	}
+
+	if( !restricted ){
+		na_core_utils_slist_free( *keys );
+		*keys = NULL;
+	}
+
+	na_core_utils_slist_free( conditions );
+
+	return( restricted );
+}
+
+/*
+ * Returns: the key under which the @condition should be indexed, or %NULL
+ * if it cannot be indexed (e.g. because it is negative)
+ */
+static gchar *
+get_key( guint feature, const gchar *condition )
+{
+	if( !strlen( condition ) || condition[0] == '!' ){
+		return( NULL );
+	}
+
+	switch( feature ){
+		case INDEX_SCHEME:
+			return( get_scheme_key( condition ));
+
+		case INDEX_MIMETYPE:
+			return( get_mimetype_key( condition ));
+	}
+
+	return( get_extension_key( condition ));
+}
+
+static gchar *
+get_scheme_key( const gchar *condition )
+{
+	if( !strcmp( condition, "*" )){
+		return( NULL );
+	}
+
+	return( g_strdup( condition ));
+}
+
+/*
+ * only 'major/minor' and 'major/ *' mimetypes are indexed
+ */
+static gchar *
+get_mimetype_key( const gchar *condition )
+{
+	const gchar *slash, *star;
+
+	if( na_context_program_is_all_mimetype( condition ) || strstr( condition, "allfiles" )){
+		return( NULL );
+	}
+
+	slash = strchr( condition, '/' );
+	star = strchr( condition, '*' );
+
+	if( !slash || slash == condition || strchr( slash+1, '/' )){
+		return( NULL );
+	}
+
+	if( star && ( star != slash+1 || star[1] != '\0' )){
+		return( NULL );
+	}
+
+	return( g_strdup( condition ));
+}
+
+/*
+ * a basename pattern is indexed by the lowered extension it requires,
+ * i.e. the part after its last dot: this is only possible when the
+ * pattern has no wildcard, or only a leading '*' followed by a dot
+ * somewhere in the suffix - '*.tar.gz' is indexed as 'gz'
+ * the case is ignored, as the full check will take care of it
+ */
+static gchar *
+get_extension_key( const gchar *condition )
+{
+	const gchar *fixed, *dot;
+
+	fixed = ( condition[0] == '*' ) ? condition+1 : condition;
+
+	if( strpbrk( fixed, "*?[" )){
+		return( NULL );
+	}
+
+	dot = strrchr( fixed, '.' );
+
+	if( !dot ){
+		return( fixed == condition ? g_strdup( "" ) : NULL );
+	}
+
+	return( g_utf8_strdown( dot+1, -1 ));
+}
+
+/*
+ * the target is only a condition of the actions
+ */
+static guint
+get_targets_mask( NAObjectItem *item )
+{
+	guint mask;
+
+	if( !NA_IS_OBJECT_ACTION( item )){
+		return( G_MAXUINT );
+	}
+
+	mask = 0;
+
+	if( na_object_is_target_selection( item )){
+		mask |= 1 << ITEM_TARGET_SELECTION;
+	}
+	if( na_object_is_target_location( item )){
+		mask |= 1 << ITEM_TARGET_LOCATION;
+	}
+	if( na_object_is_target_toolbar( item )){
+		mask |= 1 << ITEM_TARGET_TOOLBAR;
+	}
+
+	return( mask );
+}
+
+/*
+ * Returns: the set of the distinct values of the @feature in the
+ * @selection, or %NULL if the @feature cannot be used to filter the items
+ * (e.g. because the mimetype of a file is not known)
+ */
+static GHashTable *
+get_selection_values( GList *selection, guint feature )
+{
+	GHashTable *values;
+	GList *it;
+	const gchar *value, *dot;
+
+	values = g_hash_table_new( g_str_hash, g_str_equal );
+
+	for( it = selection ; it ; it = it->next ){
+		const NASelectedInfo *nsi = NA_SELECTED_INFO( it->data );
+
+		switch( feature ){
+			case INDEX_SCHEME:
+				value = na_selected_info_peek_uri_scheme( nsi );
+				break;
+
+			case INDEX_MIMETYPE:
+				value = na_selected_info_peek_mime_type( nsi );
+				break;
+
+			default:
+				value = na_selected_info_peek_basename_utf8( nsi, FALSE );
+				if( value ){
+					dot = strrchr( value, '.' );
+					value = dot ? dot+1 : "";
+				}
+				break;
+		}
+
+		if( !value ){
+			g_hash_table_destroy( values );
+			return( NULL );
+		}
+
+		g_hash_table_add( values, ( gpointer ) value );
+	}
+
+	if( !g_hash_table_size( values )){
+		g_hash_table_destroy( values );
+		values = NULL;
+	}
+
+	return( values );
+}
+
+/*
+ * as all the files of the selection must satisfy the conditions, an item
+ * is accepted if it is not restricted on this feature, or if it accepts
+ * each of the @values
+ */
+static GHashTable *
+get_accepting_items( const NAItemIndex *index, guint feature, GHashTable *values )
+{
+	GHashTable *accepting, *matching;
+	GHashTableIter iter;
+	gpointer value;
+
+	accepting = NULL;
+	g_hash_table_iter_init( &iter, values );
+
+	while( g_hash_table_iter_next( &iter, &value, NULL )){
+		matching = get_matching_items( index, feature, ( const gchar * ) value );
+		accepting = accepting ? set_intersect( accepting, matching ) : matching;
+	}
+
+	set_add_all( accepting, index->any[feature] );
+
+	return( accepting );
+}
+
+/*
+ * a mimetype may be accepted by an ancestor type: this is checked
+ * against each indexed mimetype, but only once per distinct mimetype of
+ * the selection
+ */
+static GHashTable *
+get_matching_items( const NAItemIndex *index, guint feature, const gchar *value )
+{
+	GHashTable *matching, *posting;
+	GHashTableIter iter;
+	gpointer key;
+
+	matching = set_new();
+
+	if( feature == INDEX_MIMETYPE ){
+		g_hash_table_iter_init( &iter, index->postings[feature] );
+		while( g_hash_table_iter_next( &iter, &key, ( gpointer * ) &posting )){
+			if( is_mimetype_key_of(( const gchar * ) key, value )){
+				set_add_all( matching, posting );
+			}
+		}
+
+	} else {
+		posting = ( GHashTable * ) g_hash_table_lookup( index->postings[feature], value );
+		if( posting ){
+			set_add_all( matching, posting );
+		}
+	}
+
+	return( matching );
+}
+
+/*
+ * see na-context-program.c:is_mimetype_of()
+ */
+static gboolean
+is_mimetype_key_of( const gchar *key, const gchar *mimetype )
+{
+	guint len;
+
+	len = strlen( key );
+
+	if( g_str_has_suffix( key, "/*" )){
+		if( !strncmp( mimetype, key, len-1 )){
+			return( TRUE );
+		}
+
+	} else if( !strcmp( mimetype, key )){
+		return( TRUE );
+	}
+
+	return( g_content_type_is_a( mimetype, key ));
+}
+
+static GHashTable *
+set_new( void )
+{
+	return( g_hash_table_new( g_direct_hash, g_direct_equal ));
+}
+
+static void
+set_add_all( GHashTable *set, GHashTable *other )
+{
+	GHashTableIter iter;
+	gpointer item;
+
+	g_hash_table_iter_init( &iter, other );
+	while( g_hash_table_iter_next( &iter, &item, NULL )){
+		g_hash_table_add( set, item );
+	}
+}
+
+/*
+ * iterates over the smallest set
+ * Returns: the intersection, the two sets being released
+ */
+static GHashTable *
+set_intersect( GHashTable *a, GHashTable *b )
+{
+	GHashTable *smallest, *other;
+	GHashTableIter iter;
+	gpointer item;
+
+	if( g_hash_table_size( a ) <= g_hash_table_size( b )){
+		smallest = a;
+		other = b;
+	} else {
+		smallest = b;
+		other = a;
+	}
+
+	g_hash_table_iter_init( &iter, smallest );
+	while( g_hash_table_iter_next( &iter, &item, NULL )){
+		if( !g_hash_table_contains( other, item )){
+			g_hash_table_iter_remove( &iter );
+		}
+	}
+
+	g_hash_table_destroy( other );
+
+	return( smallest );
+}
@@ -0,0 +1,63 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __CORE_NA_ITEM_INDEX_H__
+#define __CORE_NA_ITEM_INDEX_H__
+
+/* @title: NAItemIndex
+ * @short_description: Inverted index of the loaded items
+ * @include: core/na-item-index.h
+ *
+ * The index maps the features of a selection (the URI scheme, the
+ * mimetype, the extension of the basename) and the target of the menu
+ * to the set of the menus and actions which may be candidate for it.
+ *
+ * The index is conservative: an item it rejects would have been rejected
+ * by na_icontext_is_candidate(), while an item it returns still has to
+ * be fully checked. The conditions of an action are the union of those of
+ * its profiles; the subitems of a menu are indexed as any other item.
+ *
+ * Declare the function only accessed from core library, i.e. not
+ * published as API.
+ */
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _NAItemIndex NAItemIndex;
+
+NAItemIndex *na_item_index_new           ( GList *tree );
+void         na_item_index_free          ( NAItemIndex *index );
+
+GHashTable  *na_item_index_get_candidates( const NAItemIndex *index, guint target, GList *selection );
+
+G_END_DECLS
+
+#endif /* __CORE_NA_ITEM_INDEX_H__ */
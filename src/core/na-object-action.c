@@ -404,13 +404,15 @@ ifactory_object_read_done( NAIFactoryObject *instance, const NAIFactoryProvider
 	 */
 	read_done_deals_with_toolbar_label( instance );
 
-	/* prepare the context after the reading
+	/* set action defaults
 	 */
-	na_icontext_read_done( NA_ICONTEXT( instance ));
+	na_factory_object_set_defaults( instance );
 
-	/* last, set action defaults
+	/* last, prepare the context after the reading
+	 * this is done after defaults have been set as the conditions are
+	 * compiled here
 	 */
-	na_factory_object_set_defaults( instance );
+	na_icontext_read_done( NA_ICONTEXT( instance ));
 }
 
 static guint
@@ -298,13 +298,15 @@ ifactory_object_read_done( NAIFactoryObject *instance, const NAIFactoryProvider
 
 	na_object_item_deals_with_version( NA_OBJECT_ITEM( instance ));
 
-	/* prepare the context after the reading
+	/* set menu defaults
 	 */
-	na_icontext_read_done( NA_ICONTEXT( instance ));
+	na_factory_object_set_defaults( instance );
 
-	/* last, set menu defaults
+	/* last, prepare the context after the reading
+	 * this is done after defaults have been set as the conditions are
+	 * compiled here
 	 */
-	na_factory_object_set_defaults( instance );
+	na_icontext_read_done( NA_ICONTEXT( instance ));
 }
 
 static guint
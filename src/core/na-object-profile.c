@@ -641,13 +641,15 @@ read_done_ending( NAObjectProfile *profile )
 	 */
 	split_path_parameters( profile );
 
-	/* prepare the context after the reading
+	/* set profile defaults
 	 */
-	na_icontext_read_done( NA_ICONTEXT( profile ));
+	na_factory_object_set_defaults( NA_IFACTORY_OBJECT( profile ));
 
-	/* last, set profile defaults
+	/* last, prepare the context after the reading
+	 * this is done after defaults have been set as the conditions are
+	 * compiled here
 	 */
-	na_factory_object_set_defaults( NA_IFACTORY_OBJECT( profile ));
+	na_icontext_read_done( NA_ICONTEXT( profile ));
 }
 
 /*
@@ -37,6 +37,7 @@
 #include <api/na-timeout.h>
 
 #include "na-io-provider.h"
+#include "na-item-index.h"
 #include "na-module.h"
 #include "na-pivot.h"
 
@@ -61,6 +62,11 @@ struct _NAPivotPrivate {
 	 */
 	GList      *tree;
 
+	/* inverted index of the tree, from the features of a selection
+	 * to the items which may be candidate
+	 */
+	NAItemIndex *index;
+
 	/* timeout to manage i/o providers 'item-changed' burst
 	 */
 	NATimeout   change_timeout;
@@ -82,6 +88,9 @@ enum {
  */
 enum {
 	ITEMS_CHANGED,
+	ITEM_ADDED,
+	ITEM_CHANGED,
+	ITEM_REMOVED,
 	LAST_SIGNAL
 };
 
@@ -99,6 +108,14 @@ static void          instance_dispose( GObject *object );
 static void          instance_finalize( GObject *object );
 
 static NAObjectItem *get_item_from_tree( const NAPivot *pivot, GList *tree, const gchar *id );
+static void          reset_index( NAPivot *pivot );
+static gboolean      update_tree( NAPivot *pivot, GList *tree );
+static GHashTable   *index_items( GHashTable *index, GList *tree );
+static gboolean      are_equal_items( const NAObjectItem *a, const NAObjectItem *b );
+static gboolean      are_equal_objects( const NAObject *a, const NAObject *b );
+static gboolean      are_equal_levels( GList *a, GList *b );
+static gboolean      is_clean_rec( const NAObjectItem *item, GHashTable *dirty );
+static void          emit_item_signal( NAPivot *pivot, const gchar *signal, GList *items );
 
 /* NAIIOProvider management */
 static void          on_items_changed_timeout( NAPivot *pivot );
@@ -192,6 +209,57 @@ class_init( NAPivotClass *klass )
 				g_cclosure_marshal_VOID__VOID,
 				G_TYPE_NONE,
 				0 );
+
+	/*
+	 * NAPivot::pivot-item-added:
+	 * NAPivot::pivot-item-changed:
+	 * NAPivot::pivot-item-removed:
+	 *
+	 * These signals are sent by na_pivot_load_items() for each
+	 * #NAObjectItem which has been added, changed or removed since the
+	 * previous load. The item is passed as the only argument of the
+	 * signal.
+	 *
+	 * A removed item is still alive when the signal is emitted, but is
+	 * released right after.
+	 *
+	 * The signals are registered without any default handler.
+	 */
+	st_signals[ ITEM_ADDED ] = g_signal_new(
+				PIVOT_SIGNAL_ITEM_ADDED,
+				NA_TYPE_PIVOT,
+				G_SIGNAL_RUN_LAST,
+				0,									/* class offset */
+				NULL,								/* accumulator */
+				NULL,								/* accumulator data */
+				g_cclosure_marshal_VOID__POINTER,
+				G_TYPE_NONE,
+				1,
+				G_TYPE_POINTER );
+
+	st_signals[ ITEM_CHANGED ] = g_signal_new(
+				PIVOT_SIGNAL_ITEM_CHANGED,
+				NA_TYPE_PIVOT,
+				G_SIGNAL_RUN_LAST,
+				0,									/* class offset */
+				NULL,								/* accumulator */
+				NULL,								/* accumulator data */
+				g_cclosure_marshal_VOID__POINTER,
+				G_TYPE_NONE,
+				1,
+				G_TYPE_POINTER );
+
+	st_signals[ ITEM_REMOVED ] = g_signal_new(
+				PIVOT_SIGNAL_ITEM_REMOVED,
+				NA_TYPE_PIVOT,
+				G_SIGNAL_RUN_LAST,
+				0,									/* class offset */
+				NULL,								/* accumulator */
+				NULL,								/* accumulator data */
+				g_cclosure_marshal_VOID__POINTER,
+				G_TYPE_NONE,
+				1,
+				G_TYPE_POINTER );
 }
 
 static void
@@ -213,6 +281,7 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->loadable_set = PIVOT_LOAD_NONE;
 	self->private->modules = NULL;
 	self->private->tree = NULL;
+	self->private->index = NULL;
 
 	/* initialize timeout parameters for 'item-changed' handler
 	 */
@@ -293,6 +362,7 @@ instance_set_property( GObject *object, guint property_id, const GValue *value,
 
 			case PIVOT_PROP_TREE_ID:
 				self->private->tree = g_value_get_pointer( value );
+				reset_index( self );
 				break;
 
 			default:
@@ -327,6 +397,8 @@ instance_dispose( GObject *object )
 				( void * ) self->private->tree, g_list_length( self->private->tree ));
 		na_object_dump_tree( self->private->tree );
 		self->private->tree = na_object_free_items( self->private->tree );
+		na_item_index_free( self->private->index );
+		self->private->index = NULL;
 
 		/* release the settings */
 		na_settings_free();
@@ -524,6 +596,16 @@ get_item_from_tree( const NAPivot *pivot, GList *tree, const gchar *id )
 	return( found );
 }
 
+/*
+ * the index is rebuilt each time the tree is replaced
+ */
+static void
+reset_index( NAPivot *pivot )
+{
+	na_item_index_free( pivot->private->index );
+	pivot->private->index = na_item_index_new( pivot->private->tree );
+}
+
 /*
  * na_pivot_get_items:
  * @pivot: this #NAPivot instance.
@@ -550,27 +632,64 @@ na_pivot_get_items( const NAPivot *pivot )
 	return( tree );
 }
 
+/*
+ * na_pivot_get_candidate_items:
+ * @pivot: this #NAPivot instance.
+ * @target: the current target.
+ * @selection: the current selection as a #GList of #NASelectedInfo.
+ *
+ * Returns: a new set of the #NAObjectItem items of the tree which may be
+ * candidate for the @selection, to be released with g_hash_table_destroy().
+ * These items have still to be checked with na_icontext_is_candidate().
+ */
+GHashTable *
+na_pivot_get_candidate_items( const NAPivot *pivot, guint target, GList *selection )
+{
+	GHashTable *candidates;
+
+	g_return_val_if_fail( NA_IS_PIVOT( pivot ), NULL );
+
+	candidates = NULL;
+
+	if( !pivot->private->dispose_has_run && pivot->private->index ){
+
+		candidates = na_item_index_get_candidates( pivot->private->index, target, selection );
+	}
+
+	return( candidates );
+}
+
 /*
  * na_pivot_load_items:
  * @pivot: this #NAPivot instance.
  *
  * Loads the hierarchical list of items from I/O providers.
+ *
+ * The newly loaded tree is compared with the current one: unchanged
+ * level-zero items are kept as is, and the added, changed or removed
+ * items are signaled to the consumers.
+ *
+ * Returns: %TRUE if the tree has changed since the previous load.
  */
-void
+gboolean
 na_pivot_load_items( NAPivot *pivot )
 {
 	static const gchar *thisfn = "na_pivot_load_items";
 	GSList *messages, *im;
+	GList *tree;
+	gboolean changed;
 
-	g_return_if_fail( NA_IS_PIVOT( pivot ));
+	g_return_val_if_fail( NA_IS_PIVOT( pivot ), FALSE );
+
+	changed = FALSE;
 
 	if( !pivot->private->dispose_has_run ){
 
 		g_debug( "%s: pivot=%p", thisfn, ( void * ) pivot );
 
 		messages = NULL;
-		na_object_free_items( pivot->private->tree );
-		pivot->private->tree = na_io_provider_load_items( pivot, pivot->private->loadable_set, &messages );
+		tree = na_io_provider_load_items( pivot, pivot->private->loadable_set, &messages );
+		changed = update_tree( pivot, tree );
 
 		for( im = messages ; im ; im = im->next ){
 			g_warning( "%s: %s", thisfn, ( const gchar * ) im->data );
@@ -578,6 +697,206 @@ na_pivot_load_items( NAPivot *pivot )
 
 		na_core_utils_slist_free( messages );
 	}
+
+	return( changed );
+}
+
+/*
+ * replace the current tree with the newly loaded one, keeping the
+ * level-zero items whose whole hierarchy is unchanged, so that the
+ * consumers may keep the data they have attached to them
+ *
+ * the hierarchy itself is not patched node by node: as soon as an item
+ * has changed, its level-zero parent is replaced
+ */
+static gboolean
+update_tree( NAPivot *pivot, GList *tree )
+{
+	static const gchar *thisfn = "na_pivot_update_tree";
+	GHashTable *old_index, *new_index, *dirty;
+	GHashTableIter iter;
+	gpointer id, item, old;
+	GList *added, *changed, *removed, *old_tree, *it;
+	gboolean modified;
+
+	old_index = index_items( NULL, pivot->private->tree );
+	new_index = index_items( NULL, tree );
+	dirty = g_hash_table_new( NULL, NULL );
+	added = NULL;
+	changed = NULL;
+	removed = NULL;
+
+	g_hash_table_iter_init( &iter, new_index );
+	while( g_hash_table_iter_next( &iter, &id, &item )){
+		old = g_hash_table_lookup( old_index, id );
+
+		if( !old ){
+			added = g_list_prepend( added, item );
+			g_hash_table_insert( dirty, item, item );
+
+		} else if( !are_equal_items( NA_OBJECT_ITEM( old ), NA_OBJECT_ITEM( item ))){
+			changed = g_list_prepend( changed, item );
+			g_hash_table_insert( dirty, item, item );
+		}
+	}
+
+	g_hash_table_iter_init( &iter, old_index );
+	while( g_hash_table_iter_next( &iter, &id, &old )){
+		if( !g_hash_table_lookup( new_index, id )){
+			removed = g_list_prepend( removed, old );
+		}
+	}
+
+	modified = added || changed || removed || !are_equal_levels( pivot->private->tree, tree );
+
+	g_debug( "%s: added=%d, changed=%d, removed=%d, modified=%s", thisfn,
+			g_list_length( added ), g_list_length( changed ), g_list_length( removed ),
+			modified ? "True":"False" );
+
+	if( modified ){
+		old_tree = pivot->private->tree;
+
+		for( it = tree ; it ; it = it->next ){
+			id = na_object_get_id( it->data );
+			old = g_hash_table_lookup( old_index, id );
+			g_free( id );
+
+			if( old && g_list_find( old_tree, old ) && is_clean_rec( NA_OBJECT_ITEM( it->data ), dirty )){
+				old_tree = g_list_remove( old_tree, old );
+				na_object_unref( it->data );
+				it->data = old;
+			}
+		}
+
+		pivot->private->tree = tree;
+		reset_index( pivot );
+
+		emit_item_signal( pivot, PIVOT_SIGNAL_ITEM_ADDED, added );
+		emit_item_signal( pivot, PIVOT_SIGNAL_ITEM_CHANGED, changed );
+		emit_item_signal( pivot, PIVOT_SIGNAL_ITEM_REMOVED, removed );
+
+		na_object_free_items( old_tree );
+
+	} else {
+		na_object_free_items( tree );
+	}
+
+	g_list_free( removed );
+	g_list_free( changed );
+	g_list_free( added );
+	g_hash_table_destroy( dirty );
+	g_hash_table_destroy( new_index );
+	g_hash_table_destroy( old_index );
+
+	return( modified );
+}
+
+/*
+ * index the menus and actions of the tree by their id
+ */
+static GHashTable *
+index_items( GHashTable *index, GList *tree )
+{
+	GList *it;
+
+	if( !index ){
+		index = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+	}
+
+	for( it = tree ; it ; it = it->next ){
+		g_hash_table_insert( index, na_object_get_id( it->data ), it->data );
+
+		if( NA_IS_OBJECT_MENU( it->data )){
+			index_items( index, na_object_get_items( it->data ));
+		}
+	}
+
+	return( index );
+}
+
+/*
+ * the children of a menu are only compared by their ids, each of them
+ * being itself compared as an item; the profiles of an action have to
+ * be explicitely compared here
+ */
+static gboolean
+are_equal_items( const NAObjectItem *a, const NAObjectItem *b )
+{
+	gboolean equal;
+	GList *it;
+	gchar *id;
+	NAObjectId *profile;
+
+	equal = G_OBJECT_TYPE( a ) == G_OBJECT_TYPE( b ) &&
+			na_object_get_provider( a ) == na_object_get_provider( b ) &&
+			na_object_is_readonly( a ) == na_object_is_readonly( b ) &&
+			are_equal_objects( NA_OBJECT( a ), NA_OBJECT( b ));
+
+	if( equal && NA_IS_OBJECT_ACTION( b )){
+		for( it = na_object_get_items( b ) ; it && equal ; it = it->next ){
+			id = na_object_get_id( it->data );
+			profile = na_object_get_item( a, id );
+			equal = profile && are_equal_objects( NA_OBJECT( profile ), NA_OBJECT( it->data ));
+			g_free( id );
+		}
+	}
+
+	return( equal );
+}
+
+static gboolean
+are_equal_objects( const NAObject *a, const NAObject *b )
+{
+	return( NA_IDUPLICABLE_GET_INTERFACE( a )->are_equal( NA_IDUPLICABLE( a ), NA_IDUPLICABLE( b )));
+}
+
+/*
+ * the order of the level-zero items
+ */
+static gboolean
+are_equal_levels( GList *a, GList *b )
+{
+	gboolean equal;
+	gchar *a_id, *b_id;
+
+	equal = ( g_list_length( a ) == g_list_length( b ));
+
+	for( ; a && b && equal ; a = a->next, b = b->next ){
+		a_id = na_object_get_id( a->data );
+		b_id = na_object_get_id( b->data );
+		equal = ( strcmp( a_id, b_id ) == 0 );
+		g_free( b_id );
+		g_free( a_id );
+	}
+
+	return( equal );
+}
+
+static gboolean
+is_clean_rec( const NAObjectItem *item, GHashTable *dirty )
+{
+	gboolean clean;
+	GList *it;
+
+	clean = ( g_hash_table_lookup( dirty, item ) == NULL );
+
+	if( clean && NA_IS_OBJECT_MENU( item )){
+		for( it = na_object_get_items( item ) ; it && clean ; it = it->next ){
+			clean = is_clean_rec( NA_OBJECT_ITEM( it->data ), dirty );
+		}
+	}
+
+	return( clean );
+}
+
+static void
+emit_item_signal( NAPivot *pivot, const gchar *signal, GList *items )
+{
+	GList *it;
+
+	for( it = items ; it ; it = it->next ){
+		g_signal_emit_by_name(( gpointer ) pivot, signal, it->data );
+	}
 }
 
 /*
@@ -602,6 +921,7 @@ na_pivot_set_new_items( NAPivot *pivot, GList *items )
 
 		na_object_free_items( pivot->private->tree );
 		pivot->private->tree = items;
+		reset_index( pivot );
 	}
 }
 
@@ -70,6 +70,11 @@
  *
  * It is eventually up to the consumer to connect to this signal, and
  * choose itself whether to reload items or not.
+ *
+ * When reloading, the providers only have to parse again the items which
+ * have actually changed, and the NAPivot object only replaces the
+ * level-zero items whose hierarchy has changed. The consumer may so know
+ * whether it has something to update.
  */
 
 #include <api/na-iio-provider.h>
@@ -122,6 +127,13 @@ GType    na_pivot_get_type( void );
  */
 #define PIVOT_SIGNAL_ITEMS_CHANGED				"pivot-items-changed"
 
+/* When the items are reloaded, NAPivot signals each menu or action
+ * which has been added, changed or removed since the previous load.
+ */
+#define PIVOT_SIGNAL_ITEM_ADDED					"pivot-item-added"
+#define PIVOT_SIGNAL_ITEM_CHANGED				"pivot-item-changed"
+#define PIVOT_SIGNAL_ITEM_REMOVED				"pivot-item-removed"
+
 /* Loadable population
  * CACT management user interface defaults to PIVOT_LOAD_ALL
  * N-A plugin set the loadable population to !PIVOT_LOAD_DISABLED & !PIVOT_LOAD_INVALID
@@ -147,7 +159,8 @@ void          na_pivot_free_providers( GList *providers );
  */
 NAObjectItem *na_pivot_get_item     ( const NAPivot *pivot, const gchar *id );
 GList        *na_pivot_get_items    ( const NAPivot *pivot );
-void          na_pivot_load_items   ( NAPivot *pivot );
+GHashTable   *na_pivot_get_candidate_items( const NAPivot *pivot, guint target, GList *selection );
+gboolean      na_pivot_load_items   ( NAPivot *pivot );
 void          na_pivot_set_new_items( NAPivot *pivot, GList *tree );
 
 void          na_pivot_on_item_changed_handler( NAIIOProvider *provider, NAPivot *pivot  );
@@ -37,6 +37,15 @@
 #include "na-mate-vfs-uri.h"
 #include "na-selected-info.h"
 
+/* the attributes of the selected files are queried in a pool of worker
+ * threads, at most QUERY_MAX_THREADS at a time; the calling thread does
+ * not wait for them more than QUERY_DEADLINE msec: when the deadline is
+ * reached, we fall back to the data provided by Caja, and the files are
+ * not queried again
+ */
+#define QUERY_MAX_THREADS				4
+#define QUERY_DEADLINE					500
+
 /* private class data
  */
 struct _NASelectedInfoClassPrivate {
@@ -55,16 +64,81 @@ struct _NASelectedInfoPrivate {
 	gchar         *username;
 	gchar         *scheme;
 	guint          port;
+
+	/* the path and the URI parts above are only computed on first request
+	 */
+	gboolean       path_is_set;
+	gboolean       uri_is_parsed;
+
 	gchar         *mimetype;
 	GFileType      file_type;
 	gboolean       can_read;
 	gboolean       can_write;
 	gboolean       can_execute;
 	gchar         *owner;
-	gboolean       attributes_are_set;
+
+	/* the NA_SELECTED_INFO_ATTRIBUTE_xxx attributes which are known,
+	 * and those which have already been queried (successfully or not)
+	 */
+	guint          attributes_known;
+	guint          attributes_queried;
+
+	/* UTF-8 forms of the basename and of the dirname, as used when
+	 * matching the conditions; computed on first request
+	 */
+	gchar         *basename_utf8;
+	gchar         *basename_utf8_down;
+	gchar         *dirname_utf8;
 };
 
 
+/* a batch of attribute queries
+ * the batch is shared between the main thread and the worker threads,
+ * and is only released when the last of them has done with it; the
+ * queries which terminate after the main thread has closed the batch
+ * are just ignored
+ */
+typedef struct _QueryJob QueryJob;
+
+typedef struct {
+	GMutex        mutex;
+	GCond         cond;
+	gint          ref_count;
+	guint         pending;
+	gboolean      closed;
+	gchar        *attributes;
+	GCancellable *cancellable;
+	QueryJob     *jobs;
+	guint         count;
+}
+	QueryBatch;
+
+struct _QueryJob {
+	QueryBatch   *batch;
+	GFile        *location;
+	GFileInfo    *info;
+	GError       *error;
+	gboolean      done;
+};
+
+/* the GIO attributes which correspond to each NA_SELECTED_INFO_ATTRIBUTE
+ */
+typedef struct {
+	guint        attribute;
+	const gchar *gio_attribute;
+}
+	QueryAttribute;
+
+static const QueryAttribute st_query_attributes[] = {
+		{ NA_SELECTED_INFO_ATTRIBUTE_TYPE,         G_FILE_ATTRIBUTE_STANDARD_TYPE },
+		{ NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE },
+		{ NA_SELECTED_INFO_ATTRIBUTE_CAN_READ,     G_FILE_ATTRIBUTE_ACCESS_CAN_READ },
+		{ NA_SELECTED_INFO_ATTRIBUTE_CAN_WRITE,    G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE },
+		{ NA_SELECTED_INFO_ATTRIBUTE_CAN_EXECUTE,  G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE },
+		{ NA_SELECTED_INFO_ATTRIBUTE_OWNER,        G_FILE_ATTRIBUTE_OWNER_USER },
+		{ 0 }
+};
+
 static GObjectClass *st_parent_class = NULL;
 
 static GType           register_type( void );
@@ -76,8 +150,18 @@ static void            instance_finalize( GObject *object );
 static void            dump( const NASelectedInfo *nsi );
 static const char     *dump_file_type( GFileType type );
 static NASelectedInfo *new_from_caja_file_info( CajaFileInfo *item );
-static NASelectedInfo *new_from_uri( const gchar *uri, const gchar *mimetype, gchar **errmsg );
-static void            query_file_attributes( NASelectedInfo *info, GFile *location, gchar **errmsg );
+static NASelectedInfo *new_from_uri( const gchar *uri, const gchar *mimetype );
+static void            setup_path( const NASelectedInfo *nsi );
+static void            setup_uri_parts( const NASelectedInfo *nsi );
+static gchar          *get_query_attributes( guint attributes );
+static void            query_file_attributes( NASelectedInfo *info, guint attributes, gchar **errmsg );
+static void            query_file_attributes_batch( GList *infos, guint attributes, gboolean last_try );
+static void            query_missing_attributes( const NASelectedInfo *nsi, guint attribute );
+static void            query_job_run( QueryJob *job, QueryBatch *batch );
+static void            query_batch_unref( QueryBatch *batch );
+static void            set_attributes_from_caja( NASelectedInfo *nsi, CajaFileInfo *item );
+static void            set_attributes_from_info( NASelectedInfo *nsi, GFileInfo *info, guint attributes );
+static gchar          *filename_to_utf8( const gchar *filename );
 
 GType
 na_selected_info_get_type( void )
@@ -194,6 +278,9 @@ instance_finalize( GObject *object )
 	g_free( self->private->scheme );
 	g_free( self->private->mimetype );
 	g_free( self->private->owner );
+	g_free( self->private->basename_utf8 );
+	g_free( self->private->basename_utf8_down );
+	g_free( self->private->dirname_utf8 );
 
 	g_free( self->private );
 
@@ -206,21 +293,19 @@ instance_finalize( GObject *object )
 /*
  * na_selected_info_get_list_from_item:
  * @item: a #CajaFileInfo item
+ * @attributes: the NA_SELECTED_INFO_ATTRIBUTE_xxx attributes to be queried.
  *
  * Returns: a #GList list which contains a #NASelectedInfo item with the
  * same URI that the @item.
  */
 GList *
-na_selected_info_get_list_from_item( CajaFileInfo *item )
+na_selected_info_get_list_from_item( CajaFileInfo *item, guint attributes )
 {
-	GList *selected;
+	GList *items, *selected;
 
-	selected = NULL;
-	NASelectedInfo *info = new_from_caja_file_info( item );
-
-	if( info ){
-		selected = g_list_prepend( NULL, info );
-	}
+	items = g_list_prepend( NULL, item );
+	selected = na_selected_info_get_list_from_list( items, attributes );
+	g_list_free( items );
 
 	return( selected );
 }
@@ -228,27 +313,39 @@ na_selected_info_get_list_from_item( CajaFileInfo *item )
 /*
  * na_selected_info_get_list_from_list:
  * @caja_selection: a #GList list of #CajaFileInfo items.
+ * @attributes: the NA_SELECTED_INFO_ATTRIBUTE_xxx attributes to be queried.
+ *
+ * Most attributes are directly provided by Caja. Those of @attributes
+ * which are not are queried for all the selected items at once, with a
+ * bounded concurrency and a bounded delay.
+ * Other missing attributes are only queried when first requested.
  *
  * Returns: a #GList list of #NASelectedInfo items whose URI correspond
  * to those of @caja_selection.
  */
 GList *
-na_selected_info_get_list_from_list( GList *caja_selection )
+na_selected_info_get_list_from_list( GList *caja_selection, guint attributes )
 {
 	GList *selected;
 	GList *it;
+	guint missing;
 
 	selected = NULL;
+	missing = 0;
 
 	for( it = caja_selection ; it ; it = it->next ){
 		NASelectedInfo *info = new_from_caja_file_info( CAJA_FILE_INFO( it->data ));
+		missing |= ( attributes & ~info->private->attributes_known );
+		selected = g_list_prepend( selected, info );
+	}
 
-		if( info ){
-			selected = g_list_prepend( selected, info );
-		}
+	selected = g_list_reverse( selected );
+
+	if( missing ){
+		query_file_attributes_batch( selected, missing, FALSE );
 	}
 
-	return( selected ? g_list_reverse( selected ) : NULL );
+	return( selected );
 }
 
 /*
@@ -304,6 +401,7 @@ na_selected_info_get_basename( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_path( nsi );
 		basename = g_strdup( nsi->private->basename );
 	}
 
@@ -329,6 +427,7 @@ na_selected_info_get_dirname( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_path( nsi );
 		dirname = g_strdup( nsi->private->dirname );
 	}
 
@@ -353,6 +452,7 @@ na_selected_info_get_mime_type( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE );
 		if( nsi->private->mimetype ){
 			mimetype = g_strdup( nsi->private->mimetype );
 		}
@@ -379,6 +479,7 @@ na_selected_info_get_path( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_path( nsi );
 		path = g_strdup( nsi->private->filename );
 	}
 
@@ -427,6 +528,7 @@ na_selected_info_get_uri_host( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_uri_parts( nsi );
 		host = g_strdup( nsi->private->hostname );
 	}
 
@@ -451,6 +553,7 @@ na_selected_info_get_uri_user( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_uri_parts( nsi );
 		user = g_strdup( nsi->private->username );
 	}
 
@@ -474,6 +577,7 @@ na_selected_info_get_uri_port( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_uri_parts( nsi );
 		port = nsi->private->port;
 	}
 
@@ -498,6 +602,7 @@ na_selected_info_get_uri_scheme( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		setup_uri_parts( nsi );
 		scheme = g_strdup( nsi->private->scheme );
 	}
 
@@ -521,6 +626,7 @@ na_selected_info_is_directory( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_TYPE );
 		is_dir = ( nsi->private->file_type == G_FILE_TYPE_DIRECTORY );
 	}
 
@@ -544,6 +650,7 @@ na_selected_info_is_regular( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_TYPE );
 		is_regular = ( nsi->private->file_type == G_FILE_TYPE_REGULAR );
 	}
 
@@ -567,6 +674,7 @@ na_selected_info_is_executable( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_CAN_EXECUTE );
 		is_exe = nsi->private->can_execute;
 	}
 
@@ -583,7 +691,6 @@ gboolean
 na_selected_info_is_local( const NASelectedInfo *nsi )
 {
 	gboolean is_local;
-	gchar *scheme;
 
 	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), FALSE );
 
@@ -591,9 +698,8 @@ na_selected_info_is_local( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
-		scheme = na_selected_info_get_uri_scheme( nsi );
-		is_local = ( strcmp( scheme, "file" ) == 0 );
-		g_free( scheme );
+		setup_uri_parts( nsi );
+		is_local = ( g_strcmp0( nsi->private->scheme, "file" ) == 0 );
 	}
 
 	return( is_local );
@@ -617,7 +723,8 @@ na_selected_info_is_owner( const NASelectedInfo *nsi, const gchar *user )
 
 	if( !nsi->private->dispose_has_run ){
 
-		is_owner = ( strcmp( nsi->private->owner, user ) == 0 );
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_OWNER );
+		is_owner = ( user && nsi->private->owner && strcmp( nsi->private->owner, user ) == 0 );
 	}
 
 	return( is_owner );
@@ -640,6 +747,7 @@ na_selected_info_is_readable( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_CAN_READ );
 		is_readable = nsi->private->can_read;
 	}
 
@@ -663,12 +771,159 @@ na_selected_info_is_writable( const NASelectedInfo *nsi )
 
 	if( !nsi->private->dispose_has_run ){
 
+		query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_CAN_WRITE );
 		is_writable = nsi->private->can_write;
 	}
 
 	return( is_writable );
 }
 
+/*
+ * na_selected_info_peek_basename_utf8:
+ * @nsi: this #NASelectedInfo object.
+ * @matchcase: whether the case is significant.
+ *
+ * The UTF-8 conversion (and the case folding when @matchcase is %FALSE)
+ * is computed on first request, and then kept for the life of the object.
+ *
+ * Returns: the basename of the file converted to UTF-8, lowered if
+ * @matchcase is %FALSE. The returned string is owned by the @nsi object
+ * and should not be released by the caller.
+ */
+const gchar *
+na_selected_info_peek_basename_utf8( const NASelectedInfo *nsi, gboolean matchcase )
+{
+	NASelectedInfoPrivate *priv;
+
+	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), NULL );
+
+	if( nsi->private->dispose_has_run ){
+		return( NULL );
+	}
+
+	priv = nsi->private;
+
+	if( !priv->basename_utf8 ){
+		setup_path( nsi );
+		priv->basename_utf8 = filename_to_utf8( priv->basename );
+	}
+
+	if( matchcase ){
+		return( priv->basename_utf8 );
+	}
+
+	if( !priv->basename_utf8_down ){
+		priv->basename_utf8_down = g_utf8_strdown( priv->basename_utf8, -1 );
+	}
+
+	return( priv->basename_utf8_down );
+}
+
+/*
+ * na_selected_info_peek_dirname_utf8:
+ * @nsi: this #NASelectedInfo object.
+ *
+ * Returns: the dirname of the file converted to UTF-8, as a string
+ * which is owned by the @nsi object and should not be released by the
+ * caller.
+ */
+const gchar *
+na_selected_info_peek_dirname_utf8( const NASelectedInfo *nsi )
+{
+	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), NULL );
+
+	if( nsi->private->dispose_has_run ){
+		return( NULL );
+	}
+
+	if( !nsi->private->dirname_utf8 ){
+		setup_path( nsi );
+		nsi->private->dirname_utf8 = filename_to_utf8( nsi->private->dirname );
+	}
+
+	return( nsi->private->dirname_utf8 );
+}
+
+/*
+ * na_selected_info_peek_mime_type:
+ * @nsi: this #NASelectedInfo object.
+ *
+ * Returns: the mime type associated with this #NASelectedInfo object,
+ * as a string which is owned by the @nsi object and should not be
+ * released by the caller, or %NULL.
+ */
+const gchar *
+na_selected_info_peek_mime_type( const NASelectedInfo *nsi )
+{
+	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), NULL );
+
+	if( nsi->private->dispose_has_run ){
+		return( NULL );
+	}
+
+	query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE );
+
+	return( nsi->private->mimetype );
+}
+
+/*
+ * na_selected_info_peek_owner:
+ * @nsi: this #NASelectedInfo object.
+ *
+ * Returns: the owner of the file, as a string which is owned by the
+ * @nsi object and should not be released by the caller, or %NULL.
+ */
+const gchar *
+na_selected_info_peek_owner( const NASelectedInfo *nsi )
+{
+	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), NULL );
+
+	if( nsi->private->dispose_has_run ){
+		return( NULL );
+	}
+
+	query_missing_attributes( nsi, NA_SELECTED_INFO_ATTRIBUTE_OWNER );
+
+	return( nsi->private->owner );
+}
+
+/*
+ * na_selected_info_peek_uri:
+ * @nsi: this #NASelectedInfo object.
+ *
+ * Returns: the URI associated with this #NASelectedInfo object, as a
+ * string which is owned by the @nsi object and should not be released
+ * by the caller.
+ */
+const gchar *
+na_selected_info_peek_uri( const NASelectedInfo *nsi )
+{
+	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), NULL );
+
+	return( nsi->private->dispose_has_run ? NULL : nsi->private->uri );
+}
+
+/*
+ * na_selected_info_peek_uri_scheme:
+ * @nsi: this #NASelectedInfo object.
+ *
+ * Returns: the scheme associated to this @nsi object, as a string which
+ * is owned by the @nsi object and should not be released by the caller.
+ */
+const gchar *
+na_selected_info_peek_uri_scheme( const NASelectedInfo *nsi )
+{
+	g_return_val_if_fail( NA_IS_SELECTED_INFO( nsi ), NULL );
+
+	if( nsi->private->dispose_has_run ){
+		return( NULL );
+	}
+
+	setup_uri_parts( nsi );
+
+	return( nsi->private->scheme );
+}
+
 /*
  * na_selected_info_create_for_uri:
  * @uri: an URI.
@@ -685,7 +940,9 @@ na_selected_info_create_for_uri( const gchar *uri, const gchar *mimetype, gchar
 
 	g_debug( "%s: uri=%s, mimetype=%s", thisfn, uri, mimetype );
 
-	NASelectedInfo *obj = new_from_uri( uri, mimetype, errmsg );
+	NASelectedInfo *obj = new_from_uri( uri, mimetype );
+	query_file_attributes( obj, NA_SELECTED_INFO_ATTRIBUTE_ALL, errmsg );
+	dump( obj );
 
 	return( obj );
 }
@@ -704,7 +961,7 @@ dump( const NASelectedInfo *nsi )
 	g_debug( "%s:           username=%s", thisfn, nsi->private->username );
 	g_debug( "%s:             scheme=%s", thisfn, nsi->private->scheme );
 	g_debug( "%s:               port=%d", thisfn, nsi->private->port );
-	g_debug( "%s: attributes_are_set=%s", thisfn, nsi->private->attributes_are_set ? "True":"False" );
+	g_debug( "%s:   attributes_known=0x%x", thisfn, nsi->private->attributes_known );
 	g_debug( "%s:          file_type=%s", thisfn, dump_file_type( nsi->private->file_type ));
 	g_debug( "%s:           can_read=%s", thisfn, nsi->private->can_read ? "True":"False" );
 	g_debug( "%s:          can_write=%s", thisfn, nsi->private->can_write ? "True":"False" );
@@ -739,10 +996,12 @@ new_from_caja_file_info( CajaFileInfo *item )
 {
 	gchar *uri = caja_file_info_get_uri( item );
 	gchar *mimetype = caja_file_info_get_mime_type( item );
-	NASelectedInfo *info = new_from_uri( uri, mimetype, NULL );
+	NASelectedInfo *info = new_from_uri( uri, mimetype );
 	g_free( mimetype );
 	g_free( uri );
 
+	set_attributes_from_caja( info, item );
+
 	return( info );
 }
 
@@ -804,11 +1063,8 @@ new_from_caja_file_info( CajaFileInfo *item )
  * As a result, we may have valid, non-escaped, simple quotes in an URI.
  */
 static NASelectedInfo *
-new_from_uri( const gchar *uri, const gchar *mimetype, gchar **errmsg )
+new_from_uri( const gchar *uri, const gchar *mimetype )
 {
-	GFile *location;
-	NAMateVFSURI *vfs;
-
 	NASelectedInfo *info = g_object_new( NA_TYPE_SELECTED_INFO, NULL );
 
 	info->private->uri = g_strdup( uri );
@@ -816,53 +1072,111 @@ new_from_uri( const gchar *uri, const gchar *mimetype, gchar **errmsg )
 		info->private->mimetype = g_strdup( mimetype );
 	}
 
-	/* pwi 2011-05-18
-	 * Filename and dirname should be taken from the GFile location, itself taken
-	 * from the URI, so that we have dir='/home/pierre/.gvfs/sftp on stormy.trychlos.org/etc'
-	 * Taking filename and dirname from URI just gives '/etc'
-	 * see #650523
-	 */
-	location = g_file_new_for_uri( uri );
-	info->private->filename = g_file_get_path( location );
+	return( info );
+}
+
+/*
+ * pwi 2011-05-18
+ * Filename and dirname should be taken from the GFile location, itself taken
+ * from the URI, so that we have dir='/home/pierre/.gvfs/sftp on stormy.trychlos.org/etc'
+ * Taking filename and dirname from URI just gives '/etc'
+ * see #650523
+ */
+static void
+setup_path( const NASelectedInfo *nsi )
+{
+	NASelectedInfoPrivate *priv;
+	GFile *location;
+	NAMateVFSURI *vfs;
+
+	priv = nsi->private;
+
+	if( priv->path_is_set ){
+		return;
+	}
+
+	location = g_file_new_for_uri( priv->uri );
+	priv->filename = g_file_get_path( location );
+	g_object_unref( location );
+
+	if( !priv->filename ){
+		vfs = g_new0( NAMateVFSURI, 1 );
+		na_mate_vfs_uri_parse( vfs, priv->uri );
+		g_debug( "na_selected_info_setup_path: uri='%s', filename=NULL, setting it to '%s'", priv->uri, vfs->path );
+		priv->filename = g_strdup( vfs->path );
+		na_mate_vfs_uri_free( vfs );
+	}
+
+	priv->basename = g_path_get_basename( priv->filename );
+	priv->dirname = g_path_get_dirname( priv->filename );
+
+	priv->path_is_set = TRUE;
+}
+
+static void
+setup_uri_parts( const NASelectedInfo *nsi )
+{
+	NASelectedInfoPrivate *priv;
+	NAMateVFSURI *vfs;
+
+	priv = nsi->private;
+
+	if( priv->uri_is_parsed ){
+		return;
+	}
 
 	vfs = g_new0( NAMateVFSURI, 1 );
-	na_mate_vfs_uri_parse( vfs, uri );
-	if( !info->private->filename ){
-		g_debug( "na_selected_info_new_from_uri: uri='%s', filename=NULL, setting it to '%s'", uri, vfs->path );
-		info->private->filename = g_strdup( vfs->path );
-	}
-
-	info->private->basename = g_path_get_basename( info->private->filename );
-	info->private->dirname = g_path_get_dirname( info->private->filename );
-	info->private->hostname = g_strdup( vfs->host_name );
-	info->private->username = g_strdup( vfs->user_name );
-	info->private->scheme = g_strdup( vfs->scheme );
-	info->private->port = vfs->host_port;
+	na_mate_vfs_uri_parse( vfs, priv->uri );
+
+	priv->hostname = g_strdup( vfs->host_name );
+	priv->username = g_strdup( vfs->user_name );
+	priv->scheme = g_strdup( vfs->scheme );
+	priv->port = vfs->host_port;
+
 	na_mate_vfs_uri_free( vfs );
 
-	query_file_attributes( info, location, errmsg );
-	g_object_unref( location );
+	priv->uri_is_parsed = TRUE;
+}
+
+/*
+ * Returns: the list of GIO attributes to be queried, as a newly allocated
+ * string which should be g_free() by the caller.
+ */
+static gchar *
+get_query_attributes( guint attributes )
+{
+	GString *str;
+	guint i;
 
-	dump( info );
+	str = g_string_new( "" );
 
-	return( info );
+	for( i = 0 ; st_query_attributes[i].attribute ; ++i ){
+		if( attributes & st_query_attributes[i].attribute ){
+			if( str->len ){
+				g_string_append_c( str, ',' );
+			}
+			g_string_append( str, st_query_attributes[i].gio_attribute );
+		}
+	}
+
+	return( g_string_free( str, FALSE ));
 }
 
 static void
-query_file_attributes( NASelectedInfo *nsi, GFile *location, gchar **errmsg )
+query_file_attributes( NASelectedInfo *nsi, guint attributes, gchar **errmsg )
 {
 	static const gchar *thisfn = "na_selected_info_query_file_attributes";
 	GError *error;
+	GFile *location;
+	gchar *query;
 
 	error = NULL;
-	GFileInfo *info = g_file_query_info( location,
-			G_FILE_ATTRIBUTE_STANDARD_TYPE
-				"," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE
-				"," G_FILE_ATTRIBUTE_ACCESS_CAN_READ
-				"," G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE
-				"," G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE
-				"," G_FILE_ATTRIBUTE_OWNER_USER,
-			G_FILE_QUERY_INFO_NONE, NULL, &error );
+	nsi->private->attributes_queried |= attributes;
+	location = g_file_new_for_uri( nsi->private->uri );
+	query = get_query_attributes( attributes );
+	GFileInfo *info = g_file_query_info( location, query, G_FILE_QUERY_INFO_NONE, NULL, &error );
+	g_free( query );
+	g_object_unref( location );
 
 	if( error ){
 		if( errmsg ){
@@ -874,19 +1188,285 @@ query_file_attributes( NASelectedInfo *nsi, GFile *location, gchar **errmsg )
 		return;
 	}
 
-	if( !nsi->private->mimetype ){
-		nsi->private->mimetype = g_strdup( g_file_info_get_attribute_as_string( info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ));
+	set_attributes_from_info( nsi, info, attributes );
+
+	g_object_unref( info );
+}
+
+/*
+ * query the attributes of all @infos in a pool of worker threads
+ *
+ * the calling thread is blocked until all the queries have terminated,
+ * but at most QUERY_DEADLINE msec
+ *
+ * if the deadline is reached, the @attributes are marked as queried for
+ * all the @infos, which so keep the data provided by Caja, and no
+ * attribute at all will be queried again for the files which have not
+ * answered in time
+ *
+ * the attributes of the items whose query has failed stay unknown, and
+ * may be queried again when requested, unless this is the @last_try
+ */
+static void
+query_file_attributes_batch( GList *infos, guint attributes, gboolean last_try )
+{
+	static const gchar *thisfn = "na_selected_info_query_file_attributes_batch";
+	QueryBatch *batch;
+	GThreadPool *pool;
+	GError *error;
+	GList *it;
+	gint64 end_time;
+	guint i, timed_out;
+
+	batch = g_new0( QueryBatch, 1 );
+	g_mutex_init( &batch->mutex );
+	g_cond_init( &batch->cond );
+	batch->ref_count = 1;
+	batch->attributes = get_query_attributes( attributes );
+	batch->cancellable = g_cancellable_new();
+	batch->count = g_list_length( infos );
+	batch->jobs = g_new0( QueryJob, batch->count );
+
+	error = NULL;
+	pool = g_thread_pool_new(( GFunc ) query_job_run, batch, QUERY_MAX_THREADS, FALSE, &error );
+
+	if( !pool ){
+		g_warning( "%s: g_thread_pool_new: %s", thisfn, error->message );
+		g_error_free( error );
+
+		for( it = infos ; it ; it = it->next ){
+			query_file_attributes( NA_SELECTED_INFO( it->data ), attributes, NULL );
+			dump( NA_SELECTED_INFO( it->data ));
+		}
+
+		query_batch_unref( batch );
+		return;
+	}
+
+	end_time = g_get_monotonic_time() + QUERY_DEADLINE * G_TIME_SPAN_MILLISECOND;
+
+	for( it = infos, i = 0 ; it ; it = it->next, ++i ){
+		QueryJob *job = &batch->jobs[i];
+		job->batch = batch;
+		job->location = g_file_new_for_uri( NA_SELECTED_INFO( it->data )->private->uri );
+
+		g_mutex_lock( &batch->mutex );
+		batch->ref_count += 1;
+		batch->pending += 1;
+		g_mutex_unlock( &batch->mutex );
+
+		g_thread_pool_push( pool, job, NULL );
 	}
 
-	nsi->private->file_type = ( GFileType ) g_file_info_get_attribute_uint32( info, G_FILE_ATTRIBUTE_STANDARD_TYPE );
+	timed_out = 0;
+	g_mutex_lock( &batch->mutex );
+
+	while( batch->pending ){
+		if( !g_cond_wait_until( &batch->cond, &batch->mutex, end_time )){
+			break;
+		}
+	}
 
-	nsi->private->can_read = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_READ );
-	nsi->private->can_write = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE );
-	nsi->private->can_execute = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE );
+	batch->closed = TRUE;
 
-	nsi->private->owner = g_strdup( g_file_info_get_attribute_as_string( info, G_FILE_ATTRIBUTE_OWNER_USER ));
+	for( it = infos, i = 0 ; it ; it = it->next, ++i ){
+		QueryJob *job = &batch->jobs[i];
+		NASelectedInfo *nsi = NA_SELECTED_INFO( it->data );
 
-	nsi->private->attributes_are_set = TRUE;
+		if( job->info ){
+			nsi->private->attributes_queried |= attributes;
+			set_attributes_from_info( nsi, job->info, attributes );
 
-	g_object_unref( info );
+		} else if( job->error ){
+			g_warning( "%s: uri=%s, g_file_query_info: %s", thisfn, nsi->private->uri, job->error->message );
+			if( last_try ){
+				nsi->private->attributes_queried |= attributes;
+			}
+
+		} else if( !job->done ){
+			nsi->private->attributes_queried |= NA_SELECTED_INFO_ATTRIBUTE_ALL;
+			timed_out += 1;
+		}
+
+		dump( nsi );
+	}
+
+	g_mutex_unlock( &batch->mutex );
+
+	if( timed_out ){
+		g_debug( "%s: %u/%u queries have not terminated after %u msec, using Caja data instead",
+				thisfn, timed_out, batch->count, QUERY_DEADLINE );
+		g_cancellable_cancel( batch->cancellable );
+
+		for( it = infos ; it ; it = it->next ){
+			NA_SELECTED_INFO( it->data )->private->attributes_queried |= attributes;
+		}
+	}
+
+	/* queued jobs will be quickly run as the batch is now cancelled */
+	g_thread_pool_free( pool, FALSE, FALSE );
+	query_batch_unref( batch );
+}
+
+/*
+ * this is run in a worker thread
+ */
+static void
+query_job_run( QueryJob *job, QueryBatch *batch )
+{
+	GFileInfo *info;
+	GError *error;
+
+	info = NULL;
+	error = NULL;
+
+	if( !g_cancellable_is_cancelled( batch->cancellable )){
+		info = g_file_query_info( job->location, batch->attributes, G_FILE_QUERY_INFO_NONE, batch->cancellable, &error );
+	}
+
+	g_mutex_lock( &batch->mutex );
+
+	if( batch->closed ){
+		if( info ){
+			g_object_unref( info );
+		}
+		if( error ){
+			g_error_free( error );
+		}
+
+	} else {
+		job->info = info;
+		job->error = error;
+		job->done = TRUE;
+	}
+
+	batch->pending -= 1;
+	g_cond_signal( &batch->cond );
+	g_mutex_unlock( &batch->mutex );
+
+	query_batch_unref( batch );
+}
+
+static void
+query_batch_unref( QueryBatch *batch )
+{
+	gboolean last;
+	guint i;
+
+	g_mutex_lock( &batch->mutex );
+	batch->ref_count -= 1;
+	last = ( batch->ref_count == 0 );
+	g_mutex_unlock( &batch->mutex );
+
+	if( last ){
+		for( i = 0 ; i < batch->count ; ++i ){
+			if( batch->jobs[i].location ){
+				g_object_unref( batch->jobs[i].location );
+			}
+			if( batch->jobs[i].info ){
+				g_object_unref( batch->jobs[i].info );
+			}
+			if( batch->jobs[i].error ){
+				g_error_free( batch->jobs[i].error );
+			}
+		}
+		g_free( batch->jobs );
+		g_object_unref( batch->cancellable );
+		g_free( batch->attributes );
+		g_mutex_clear( &batch->mutex );
+		g_cond_clear( &batch->cond );
+		g_free( batch );
+	}
+}
+
+/*
+ * Caja does not provide the read and execute access rights, nor the
+ * owner of the file
+ */
+static void
+set_attributes_from_caja( NASelectedInfo *nsi, CajaFileInfo *item )
+{
+	nsi->private->file_type = caja_file_info_get_file_type( item );
+	nsi->private->can_write = caja_file_info_can_write( item );
+	nsi->private->attributes_known |= NA_SELECTED_INFO_ATTRIBUTE_TYPE | NA_SELECTED_INFO_ATTRIBUTE_CAN_WRITE;
+
+	if( nsi->private->mimetype ){
+		nsi->private->attributes_known |= NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE;
+	}
+}
+
+/*
+ * only set the @attributes which have been queried, so that we do not
+ * override the data provided by Caja
+ */
+static void
+set_attributes_from_info( NASelectedInfo *nsi, GFileInfo *info, guint attributes )
+{
+	if(( attributes & NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE ) && !nsi->private->mimetype ){
+		nsi->private->mimetype = g_file_info_get_attribute_as_string( info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE );
+	}
+
+	if( attributes & NA_SELECTED_INFO_ATTRIBUTE_TYPE ){
+		nsi->private->file_type = ( GFileType ) g_file_info_get_attribute_uint32( info, G_FILE_ATTRIBUTE_STANDARD_TYPE );
+	}
+
+	if( attributes & NA_SELECTED_INFO_ATTRIBUTE_CAN_READ ){
+		nsi->private->can_read = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_READ );
+	}
+
+	if( attributes & NA_SELECTED_INFO_ATTRIBUTE_CAN_WRITE ){
+		nsi->private->can_write = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE );
+	}
+
+	if( attributes & NA_SELECTED_INFO_ATTRIBUTE_CAN_EXECUTE ){
+		nsi->private->can_execute = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE );
+	}
+
+	if( attributes & NA_SELECTED_INFO_ATTRIBUTE_OWNER ){
+		g_free( nsi->private->owner );
+		nsi->private->owner = g_file_info_get_attribute_as_string( info, G_FILE_ATTRIBUTE_OWNER_USER );
+	}
+
+	nsi->private->attributes_known |= attributes;
+}
+
+/*
+ * query the requested attribute if it is neither known nor has already
+ * been queried; this is bounded by the same deadline as the batch
+ * query, and is only tried once
+ */
+static void
+query_missing_attributes( const NASelectedInfo *nsi, guint attribute )
+{
+	GList *infos;
+
+	if( nsi->private->attributes_known & attribute ){
+		return;
+	}
+
+	if( nsi->private->attributes_queried & attribute ){
+		return;
+	}
+
+	infos = g_list_prepend( NULL, ( gpointer ) nsi );
+	query_file_attributes_batch( infos, attribute, TRUE );
+	g_list_free( infos );
+}
+
+/*
+ * the conversion may fail if the filename is not in the encoding
+ * expected by GLib: we then keep the raw filename
+ */
+static gchar *
+filename_to_utf8( const gchar *filename )
+{
+	gchar *utf8;
+
+	utf8 = g_filename_to_utf8( filename, -1, NULL, NULL, NULL );
+
+	if( !utf8 ){
+		utf8 = g_strdup( filename ? filename : "" );
+	}
+
+	return( utf8 );
 }
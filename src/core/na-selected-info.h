@@ -72,10 +72,23 @@ typedef struct {
 }
 	NASelectedInfoClass;
 
+/* the file attributes which may have to be queried to evaluate the
+ * conditions of the loaded items
+ */
+enum {
+	NA_SELECTED_INFO_ATTRIBUTE_TYPE         = 1 << 0,
+	NA_SELECTED_INFO_ATTRIBUTE_CONTENT_TYPE = 1 << 1,
+	NA_SELECTED_INFO_ATTRIBUTE_CAN_READ     = 1 << 2,
+	NA_SELECTED_INFO_ATTRIBUTE_CAN_WRITE    = 1 << 3,
+	NA_SELECTED_INFO_ATTRIBUTE_CAN_EXECUTE  = 1 << 4,
+	NA_SELECTED_INFO_ATTRIBUTE_OWNER        = 1 << 5,
+	NA_SELECTED_INFO_ATTRIBUTE_ALL          = ( 1 << 6 ) - 1
+};
+
 GType           na_selected_info_get_type( void );
 
-GList          *na_selected_info_get_list_from_item( CajaFileInfo *item );
-GList          *na_selected_info_get_list_from_list( GList *caja_selection );
+GList          *na_selected_info_get_list_from_item( CajaFileInfo *item, guint attributes );
+GList          *na_selected_info_get_list_from_list( GList *caja_selection, guint attributes );
 GList          *na_selected_info_copy_list         ( GList *files );
 void            na_selected_info_free_list         ( GList *files );
 
@@ -96,6 +109,13 @@ gboolean        na_selected_info_is_owner      ( const NASelectedInfo *nsi, cons
 gboolean        na_selected_info_is_readable   ( const NASelectedInfo *nsi );
 gboolean        na_selected_info_is_writable   ( const NASelectedInfo *nsi );
 
+const gchar    *na_selected_info_peek_basename_utf8( const NASelectedInfo *nsi, gboolean matchcase );
+const gchar    *na_selected_info_peek_dirname_utf8 ( const NASelectedInfo *nsi );
+const gchar    *na_selected_info_peek_mime_type    ( const NASelectedInfo *nsi );
+const gchar    *na_selected_info_peek_owner        ( const NASelectedInfo *nsi );
+const gchar    *na_selected_info_peek_uri          ( const NASelectedInfo *nsi );
+const gchar    *na_selected_info_peek_uri_scheme   ( const NASelectedInfo *nsi );
+
 NASelectedInfo *na_selected_info_create_for_uri( const gchar *uri, const gchar *mimetype, gchar **errmsg );
 
 G_END_DECLS
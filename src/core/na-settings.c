@@ -144,8 +144,12 @@ static const KeyDef st_def_keys[] = {
 	{ NA_IPREFS_WORKING_DIR_URI,                  GROUP_CACT,    NA_DATA_TYPE_STRING,      "file:///" },
 	{ NA_IPREFS_SHOW_IF_RUNNING_WSP,              GROUP_CACT,    NA_DATA_TYPE_UINT_LIST,   "" },
 	{ NA_IPREFS_SHOW_IF_RUNNING_URI,              GROUP_CACT,    NA_DATA_TYPE_STRING,      "file:///bin" },
+	{ NA_IPREFS_SHOW_IF_TRUE_TIMEOUT,             GROUP_RUNTIME, NA_DATA_TYPE_UINT,        "500" },
+	{ NA_IPREFS_SHOW_IF_TRUE_TTL,                 GROUP_RUNTIME, NA_DATA_TYPE_UINT,        "2000" },
 	{ NA_IPREFS_TRY_EXEC_WSP,                     GROUP_CACT,    NA_DATA_TYPE_UINT_LIST,   "" },
 	{ NA_IPREFS_TRY_EXEC_URI,                     GROUP_CACT,    NA_DATA_TYPE_STRING,      "file:///bin" },
+	{ NA_IPREFS_EXECUTION_BATCH_SIZE,             GROUP_RUNTIME, NA_DATA_TYPE_UINT,        "1" },
+	{ NA_IPREFS_EXECUTION_MAX_CONCURRENCY,        GROUP_RUNTIME, NA_DATA_TYPE_UINT,        "0" },
 	{ NA_IPREFS_EXPORT_ASK_USER_WSP,              GROUP_CACT,    NA_DATA_TYPE_UINT_LIST,   "" },
 	{ NA_IPREFS_EXPORT_ASK_USER_LAST_FORMAT,      GROUP_CACT,    NA_DATA_TYPE_STRING,      "Desktop1" },
 	{ NA_IPREFS_EXPORT_ASK_USER_KEEP_LAST_CHOICE, GROUP_CACT,    NA_DATA_TYPE_BOOLEAN,     "false" },
@@ -188,6 +192,7 @@ static const KeyDef st_def_keys[] = {
 	{ NA_IPREFS_TERMINAL_PATTERN,                 GROUP_RUNTIME, NA_DATA_TYPE_STRING,      "" },
 	{ NA_IPREFS_IO_PROVIDER_READABLE,             NA_IPREFS_IO_PROVIDER_GROUP, NA_DATA_TYPE_BOOLEAN, "true" },
 	{ NA_IPREFS_IO_PROVIDER_WRITABLE,             NA_IPREFS_IO_PROVIDER_GROUP, NA_DATA_TYPE_BOOLEAN, "true" },
+	{ NA_IPREFS_IO_PROVIDER_COMPACT_LOAD,         NA_IPREFS_IO_PROVIDER_GROUP, NA_DATA_TYPE_BOOLEAN, "true" },
 	{ 0 }
 };
 
@@ -84,8 +84,12 @@ G_BEGIN_DECLS
 #define NA_IPREFS_WORKING_DIR_URI					"command-working-dir-chooser-lfu"
 #define NA_IPREFS_SHOW_IF_RUNNING_WSP				"environment-show-if-running-wsp"
 #define NA_IPREFS_SHOW_IF_RUNNING_URI				"environment-show-if-running-lfu"
+#define NA_IPREFS_SHOW_IF_TRUE_TIMEOUT				"environment-show-if-true-timeout"
+#define NA_IPREFS_SHOW_IF_TRUE_TTL					"environment-show-if-true-ttl"
 #define NA_IPREFS_TRY_EXEC_WSP						"environment-try-exec-wsp"
 #define NA_IPREFS_TRY_EXEC_URI						"environment-try-exec-lfu"
+#define NA_IPREFS_EXECUTION_BATCH_SIZE				"execution-batch-size"
+#define NA_IPREFS_EXECUTION_MAX_CONCURRENCY			"execution-max-concurrency"
 #define NA_IPREFS_EXPORT_ASK_USER_WSP				"export-ask-user-wsp"
 #define NA_IPREFS_EXPORT_ASK_USER_LAST_FORMAT		"export-ask-user-last-format"
 #define NA_IPREFS_EXPORT_ASK_USER_KEEP_LAST_CHOICE	"export-ask-user-keep-last-choice"
@@ -130,6 +134,7 @@ G_BEGIN_DECLS
 #define NA_IPREFS_IO_PROVIDER_GROUP					"io-provider"
 #define NA_IPREFS_IO_PROVIDER_READABLE				"readable"
 #define NA_IPREFS_IO_PROVIDER_WRITABLE				"writable"
+#define NA_IPREFS_IO_PROVIDER_COMPACT_LOAD			"compact-load"
 
 /* pre-registration of a callback
  */
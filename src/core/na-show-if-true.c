@@ -0,0 +1,345 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "na-settings.h"
+#include "na-show-if-true.h"
+
+/* a command being run
+ * - running: whether we are still waiting for its output
+ */
+typedef struct {
+	const gchar *command;
+	GPid         pid;
+	gint         fd;
+	GString     *output;
+	gboolean     running;
+}
+	ShowIfTrueJob;
+
+/* a cached result
+ * - expires: the monotonic time after which the result is no more valid
+ */
+typedef struct {
+	gboolean     result;
+	gint64       expires;
+}
+	ShowIfTrueResult;
+
+static GHashTable *st_results  = NULL;	/* expanded command -> ShowIfTrueResult */
+static guint       st_runs     = 0;		/* cumulated since the plugin startup */
+static guint       st_timeouts = 0;
+
+static GHashTable *get_results( void );
+static gboolean    get_cached_result( const gchar *command, gboolean *result );
+static gboolean    is_expired( const gchar *command, ShowIfTrueResult *cached, gint64 *now );
+static void        run_commands( GSList *commands );
+static void        job_start( ShowIfTrueJob *job );
+static void        job_read( ShowIfTrueJob *job );
+static void        job_end( ShowIfTrueJob *job, gint64 expires );
+static void        on_child_exited( GPid pid, gint status, gpointer empty );
+
+/*
+ * na_show_if_true_prefetch:
+ * @commands: a #GSList of expanded ShowIfTrue commands.
+ *
+ * Concurrently runs the @commands whose result is not already cached,
+ * and waits for them until the configured deadline.
+ */
+void
+na_show_if_true_prefetch( GSList *commands )
+{
+	GHashTable *seen;
+	GSList *torun, *it;
+	gint64 now;
+	gboolean result;
+
+	now = g_get_monotonic_time();
+	g_hash_table_foreach_remove( get_results(), ( GHRFunc ) is_expired, &now );
+
+	seen = g_hash_table_new( g_str_hash, g_str_equal );
+	torun = NULL;
+
+	for( it = commands ; it ; it = it->next ){
+		const gchar *command = ( const gchar * ) it->data;
+
+		if( command && strlen( command ) &&
+				!g_hash_table_lookup( seen, command ) &&
+				!get_cached_result( command, &result )){
+
+			g_hash_table_insert( seen, ( gpointer ) command, GUINT_TO_POINTER( TRUE ));
+			torun = g_slist_prepend( torun, ( gpointer ) command );
+		}
+	}
+
+	if( torun ){
+		run_commands( torun );
+		g_slist_free( torun );
+	}
+
+	g_hash_table_destroy( seen );
+}
+
+/*
+ * na_show_if_true_evaluate:
+ * @command: an expanded ShowIfTrue command.
+ *
+ * Returns: %TRUE if the @command has output 'true', %FALSE if it has
+ * output anything else, or has not completed before the deadline.
+ */
+gboolean
+na_show_if_true_evaluate( const gchar *command )
+{
+	gboolean result;
+	GSList *torun;
+	ShowIfTrueResult *cached;
+
+	g_return_val_if_fail( command, FALSE );
+
+	if( !get_cached_result( command, &result )){
+		torun = g_slist_prepend( NULL, ( gpointer ) command );
+		run_commands( torun );
+		g_slist_free( torun );
+
+		/* do not check the expiration here, so that a zero TTL still
+		 * lets us get the result we have just computed
+		 */
+		cached = ( ShowIfTrueResult * ) g_hash_table_lookup( get_results(), command );
+		result = cached ? cached->result : FALSE;
+	}
+
+	return( result );
+}
+
+static GHashTable *
+get_results( void )
+{
+	if( !st_results ){
+		st_results = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, g_free );
+	}
+
+	return( st_results );
+}
+
+static gboolean
+get_cached_result( const gchar *command, gboolean *result )
+{
+	ShowIfTrueResult *cached;
+
+	cached = ( ShowIfTrueResult * ) g_hash_table_lookup( get_results(), command );
+
+	if( cached && cached->expires > g_get_monotonic_time()){
+		*result = cached->result;
+		return( TRUE );
+	}
+
+	return( FALSE );
+}
+
+static gboolean
+is_expired( const gchar *command, ShowIfTrueResult *cached, gint64 *now )
+{
+	return( cached->expires <= *now );
+}
+
+/*
+ * start all the commands, and wait for their output until the deadline
+ * without iterating any main loop
+ */
+static void
+run_commands( GSList *commands )
+{
+	static const gchar *thisfn = "na_show_if_true_run_commands";
+	guint timeout, ttl;
+	gint64 deadline, now;
+	ShowIfTrueJob *jobs;
+	GPollFD *fds;
+	guint *indexes;
+	guint count, running, i, n;
+	GSList *it;
+
+	timeout = na_settings_get_uint( NA_IPREFS_SHOW_IF_TRUE_TIMEOUT, NULL, NULL );
+	ttl = na_settings_get_uint( NA_IPREFS_SHOW_IF_TRUE_TTL, NULL, NULL );
+	deadline = g_get_monotonic_time() + ( gint64 ) timeout * 1000;
+
+	count = g_slist_length( commands );
+	jobs = g_new0( ShowIfTrueJob, count );
+	fds = g_new0( GPollFD, count );
+	indexes = g_new0( guint, count );
+	running = 0;
+
+	for( i = 0, it = commands ; it ; ++i, it = it->next ){
+		jobs[i].command = ( const gchar * ) it->data;
+		job_start( &jobs[i] );
+		if( jobs[i].running ){
+			running += 1;
+		}
+	}
+
+	while( running ){
+		now = g_get_monotonic_time();
+		if( now >= deadline ){
+			break;
+		}
+
+		for( i = 0, n = 0 ; i < count ; ++i ){
+			if( jobs[i].running ){
+				fds[n].fd = jobs[i].fd;
+				fds[n].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+				fds[n].revents = 0;
+				indexes[n] = i;
+				n += 1;
+			}
+		}
+
+		if( g_poll( fds, n, ( gint )(( deadline - now + 999 ) / 1000 )) < 0 && errno != EINTR ){
+			g_warning( "%s: poll: %s", thisfn, g_strerror( errno ));
+			break;
+		}
+
+		for( i = 0 ; i < n ; ++i ){
+			if( fds[i].revents ){
+				job_read( &jobs[indexes[i]] );
+				if( !jobs[indexes[i]].running ){
+					running -= 1;
+				}
+			}
+		}
+	}
+
+	now = g_get_monotonic_time();
+
+	for( i = 0 ; i < count ; ++i ){
+		if( jobs[i].running ){
+			st_timeouts += 1;
+			g_warning( "%s: ShowIfTrue=%s has not completed after %u msec, killing it (timeouts=%u)",
+					thisfn, jobs[i].command, timeout, st_timeouts );
+		}
+		job_end( &jobs[i], now + ( gint64 ) ttl * 1000 );
+	}
+
+	st_runs += count;
+	g_debug( "%s: count=%u, cumulated runs=%u, timeouts=%u", thisfn, count, st_runs, st_timeouts );
+
+	g_free( indexes );
+	g_free( fds );
+	g_free( jobs );
+}
+
+static void
+job_start( ShowIfTrueJob *job )
+{
+	static const gchar *thisfn = "na_show_if_true_job_start";
+	gchar **argv;
+	GError *error;
+
+	argv = NULL;
+	error = NULL;
+
+	if( !g_shell_parse_argv( job->command, NULL, &argv, &error ) ||
+		!g_spawn_async_with_pipes( NULL, argv, NULL,
+				G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD, NULL, NULL,
+				&job->pid, NULL, &job->fd, NULL, &error )){
+
+		g_warning( "%s: ShowIfTrue=%s: %s", thisfn, job->command, error->message );
+		g_error_free( error );
+		job->pid = 0;
+
+	} else {
+		job->output = g_string_new( "" );
+		job->running = TRUE;
+	}
+
+	g_strfreev( argv );
+}
+
+static void
+job_read( ShowIfTrueJob *job )
+{
+	gchar buffer[1024];
+	gssize count;
+
+	count = read( job->fd, buffer, sizeof( buffer ));
+
+	if( count > 0 ){
+		job->output = g_string_append_len( job->output, buffer, count );
+
+	} else if( count == 0 || ( errno != EINTR && errno != EAGAIN )){
+		close( job->fd );
+		job->running = FALSE;
+	}
+}
+
+/*
+ * record the result of the command, and let the main loop reap the
+ * child when it will have exited
+ * a command which is still running has timed out, and is killed
+ */
+static void
+job_end( ShowIfTrueJob *job, gint64 expires )
+{
+	ShowIfTrueResult *cached;
+
+	cached = g_new0( ShowIfTrueResult, 1 );
+	cached->expires = expires;
+
+	if( job->running ){
+		kill( job->pid, SIGKILL );
+		close( job->fd );
+		job->running = FALSE;
+
+	} else if( job->output ){
+		cached->result = ( strcmp( job->output->str, "true" ) == 0 );
+	}
+
+	g_hash_table_replace( get_results(), g_strdup( job->command ), cached );
+
+	if( job->output ){
+		g_string_free( job->output, TRUE );
+	}
+
+	if( job->pid ){
+		g_child_watch_add( job->pid, ( GChildWatchFunc ) on_child_exited, NULL );
+	}
+}
+
+static void
+on_child_exited( GPid pid, gint status, gpointer empty )
+{
+	g_spawn_close_pid( pid );
+}
@@ -0,0 +1,63 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __CORE_NA_SHOW_IF_TRUE_H__
+#define __CORE_NA_SHOW_IF_TRUE_H__
+
+/* @title: ShowIfTrue
+ * @short_description: Evaluation of the ShowIfTrue commands
+ * @include: core/na-show-if-true.h
+ *
+ * A ShowIfTrue command is run asynchronously; the caller waits for its
+ * output, but not longer than a configurable deadline. A command which
+ * has not completed when the deadline expires is killed, and evaluates
+ * to %FALSE.
+ *
+ * The results are kept in a short-lived cache, indexed by the expanded
+ * command line, so that several items which share the same command, or
+ * successive popups, do not run it again.
+ *
+ * The commands needed by a popup should be prefetched all together, so
+ * that they are run concurrently, the whole batch being only waited for
+ * one deadline.
+ *
+ * Declare the function only accessed from core library, i.e. not
+ * published as API.
+ */
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void     na_show_if_true_prefetch( GSList *commands );
+gboolean na_show_if_true_evaluate( const gchar *command );
+
+G_END_DECLS
+
+#endif /* __CORE_NA_SHOW_IF_TRUE_H__ */
@@ -35,6 +35,7 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <api/na-core-utils.h>
 #include <api/na-object-api.h>
@@ -51,33 +52,71 @@ struct _NATokensClassPrivate {
 };
 
 /* private instance data
+ * the per-file data are indexed by the rank of the file in the selection;
+ * an array is %NULL when the corresponding field has not been gathered
  */
 struct _NATokensPrivate {
-	gboolean dispose_has_run;
-	guint    count;
-	GSList  *uris;
-	GSList  *filenames;
-	GSList  *basedirs;
-	GSList  *basenames;
-	GSList  *basenames_woext;
-	GSList  *exts;
-	GSList  *mimetypes;
-	gchar   *hostname;
-	gchar   *username;
-	guint    port;
-	gchar   *scheme;
+	gboolean   dispose_has_run;
+	guint      count;
+	GPtrArray *uris;
+	GPtrArray *filenames;
+	GPtrArray *basedirs;
+	GPtrArray *basenames;
+	GPtrArray *basenames_woext;
+	GPtrArray *exts;
+	GPtrArray *mimetypes;
+	gchar     *hostname;
+	gchar     *username;
+	guint      port;
+	gchar     *scheme;
 };
 
+/* a template (a command-line, a label, etc.) is compiled to an array of
+ * pieces, each piece being either a literal part of the template or a
+ * parameter; the literal parts point into the template string itself
+ */
+typedef struct {
+	gchar        parameter;			/* the parameter letter, or zero for a literal */
+	const gchar *literal;
+	gsize        length;
+}
+	TemplatePiece;
+
+/* the commands of one execution of an action
+ * - pending: the PendingCommand's which wait for an execution slot,
+ *   in execution order
+ * - running: the count of running children
+ * - max: the count of execution slots
+ * the structure is released when it has no more pending nor running
+ * command
+ */
+typedef struct {
+	GQueue   pending;
+	guint    running;
+	guint    max;
+}
+	ExecutionBatch;
+
 /*  the structure passed to the callback which waits for the end of the child
  */
 typedef struct {
-	gchar   *command;
-	gboolean is_output_displayed;
-	gint     child_stdout;
-	gint     child_stderr;
+	gchar          *command;
+	gboolean        is_output_displayed;
+	gint            child_stdout;
+	gint            child_stderr;
+	ExecutionBatch *batch;
 }
 	ChildStr;
 
+/* a command which waits for an execution slot
+ */
+typedef struct {
+	gchar           *command;
+	NAObjectProfile *profile;
+	NATokens        *tokens;
+}
+	PendingCommand;
+
 static GObjectClass *st_parent_class = NULL;
 
 static GType     register_type( void );
@@ -89,15 +128,23 @@ static void      instance_finalize( GObject *object );
 static void      child_watch_fn( GPid pid, gint status, ChildStr *child_str );
 static void      display_output( const gchar *command, int fd_stdout, int fd_stderr );
 static gchar    *display_output_get_content( int fd );
-static void      execute_action_command( gchar *command, const NAObjectProfile *profile, const NATokens *tokens );
+static void      schedule_command( ExecutionBatch *batch, gchar *command, const NAObjectProfile *profile, const NATokens *tokens );
+static void      run_pending_commands( ExecutionBatch *batch );
+static guint     get_processors_count( void );
+static gboolean  execute_action_command( ExecutionBatch *batch, gchar *command, const NAObjectProfile *profile, const NATokens *tokens );
 static gchar    *get_command_execution_display_output( const gchar *command );
 static gchar    *get_command_execution_embedded( const gchar *command );
 static gchar    *get_command_execution_normal( const gchar *command );
 static gchar    *get_command_execution_terminal( const gchar *command );
-static gboolean  is_singular_exec( const NATokens *tokens, const gchar *exec );
+static GArray   *compile_template( const gchar *input );
+static gboolean  is_singular_template( GArray *pieces );
+static gboolean  is_plural_template( GArray *pieces );
+static gchar    *expand_template( const NATokens *tokens, GArray *pieces, guint i, guint n, gboolean quoted );
 static gchar    *parse_singular( const NATokens *tokens, const gchar *input, guint i, gboolean utf8, gboolean quoted );
+static GString  *quote_nth( GString *input, GPtrArray *names, guint i, gboolean quoted );
 static GString  *quote_string( GString *input, const gchar *name, gboolean quoted );
-static GString  *quote_string_list( GString *input, GSList *names, gboolean quoted );
+static GString  *quote_string_list( GString *input, GPtrArray *names, guint first, guint n, gboolean quoted );
+static void      free_array( GPtrArray *array );
 
 GType
 na_tokens_get_type( void )
@@ -220,13 +267,13 @@ instance_finalize( GObject *object )
 	g_free( self->private->scheme );
 	g_free( self->private->username );
 	g_free( self->private->hostname );
-	na_core_utils_slist_free( self->private->mimetypes );
-	na_core_utils_slist_free( self->private->exts );
-	na_core_utils_slist_free( self->private->basenames_woext );
-	na_core_utils_slist_free( self->private->basenames );
-	na_core_utils_slist_free( self->private->basedirs );
-	na_core_utils_slist_free( self->private->filenames );
-	na_core_utils_slist_free( self->private->uris );
+	free_array( self->private->mimetypes );
+	free_array( self->private->exts );
+	free_array( self->private->basenames_woext );
+	free_array( self->private->basenames );
+	free_array( self->private->basedirs );
+	free_array( self->private->filenames );
+	free_array( self->private->uris );
 
 	g_free( self->private );
 
@@ -256,28 +303,36 @@ na_tokens_new_for_example( void )
 	const gchar *ex_user = _( "user" );
 	NAMateVFSURI *vfs;
 	gchar *dirname, *bname, *bname_woext, *ext;
-	GSList *is;
+	guint i;
 	gboolean first;
 
 	tokens = g_object_new( NA_TYPE_TOKENS, NULL );
 	first = TRUE;
 	tokens->private->count = 2;
 
-	tokens->private->uris = g_slist_append( tokens->private->uris, g_strdup( ex_uri1 ));
-	tokens->private->uris = g_slist_append( tokens->private->uris, g_strdup( ex_uri2 ));
+	tokens->private->uris = g_ptr_array_new();
+	tokens->private->filenames = g_ptr_array_new();
+	tokens->private->basedirs = g_ptr_array_new();
+	tokens->private->basenames = g_ptr_array_new();
+	tokens->private->basenames_woext = g_ptr_array_new();
+	tokens->private->exts = g_ptr_array_new();
+	tokens->private->mimetypes = g_ptr_array_new();
+
+	g_ptr_array_add( tokens->private->uris, g_strdup( ex_uri1 ));
+	g_ptr_array_add( tokens->private->uris, g_strdup( ex_uri2 ));
 
-	for( is = tokens->private->uris ; is ; is = is->next ){
+	for( i = 0 ; i < tokens->private->uris->len ; ++i ){
 		vfs = g_new0( NAMateVFSURI, 1 );
-		na_mate_vfs_uri_parse( vfs, is->data );
+		na_mate_vfs_uri_parse( vfs, g_ptr_array_index( tokens->private->uris, i ));
 
-		tokens->private->filenames = g_slist_append( tokens->private->filenames, g_strdup( vfs->path ));
+		g_ptr_array_add( tokens->private->filenames, g_strdup( vfs->path ));
 		dirname = g_path_get_dirname( vfs->path );
-		tokens->private->basedirs = g_slist_append( tokens->private->basedirs, dirname );
+		g_ptr_array_add( tokens->private->basedirs, dirname );
 		bname = g_path_get_basename( vfs->path );
-		tokens->private->basenames = g_slist_append( tokens->private->basenames, bname );
+		g_ptr_array_add( tokens->private->basenames, bname );
 		na_core_utils_dir_split_ext( bname, &bname_woext, &ext );
-		tokens->private->basenames_woext = g_slist_append( tokens->private->basenames_woext, bname_woext );
-		tokens->private->exts = g_slist_append( tokens->private->exts, ext );
+		g_ptr_array_add( tokens->private->basenames_woext, bname_woext );
+		g_ptr_array_add( tokens->private->exts, ext );
 
 		if( first ){
 			tokens->private->scheme = g_strdup( vfs->scheme );
@@ -287,8 +342,8 @@ na_tokens_new_for_example( void )
 		na_mate_vfs_uri_free( vfs );
 	}
 
-	tokens->private->mimetypes = g_slist_append( tokens->private->mimetypes, g_strdup( ex_mimetype1 ));
-	tokens->private->mimetypes = g_slist_append( tokens->private->mimetypes, g_strdup( ex_mimetype2 ));
+	g_ptr_array_add( tokens->private->mimetypes, g_strdup( ex_mimetype1 ));
+	g_ptr_array_add( tokens->private->mimetypes, g_strdup( ex_mimetype2 ));
 
 	tokens->private->hostname = g_strdup( ex_host );
 	tokens->private->username = g_strdup( ex_user );
@@ -306,48 +361,163 @@ na_tokens_new_for_example( void )
 NATokens *
 na_tokens_new_from_selection( GList *selection )
 {
-	static const gchar *thisfn = "na_tokens_new_from_selection";
+	return( na_tokens_new_from_selection_with_fields( selection, NA_TOKENS_FIELD_ALL ));
+}
+
+/*
+ * na_tokens_new_from_selection_with_fields:
+ * @selection: a #GList list of #NASelectedInfo objects.
+ * @fields: a mask of NA_TOKENS_FIELD_xxx values.
+ *
+ * Only gathers the data actually needed by the parameters in @fields:
+ * as the #NASelectedInfo objects compute their path and their URI parts
+ * on demand, this avoids to spend time for data which will never be used.
+ *
+ * The parameters which are not covered by @fields are expanded as empty
+ * strings.
+ *
+ * Returns: a new #NATokens object.
+ */
+NATokens *
+na_tokens_new_from_selection_with_fields( GList *selection, guint fields )
+{
+	static const gchar *thisfn = "na_tokens_new_from_selection_with_fields";
 	NATokens *tokens;
 	GList *it;
-	gchar *uri, *filename, *basedir, *basename, *bname_woext, *ext, *mimetype;
+	NASelectedInfo *nsi;
+	gchar *basename, *bname_woext, *ext;
 	gboolean first;
 
-	g_debug( "%s: selection=%p (count=%d)", thisfn, ( void * ) selection, g_list_length( selection ));
+	g_debug( "%s: selection=%p (count=%d), fields=0x%x",
+			thisfn, ( void * ) selection, g_list_length( selection ), fields );
 
 	first = TRUE;
 	tokens = g_object_new( NA_TYPE_TOKENS, NULL );
 
 	tokens->private->count = g_list_length( selection );
 
-	for( it = selection ; it ; it = it->next ){
-		mimetype = na_selected_info_get_mime_type( NA_SELECTED_INFO( it->data ));
+	if( fields & NA_TOKENS_FIELD_URIS ){
+		tokens->private->uris = g_ptr_array_sized_new( tokens->private->count );
+	}
+	if( fields & NA_TOKENS_FIELD_FILENAMES ){
+		tokens->private->filenames = g_ptr_array_sized_new( tokens->private->count );
+	}
+	if( fields & NA_TOKENS_FIELD_BASEDIRS ){
+		tokens->private->basedirs = g_ptr_array_sized_new( tokens->private->count );
+	}
+	if( fields & NA_TOKENS_FIELD_BASENAMES ){
+		tokens->private->basenames = g_ptr_array_sized_new( tokens->private->count );
+		tokens->private->basenames_woext = g_ptr_array_sized_new( tokens->private->count );
+		tokens->private->exts = g_ptr_array_sized_new( tokens->private->count );
+	}
+	if( fields & NA_TOKENS_FIELD_MIMETYPES ){
+		tokens->private->mimetypes = g_ptr_array_sized_new( tokens->private->count );
+	}
 
-		uri = na_selected_info_get_uri( NA_SELECTED_INFO( it->data ));
-		filename = na_selected_info_get_path( NA_SELECTED_INFO( it->data ));
-		basedir = na_selected_info_get_dirname( NA_SELECTED_INFO( it->data ));
-		basename = na_selected_info_get_basename( NA_SELECTED_INFO( it->data ));
-		na_core_utils_dir_split_ext( basename, &bname_woext, &ext );
+	for( it = selection ; it ; it = it->next ){
+		nsi = NA_SELECTED_INFO( it->data );
 
 		if( first ){
-			tokens->private->hostname = na_selected_info_get_uri_host( NA_SELECTED_INFO( it->data ));
-			tokens->private->username = na_selected_info_get_uri_user( NA_SELECTED_INFO( it->data ));
-			tokens->private->port = na_selected_info_get_uri_port( NA_SELECTED_INFO( it->data ));
-			tokens->private->scheme = na_selected_info_get_uri_scheme( NA_SELECTED_INFO( it->data ));
+			if( fields & NA_TOKENS_FIELD_URI_PARTS ){
+				tokens->private->hostname = na_selected_info_get_uri_host( nsi );
+				tokens->private->username = na_selected_info_get_uri_user( nsi );
+				tokens->private->port = na_selected_info_get_uri_port( nsi );
+				tokens->private->scheme = na_selected_info_get_uri_scheme( nsi );
+			}
 			first = FALSE;
 		}
 
-		tokens->private->uris = g_slist_append( tokens->private->uris, uri );
-		tokens->private->filenames = g_slist_append( tokens->private->filenames, filename );
-		tokens->private->basedirs = g_slist_append( tokens->private->basedirs, basedir );
-		tokens->private->basenames = g_slist_append( tokens->private->basenames, basename );
-		tokens->private->basenames_woext = g_slist_append( tokens->private->basenames_woext, bname_woext );
-		tokens->private->exts = g_slist_append( tokens->private->exts, ext );
-		tokens->private->mimetypes = g_slist_append( tokens->private->mimetypes, mimetype );
+		if( fields & NA_TOKENS_FIELD_URIS ){
+			g_ptr_array_add( tokens->private->uris, na_selected_info_get_uri( nsi ));
+		}
+		if( fields & NA_TOKENS_FIELD_FILENAMES ){
+			g_ptr_array_add( tokens->private->filenames, na_selected_info_get_path( nsi ));
+		}
+		if( fields & NA_TOKENS_FIELD_BASEDIRS ){
+			g_ptr_array_add( tokens->private->basedirs, na_selected_info_get_dirname( nsi ));
+		}
+		if( fields & NA_TOKENS_FIELD_BASENAMES ){
+			basename = na_selected_info_get_basename( nsi );
+			na_core_utils_dir_split_ext( basename, &bname_woext, &ext );
+			g_ptr_array_add( tokens->private->basenames, basename );
+			g_ptr_array_add( tokens->private->basenames_woext, bname_woext );
+			g_ptr_array_add( tokens->private->exts, ext );
+		}
+		if( fields & NA_TOKENS_FIELD_MIMETYPES ){
+			g_ptr_array_add( tokens->private->mimetypes, na_selected_info_get_mime_type( nsi ));
+		}
 	}
 
 	return( tokens );
 }
 
+/*
+ * na_tokens_get_fields:
+ * @string: a string which may embed parameters.
+ *
+ * Returns: the mask of NA_TOKENS_FIELD_xxx values which are needed to
+ * expand the parameters found in @string.
+ */
+guint
+na_tokens_get_fields( const gchar *string )
+{
+	guint fields;
+	const gchar *iter;
+
+	fields = 0;
+	iter = string;
+
+	while( iter && ( iter = g_strstr_len( iter, -1, "%" )) != NULL ){
+
+		switch( iter[1] ){
+			case 'u':
+			case 'U':
+				fields |= NA_TOKENS_FIELD_URIS;
+				break;
+
+			case 'f':
+			case 'F':
+				fields |= NA_TOKENS_FIELD_FILENAMES;
+				break;
+
+			case 'd':
+			case 'D':
+				fields |= NA_TOKENS_FIELD_BASEDIRS;
+				break;
+
+			case 'b':
+			case 'B':
+			case 'w':
+			case 'W':
+			case 'x':
+			case 'X':
+				fields |= NA_TOKENS_FIELD_BASENAMES;
+				break;
+
+			case 'm':
+			case 'M':
+				fields |= NA_TOKENS_FIELD_MIMETYPES;
+				break;
+
+			case 'h':
+			case 'n':
+			case 'p':
+			case 's':
+				fields |= NA_TOKENS_FIELD_URI_PARTS;
+				break;
+
+			/* the string ends with a single percent sign
+			 */
+			case '\0':
+				return( fields );
+		}
+
+		iter += 2;			/* skip the % sign and the character after */
+	}
+
+	return( fields );
+}
+
 /*
  * na_tokens_parse_for_display:
  * @tokens: a #NATokens object.
@@ -374,37 +544,156 @@ na_tokens_parse_for_display( const NATokens *tokens, const gchar *string, gboole
  * @profile: the #NAObjectProfile to be executed.
  *
  * Execute the given action, regarding the context described by @tokens.
+ *
+ * When the action has to be run once for each selected item, at most
+ * NA_IPREFS_EXECUTION_MAX_CONCURRENCY of these children are run
+ * concurrently (the count of processors by default), the others being
+ * queued until one of them exits. The limit only applies to the children of this call:
+ * another activation is never queued behind them.
+ *
+ * A singular form command-line which also embeds plural parameters may
+ * be run for batches of NA_IPREFS_EXECUTION_BATCH_SIZE selected items
+ * rather than for each of them; the plural parameters are then expanded
+ * to the items of the batch, and the singular ones to the first item of
+ * the batch.
  */
 void
 na_tokens_execute_action( const NATokens *tokens, const NAObjectProfile *profile )
 {
-	gchar *path, *parameters, *exec;
-	gboolean singular;
-	guint i;
-	gchar *command;
+	gchar *exec;
+	GSList *commands, *it;
+	ExecutionBatch *execution;
+
+	execution = g_new0( ExecutionBatch, 1 );
+	g_queue_init( &execution->pending );
+	execution->max = na_settings_get_uint( NA_IPREFS_EXECUTION_MAX_CONCURRENCY, NULL, NULL );
+	if( !execution->max ){
+		execution->max = get_processors_count();
+	}
+
+	exec = g_strdup_printf( "%s %s", na_object_peek_path( profile ), na_object_peek_parameters( profile ));
+	commands = na_tokens_parse_for_execution( tokens, exec,
+			na_settings_get_uint( NA_IPREFS_EXECUTION_BATCH_SIZE, NULL, NULL ));
+	g_free( exec );
+
+	/* schedule_command() takes ownership of the command strings
+	 */
+	for( it = commands ; it ; it = it->next ){
+		schedule_command( execution, ( gchar * ) it->data, profile, tokens );
+	}
+	g_slist_free( commands );
 
-	path = na_object_get_path( profile );
-	parameters = na_object_get_parameters( profile );
-	exec = g_strdup_printf( "%s %s", path, parameters );
-	g_free( parameters );
-	g_free( path );
+	run_pending_commands( execution );
+}
+
+/*
+ * na_tokens_parse_for_execution:
+ * @tokens: a #NATokens object.
+ * @exec: the command-line to be expanded.
+ * @batch_size: the count of selected items per command when @exec is of
+ *  singular form but also embeds plural parameters; zero or one means
+ *  one command for each selected item.
+ *
+ * Expands the parameters of the given command-line, shell-quoting the
+ * filenames.
+ *
+ * Returns: the list of the command-lines to be executed, in execution
+ * order, as a newly allocated #GSList of newly allocated strings which
+ * should be na_core_utils_slist_free() by the caller.
+ */
+GSList *
+na_tokens_parse_for_execution( const NATokens *tokens, const gchar *exec, guint batch_size )
+{
+	GSList *commands;
+	GArray *pieces;
+	guint i, batch;
 
-	singular = is_singular_exec( tokens, exec );
+	commands = NULL;
 
-	if( singular ){
-		for( i = 0 ; i < tokens->private->count ; ++i ){
-			command = parse_singular( tokens, exec, i, FALSE, TRUE );
-			execute_action_command( command, profile, tokens );
-			g_free( command );
+	/* the command-line is compiled once, and then expanded for each
+	 * selected item if it is of singular form
+	 */
+	pieces = compile_template( exec );
+
+	if( is_singular_template( pieces )){
+		batch = 1;
+		if( is_plural_template( pieces )){
+			batch = MAX( 1, batch_size );
+		}
+		for( i = 0 ; i < tokens->private->count ; i += batch ){
+			commands = g_slist_prepend( commands, expand_template( tokens, pieces, i, batch > 1 ? batch : 0, TRUE ));
 		}
 
 	} else {
-		command = parse_singular( tokens, exec, 0, FALSE, TRUE );
-		execute_action_command( command, profile, tokens );
-		g_free( command );
+		commands = g_slist_prepend( commands, expand_template( tokens, pieces, 0, 0, TRUE ));
 	}
 
-	g_free( exec );
+	g_array_free( pieces, TRUE );
+
+	return( g_slist_reverse( commands ));
+}
+
+/*
+ * g_get_num_processors() is only available since GLib 2.36
+ */
+static guint
+get_processors_count( void )
+{
+#if GLIB_CHECK_VERSION( 2,36, 0 )
+	return( g_get_num_processors());
+#else
+	glong count = sysconf( _SC_NPROCESSORS_ONLN );
+	return( count > 0 ? ( guint ) count : 1 );
+#endif
+}
+
+/*
+ * takes ownership of the @command; the @profile and the @tokens are
+ * reffed, as the menu item they come from may be finalized before the
+ * command be actually run
+ */
+static void
+schedule_command( ExecutionBatch *batch, gchar *command, const NAObjectProfile *profile, const NATokens *tokens )
+{
+	PendingCommand *pending;
+
+	pending = g_new0( PendingCommand, 1 );
+	pending->command = command;
+	pending->profile = g_object_ref(( gpointer ) profile );
+	pending->tokens = g_object_ref(( gpointer ) tokens );
+
+	g_queue_push_tail( &batch->pending, pending );
+}
+
+/*
+ * start as many pending commands as the batch has free execution slots
+ * the batch is released as soon as it has no more command
+ */
+static void
+run_pending_commands( ExecutionBatch *batch )
+{
+	static const gchar *thisfn = "na_tokens_run_pending_commands";
+	PendingCommand *pending;
+
+	while( batch->running < batch->max &&
+			( pending = ( PendingCommand * ) g_queue_pop_head( &batch->pending ))){
+
+		if( execute_action_command( batch, pending->command, pending->profile, pending->tokens )){
+			batch->running += 1;
+		}
+
+		g_free( pending->command );
+		g_object_unref( pending->profile );
+		g_object_unref( pending->tokens );
+		g_free( pending );
+	}
+
+	g_debug( "%s: batch=%p, running=%u, pending=%u, max=%u",
+			thisfn, ( void * ) batch, batch->running, g_queue_get_length( &batch->pending ), batch->max );
+
+	if( !batch->running && g_queue_is_empty( &batch->pending )){
+		g_free( batch );
+	}
 }
 
 static void
@@ -414,6 +703,13 @@ child_watch_fn( GPid pid, gint status, ChildStr *child_str )
 
 	g_debug( "%s: pid=%u, status=%d", thisfn, ( guint ) pid, status );
 	g_spawn_close_pid( pid );
+
+	/* release the execution slot before displaying the output, as this
+	 * latter waits for the user
+	 */
+	child_str->batch->running -= 1;
+	run_pending_commands( child_str->batch );
+
 	if( child_str->is_output_displayed ){
 		display_output( child_str->command, child_str->child_stdout, child_str->child_stderr );
 	}
@@ -487,16 +783,19 @@ display_output_get_content( int fd )
  * - Terminal: use the user preference to have a terminal which stays openeded
  * - Embedded: id. Terminal
  * - DisplayOutput: execute in a shell
+ *
+ * Returns: %TRUE if a child has been spawned, and is watched.
  */
-static void
-execute_action_command( gchar *command, const NAObjectProfile *profile, const NATokens *tokens )
+static gboolean
+execute_action_command( ExecutionBatch *batch, gchar *command, const NAObjectProfile *profile, const NATokens *tokens )
 {
 	static const gchar *thisfn = "caja_actions_execute_action_command";
 	GError *error;
-	gchar *execution_mode, *run_command;
+	const gchar *execution_mode;
+	gchar *run_command;
 	gchar **argv;
 	gint argc;
-	gchar *wdir, *wdir_nq;
+	gchar *wdir_nq;
 	GPid child_pid;
 	ChildStr *child_str;
 
@@ -505,8 +804,9 @@ execute_action_command( gchar *command, const NAObjectProfile *profile, const NA
 	error = NULL;
 	run_command = NULL;
 	child_str = g_new0( ChildStr, 1 );
+	child_str->batch = batch;
 	child_pid = ( GPid ) 0;
-	execution_mode = na_object_get_execution_mode( profile );
+	execution_mode = na_object_peek_execution_mode( profile );
 
 	if( !strcmp( execution_mode, "Normal" )){
 		run_command = get_command_execution_normal( command );
@@ -533,8 +833,7 @@ execute_action_command( gchar *command, const NAObjectProfile *profile, const NA
 			g_error_free( error );
 
 		} else {
-			wdir = na_object_get_working_dir( profile );
-			wdir_nq = parse_singular( tokens, wdir, 0, FALSE, FALSE );
+			wdir_nq = parse_singular( tokens, na_object_peek_working_dir( profile ), 0, FALSE, FALSE );
 			g_debug( "%s: run_command=%s, wdir=%s", thisfn, run_command, wdir_nq );
 
 			/* it appears that at least mplayer does not support g_spawn_async_with_pipes
@@ -579,7 +878,6 @@ execute_action_command( gchar *command, const NAObjectProfile *profile, const NA
 				g_child_watch_add( child_pid, ( GChildWatchFunc ) child_watch_fn, child_str );
 			}
 
-			g_free( wdir );
 			g_free( wdir_nq );
 			g_strfreev( argv );
 		}
@@ -587,12 +885,12 @@ execute_action_command( gchar *command, const NAObjectProfile *profile, const NA
 		g_free( run_command );
 	}
 
-	g_free( execution_mode );
-
 	if( child_pid == ( GPid ) 0 ){
 		g_free( child_str->command );
 		g_free( child_str );
 	}
+
+	return( child_pid != ( GPid ) 0 );
 }
 
 static gchar *
@@ -654,27 +952,73 @@ na_tokens_command_for_terminal( const gchar *pattern, const gchar *command )
 }
 
 /*
- * na_tokens_is_singular_exec:
- * @tokens: the current #NATokens object.
- * @exec: the to be executed command-line before having been parsed
+ * compile_template:
+ * @input: the template string, may or may not contain tokens.
+ *
+ * Returns: the #GArray of TemplatePiece which make the @input, which
+ * should be g_array_free() by the caller. The literal pieces point into
+ * @input, which must so stay alive while the template is in use.
  *
- * Returns: %TRUE if the first relevant parameter found in @exec
- * command-line is of singular form, %FALSE else.
+ * A percent sign which terminates the @input is ignored, as well as
+ * an unknown parameter.
  */
-static gboolean
-is_singular_exec( const NATokens *tokens, const gchar *exec )
+static GArray *
+compile_template( const gchar *input )
 {
-	gboolean singular;
-	gboolean found;
-	gchar *iter;
+	GArray *pieces;
+	TemplatePiece piece;
+	const gchar *iter, *prev_iter;
 
-	singular = FALSE;
-	found = FALSE;
-	iter = ( gchar * ) exec;
+	pieces = g_array_new( FALSE, FALSE, sizeof( TemplatePiece ));
+	prev_iter = input;
 
-	while(( iter = g_strstr_len( iter, -1, "%" )) != NULL && !found ){
+	while(( iter = strchr( prev_iter, '%' ))){
 
-		switch( iter[1] ){
+		if( iter > prev_iter ){
+			piece.parameter = '\0';
+			piece.literal = prev_iter;
+			piece.length = iter - prev_iter;
+			g_array_append_val( pieces, piece );
+		}
+
+		if( !iter[1] ){
+			prev_iter = iter+1;
+			break;
+		}
+
+		piece.parameter = iter[1];
+		piece.literal = NULL;
+		piece.length = 0;
+		g_array_append_val( pieces, piece );
+
+		prev_iter = iter+2;			/* skip the % sign and the character after */
+	}
+
+	if( *prev_iter ){
+		piece.parameter = '\0';
+		piece.literal = prev_iter;
+		piece.length = strlen( prev_iter );
+		g_array_append_val( pieces, piece );
+	}
+
+	return( pieces );
+}
+
+/*
+ * is_singular_template:
+ * @pieces: a compiled command-line.
+ *
+ * Returns: %TRUE if the first relevant parameter found in the command-line
+ * is of singular form, %FALSE else.
+ */
+static gboolean
+is_singular_template( GArray *pieces )
+{
+	guint i;
+
+	for( i = 0 ; i < pieces->len ; ++i ){
+
+		switch( g_array_index( pieces, TemplatePiece, i ).parameter ){
 			case 'b':
 			case 'd':
 			case 'f':
@@ -683,9 +1027,7 @@ is_singular_exec( const NATokens *tokens, const gchar *exec )
 			case 'u':
 			case 'w':
 			case 'x':
-				found = TRUE;
-				singular = TRUE;
-				break;
+				return( TRUE );
 
 			case 'B':
 			case 'D':
@@ -695,9 +1037,7 @@ is_singular_exec( const NATokens *tokens, const gchar *exec )
 			case 'U':
 			case 'W':
 			case 'X':
-				found = TRUE;
-				singular = FALSE;
-				break;
+				return( FALSE );
 
 			/* all other parameters are irrelevant according to DES-EMA
 			 * c: selection count
@@ -708,111 +1048,95 @@ is_singular_exec( const NATokens *tokens, const gchar *exec )
 			 * %: %
 			 */
 		}
+	}
 
-		iter += 2;			/* skip the % sign and the character after */
+	return( FALSE );
+}
+
+/*
+ * is_plural_template:
+ * @pieces: a compiled command-line.
+ *
+ * Returns: %TRUE if the command-line embeds at least one plural parameter.
+ */
+static gboolean
+is_plural_template( GArray *pieces )
+{
+	guint i;
+
+	for( i = 0 ; i < pieces->len ; ++i ){
+		if( strchr( "BDFMUWX", g_array_index( pieces, TemplatePiece, i ).parameter )){
+			return( TRUE );
+		}
 	}
 
-	return( singular );
+	return( FALSE );
 }
 
 /*
- * parse_singular:
+ * expand_template:
  * @tokens: a #NATokens object.
- * @input: the input string, may or may not contain tokens.
+ * @pieces: a compiled template.
  * @i: the number of the iteration in a multiple selection, starting with zero.
- * @utf8: whether the @input string is UTF-8 encoded, or a standard ASCII
- *  string.
+ * @n: if not zero, the count of items of the batch which starts with @i;
+ *  the plural parameters are then restricted to this batch.
  * @quoted: whether the filenames have to be quoted (should be %TRUE when
  *  about to execute a command).
  *
  * A command is said of 'singular form' when its first parameter is not
  * of plural form. In the case of a multiple selection, singular form
  * commands are executed one time for each element of the selection
+ * (or for each batch of elements)
  *
- * Returns: a #GSList which contains two fields: the command and its parameters.
- * The returned #GSList should be na_core_utils_slist_free() by the caller.
+ * Returns: the expanded string, as a newly allocated string which should
+ * be g_free() by the caller.
  */
 static gchar *
-parse_singular( const NATokens *tokens, const gchar *input, guint i, gboolean utf8, gboolean quoted )
+expand_template( const NATokens *tokens, GArray *pieces, guint i, guint n, gboolean quoted )
 {
 	GString *output;
-	gchar *iter, *prev_iter;
-	const gchar *nth;
+	TemplatePiece *piece;
+	guint ip, first, count;
 
 	output = g_string_new( "" );
 
-	/* return NULL if input is NULL
-	 */
-	if( !input ){
-		return( g_string_free( output, TRUE ));
-	}
-
-	/* return an empty string if input is empty
-	 */
-	if( utf8 ){
-		if( !g_utf8_strlen( input, -1 )){
-			return( g_string_free( output, FALSE ));
-		}
-	} else {
-		if( !strlen( input )){
-			return( g_string_free( output, FALSE ));
-		}
-	}
+	first = n ? i : 0;
+	count = n ? MIN( n, tokens->private->count - i ) : tokens->private->count;
 
-	iter = ( gchar * ) input;
-	prev_iter = iter;
+	for( ip = 0 ; ip < pieces->len ; ++ip ){
+		piece = &g_array_index( pieces, TemplatePiece, ip );
 
-	while(( iter = g_strstr_len( iter, -1, "%" ))){
-		output = g_string_append_len( output, prev_iter, strlen( prev_iter ) - strlen( iter ));
+		switch( piece->parameter ){
+			case '\0':
+				output = g_string_append_len( output, piece->literal, piece->length );
+				break;
 
-		switch( iter[1] ){
 			case 'b':
-				if( tokens->private->basenames ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->basenames, i );
-					if( nth ){
-						output = quote_string( output, nth, quoted );
-					}
-				}
+				output = quote_nth( output, tokens->private->basenames, i, quoted );
 				break;
 
 			case 'B':
-				if( tokens->private->basenames ){
-					output = quote_string_list( output, tokens->private->basenames, quoted );
-				}
+				output = quote_string_list( output, tokens->private->basenames, first, count, quoted );
 				break;
 
 			case 'c':
-				g_string_append_printf( output, "%d", tokens->private->count );
+				g_string_append_printf( output, "%d", count );
 				break;
 
 			case 'd':
-				if( tokens->private->basedirs ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->basedirs, i );
-					if( nth ){
-						output = quote_string( output, nth, quoted );
-					}
-				}
+				output = quote_nth( output, tokens->private->basedirs, i, quoted );
 				break;
 
 			case 'D':
-				if( tokens->private->basedirs ){
-					output = quote_string_list( output, tokens->private->basedirs, quoted );
-				}
+				output = quote_string_list( output, tokens->private->basedirs, first, count, quoted );
 				break;
 
 			case 'f':
-				if( tokens->private->filenames ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->filenames, i );
-					if( nth ){
-						output = quote_string( output, nth, quoted );
-					}
-				}
+				output = quote_nth( output, tokens->private->filenames, i, quoted );
 				break;
 
 			case 'F':
-				if( tokens->private->filenames ){
-					output = quote_string_list( output, tokens->private->filenames, quoted );
-				}
+				output = quote_string_list( output, tokens->private->filenames, first, count, quoted );
 				break;
 
 			case 'h':
@@ -824,18 +1148,11 @@ parse_singular( const NATokens *tokens, const gchar *input, guint i, gboolean ut
 			/* mimetypes are never quoted
 			 */
 			case 'm':
-				if( tokens->private->mimetypes ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->mimetypes, i );
-					if( nth ){
-						output = quote_string( output, nth, FALSE );
-					}
-				}
+				output = quote_nth( output, tokens->private->mimetypes, i, FALSE );
 				break;
 
 			case 'M':
-				if( tokens->private->mimetypes ){
-					output = quote_string_list( output, tokens->private->mimetypes, FALSE );
-				}
+				output = quote_string_list( output, tokens->private->mimetypes, first, count, FALSE );
 				break;
 
 			/* no-op operators */
@@ -864,48 +1181,27 @@ parse_singular( const NATokens *tokens, const gchar *input, guint i, gboolean ut
 				break;
 
 			case 'u':
-				if( tokens->private->uris ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->uris, i );
-					if( nth ){
-						output = quote_string( output, nth, quoted );
-					}
-				}
+				output = quote_nth( output, tokens->private->uris, i, quoted );
 				break;
 
 			case 'U':
-				if( tokens->private->uris ){
-					output = quote_string_list( output, tokens->private->uris, quoted );
-				}
+				output = quote_string_list( output, tokens->private->uris, first, count, quoted );
 				break;
 
 			case 'w':
-				if( tokens->private->basenames_woext ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->basenames_woext, i );
-					if( nth ){
-						output = quote_string( output, nth, quoted );
-					}
-				}
+				output = quote_nth( output, tokens->private->basenames_woext, i, quoted );
 				break;
 
 			case 'W':
-				if( tokens->private->basenames_woext ){
-					output = quote_string_list( output, tokens->private->basenames_woext, quoted );
-				}
+				output = quote_string_list( output, tokens->private->basenames_woext, first, count, quoted );
 				break;
 
 			case 'x':
-				if( tokens->private->exts ){
-					nth = ( const gchar * ) g_slist_nth_data( tokens->private->exts, i );
-					if( nth ){
-						output = quote_string( output, nth, quoted );
-					}
-				}
+				output = quote_nth( output, tokens->private->exts, i, quoted );
 				break;
 
 			case 'X':
-				if( tokens->private->exts ){
-					output = quote_string_list( output, tokens->private->exts, quoted );
-				}
+				output = quote_string_list( output, tokens->private->exts, first, count, quoted );
 				break;
 
 			/* a percent sign
@@ -914,14 +1210,61 @@ parse_singular( const NATokens *tokens, const gchar *input, guint i, gboolean ut
 				output = g_string_append_c( output, '%' );
 				break;
 		}
+	}
 
-		iter += 2;			/* skip the % sign and the character after */
-		prev_iter = iter;	/* store the new start of the string */
+	return( g_string_free( output, FALSE ));
+}
+
+/*
+ * parse_singular:
+ * @tokens: a #NATokens object.
+ * @input: the input string, may or may not contain tokens.
+ * @i: the number of the iteration in a multiple selection, starting with zero.
+ * @utf8: whether the @input string is UTF-8 encoded, or a standard ASCII
+ *  string.
+ * @quoted: whether the filenames have to be quoted (should be %TRUE when
+ *  about to execute a command).
+ *
+ * Returns: the expanded string, as a newly allocated string which should
+ * be g_free() by the caller, or %NULL if @input is %NULL.
+ */
+static gchar *
+parse_singular( const NATokens *tokens, const gchar *input, guint i, gboolean utf8, gboolean quoted )
+{
+	GArray *pieces;
+	gchar *output;
+
+	/* return NULL if input is NULL
+	 */
+	if( !input ){
+		return( NULL );
 	}
 
-	output = g_string_append_len( output, prev_iter, strlen( prev_iter ));
+	/* return an empty string if input is empty
+	 * (an UTF-8 string is empty if and only if its first byte is zero)
+	 */
+	if( !input[0] ){
+		return( g_strdup( "" ));
+	}
 
-	return( g_string_free( output, FALSE ));
+	pieces = compile_template( input );
+	output = expand_template( tokens, pieces, i, 0, quoted );
+	g_array_free( pieces, TRUE );
+
+	return( output );
+}
+
+/*
+ * the i-th element of the @names array, if it exists
+ */
+static GString *
+quote_nth( GString *input, GPtrArray *names, guint i, gboolean quoted )
+{
+	if( names && i < names->len ){
+		input = quote_string( input, ( const gchar * ) g_ptr_array_index( names, i ), quoted );
+	}
+
+	return( input );
 }
 
 static GString *
@@ -941,26 +1284,32 @@ quote_string( GString *input, const gchar *name, gboolean quoted )
 	return( input );
 }
 
+/*
+ * the @n elements of the @names array which start with @first,
+ * space-separated, in the order of the selection
+ */
 static GString *
-quote_string_list( GString *input, GSList *names, gboolean quoted )
+quote_string_list( GString *input, GPtrArray *names, guint first, guint n, gboolean quoted )
 {
-	GSList *it;
-	gchar *tmp;
+	guint i;
 
-	if( quoted ){
-		GSList *quoted_names = NULL;
-		for( it = names ; it ; it = it->next ){
-			quoted_names = g_slist_append( quoted_names, g_shell_quote(( const gchar * ) it->data ));
+	if( names ){
+		for( i = first ; i < names->len && i < first+n ; ++i ){
+			if( i > first ){
+				input = g_string_append_c( input, ' ' );
+			}
+			input = quote_string( input, ( const gchar * ) g_ptr_array_index( names, i ), quoted );
 		}
-		tmp = na_core_utils_slist_join_at_end( quoted_names, " " );
-		na_core_utils_slist_free( quoted_names );
-
-	} else {
-		tmp = na_core_utils_slist_join_at_end( g_slist_reverse( names ), " " );
 	}
 
-	input = g_string_append( input, tmp );
-	g_free( tmp );
-
 	return( input );
 }
+
+static void
+free_array( GPtrArray *array )
+{
+	if( array ){
+		g_ptr_array_foreach( array, ( GFunc ) g_free, NULL );
+		g_ptr_array_free( array, TRUE );
+	}
+}
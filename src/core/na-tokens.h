@@ -108,12 +108,29 @@ typedef struct {
 }
 	NATokensClass;
 
+/* the per-file data which may have to be gathered from the selection,
+ * depending of the parameters actually used by the loaded items
+ */
+enum {
+	NA_TOKENS_FIELD_URIS      = 1 << 0,		/* %u %U */
+	NA_TOKENS_FIELD_FILENAMES = 1 << 1,		/* %f %F */
+	NA_TOKENS_FIELD_BASEDIRS  = 1 << 2,		/* %d %D */
+	NA_TOKENS_FIELD_BASENAMES = 1 << 3,		/* %b %B %w %W %x %X */
+	NA_TOKENS_FIELD_MIMETYPES = 1 << 4,		/* %m %M */
+	NA_TOKENS_FIELD_URI_PARTS = 1 << 5,		/* %h %n %p %s */
+	NA_TOKENS_FIELD_ALL       = ( 1 << 6 ) - 1
+};
+
 GType     na_tokens_get_type            ( void );
 
 NATokens *na_tokens_new_for_example     ( void );
 NATokens *na_tokens_new_from_selection  ( GList *selection );
+NATokens *na_tokens_new_from_selection_with_fields( GList *selection, guint fields );
+
+guint     na_tokens_get_fields          ( const gchar *string );
 
 gchar    *na_tokens_parse_for_display   ( const NATokens *tokens, const gchar *string, gboolean utf8 );
+GSList   *na_tokens_parse_for_execution ( const NATokens *tokens, const gchar *exec, guint batch_size );
 void      na_tokens_execute_action      ( const NATokens *tokens, const NAObjectProfile *profile );
 
 gchar    *na_tokens_command_for_terminal( const gchar *pattern, const gchar *command );
@@ -0,0 +1,285 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <gio/gio.h>
+#include <string.h>
+
+#include <api/na-object-api.h>
+
+#include "na-try-exec.h"
+
+/* a cached result is kept at most this delay, whether its directory
+ * is monitored or not (sec)
+ */
+#define TRY_EXEC_TTL					60
+
+/* the executability of a resolved path
+ */
+typedef struct {
+	gboolean executable;
+	gint64   expires;
+}
+	TryExecResult;
+
+static GHashTable *st_resolved = NULL;	/* TryExec value -> resolved path, or empty string */
+static gchar      *st_path_env = NULL;	/* PATH at resolution time */
+static GHashTable *st_results  = NULL;	/* resolved path -> TryExecResult */
+static GHashTable *st_monitors = NULL;	/* directory -> GFileMonitor */
+
+static void         init_caches( void );
+static const gchar *resolve( const gchar *tryexec );
+static gboolean     query_executable( const gchar *path );
+static void         monitor_directory( const gchar *path );
+static void         free_monitor( GFileMonitor *monitor );
+static void         on_directory_changed( GFileMonitor *monitor, GFile *file, GFile *other, GFileMonitorEvent event, gpointer empty );
+static void         prewarm_context( const NAIContext *context );
+
+/*
+ * na_try_exec_is_executable:
+ * @tryexec: the TryExec value of a #NAIContext.
+ *
+ * Returns: %TRUE if @tryexec resolves to an executable file.
+ */
+gboolean
+na_try_exec_is_executable( const gchar *tryexec )
+{
+	const gchar *path;
+	TryExecResult *cached;
+	gint64 now;
+
+	g_return_val_if_fail( tryexec, FALSE );
+
+	init_caches();
+
+	path = resolve( tryexec );
+	if( !strlen( path )){
+		return( FALSE );
+	}
+
+	now = g_get_monotonic_time();
+	cached = ( TryExecResult * ) g_hash_table_lookup( st_results, path );
+
+	if( !cached || cached->expires <= now ){
+		cached = g_new0( TryExecResult, 1 );
+		cached->executable = query_executable( path );
+		cached->expires = now + ( gint64 ) TRY_EXEC_TTL * G_USEC_PER_SEC;
+		g_hash_table_replace( st_results, g_strdup( path ), cached );
+		monitor_directory( path );
+	}
+
+	return( cached->executable );
+}
+
+/*
+ * na_try_exec_prewarm:
+ * @tree: the list of the loaded #NAObjectItem items.
+ *
+ * Evaluates the TryExec conditions of all the items and profiles of the
+ * @tree, so that the first menu does not have to stat them.
+ */
+void
+na_try_exec_prewarm( GList *tree )
+{
+	GList *it;
+
+	for( it = tree ; it ; it = it->next ){
+		prewarm_context( NA_ICONTEXT( it->data ));
+
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			na_try_exec_prewarm( na_object_get_items( it->data ));
+		}
+	}
+}
+
+/*
+ * resolutions depend on PATH: drop them all when it changes
+ */
+static void
+init_caches( void )
+{
+	const gchar *path_env;
+
+	if( !st_results ){
+		st_results = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, g_free );
+		st_monitors = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) free_monitor );
+	}
+
+	path_env = g_getenv( "PATH" );
+
+	if( !st_resolved || g_strcmp0( path_env, st_path_env )){
+		if( st_resolved ){
+			g_hash_table_destroy( st_resolved );
+		}
+		st_resolved = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, g_free );
+		g_free( st_path_env );
+		st_path_env = g_strdup( path_env );
+	}
+}
+
+/*
+ * Returns: the resolved path, or an empty string if the TryExec value
+ * is not an absolute path and is not found in PATH
+ */
+static const gchar *
+resolve( const gchar *tryexec )
+{
+	gchar *path;
+
+	path = ( gchar * ) g_hash_table_lookup( st_resolved, tryexec );
+
+	if( !path ){
+		if( g_path_is_absolute( tryexec )){
+			path = g_strdup( tryexec );
+
+		} else {
+			path = g_find_program_in_path( tryexec );
+			if( !path ){
+				path = g_strdup( "" );
+			}
+		}
+		g_hash_table_insert( st_resolved, g_strdup( tryexec ), path );
+	}
+
+	return( path );
+}
+
+static gboolean
+query_executable( const gchar *path )
+{
+	static const gchar *thisfn = "na_try_exec_query_executable";
+	gboolean executable;
+	GFile *file;
+	GFileInfo *info;
+	GError *error;
+
+	executable = FALSE;
+	error = NULL;
+	file = g_file_new_for_path( path );
+	info = g_file_query_info( file, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE, G_FILE_QUERY_INFO_NONE, NULL, &error );
+
+	if( error ){
+		g_debug( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+
+	} else {
+		executable = g_file_info_get_attribute_boolean( info, G_FILE_ATTRIBUTE_ACCESS_CAN_EXECUTE );
+	}
+
+	if( info ){
+		g_object_unref( info );
+	}
+
+	g_object_unref( file );
+
+	return( executable );
+}
+
+/*
+ * a directory which cannot be monitored is only recorded, so that we
+ * do not try again - its results will just expire
+ */
+static void
+monitor_directory( const gchar *path )
+{
+	static const gchar *thisfn = "na_try_exec_monitor_directory";
+	gchar *dirname;
+	GFile *dir;
+	GFileMonitor *monitor;
+	GError *error;
+
+	dirname = g_path_get_dirname( path );
+
+	if( !g_hash_table_contains( st_monitors, dirname )){
+		error = NULL;
+		dir = g_file_new_for_path( dirname );
+		monitor = g_file_monitor_directory( dir, G_FILE_MONITOR_NONE, NULL, &error );
+		g_object_unref( dir );
+
+		if( error ){
+			g_debug( "%s: %s: %s", thisfn, dirname, error->message );
+			g_error_free( error );
+			monitor = NULL;
+
+		} else {
+			g_signal_connect( monitor, "changed", G_CALLBACK( on_directory_changed ), NULL );
+		}
+
+		g_hash_table_insert( st_monitors, dirname, monitor );
+
+	} else {
+		g_free( dirname );
+	}
+}
+
+static void
+free_monitor( GFileMonitor *monitor )
+{
+	if( monitor ){
+		g_object_unref( monitor );
+	}
+}
+
+/*
+ * a file has been created, deleted or modified: drop its cached result
+ * a new program may also hide another one which was found later in PATH
+ */
+static void
+on_directory_changed( GFileMonitor *monitor, GFile *file, GFile *other, GFileMonitorEvent event, gpointer empty )
+{
+	static const gchar *thisfn = "na_try_exec_on_directory_changed";
+	gchar *path;
+
+	path = g_file_get_path( file );
+	g_debug( "%s: path=%s, event=%d", thisfn, path, event );
+
+	if( path ){
+		g_hash_table_remove( st_results, path );
+		g_free( path );
+	}
+
+	g_hash_table_remove_all( st_resolved );
+}
+
+static void
+prewarm_context( const NAIContext *context )
+{
+	gchar *tryexec;
+
+	tryexec = na_object_get_try_exec( context );
+
+	if( tryexec && strlen( tryexec )){
+		na_try_exec_is_executable( tryexec );
+	}
+
+	g_free( tryexec );
+}
@@ -0,0 +1,59 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __CORE_NA_TRY_EXEC_H__
+#define __CORE_NA_TRY_EXEC_H__
+
+/* @title: TryExec
+ * @short_description: Cached evaluation of the TryExec conditions
+ * @include: core/na-try-exec.h
+ *
+ * A TryExec value is resolved against the PATH environment variable
+ * when it is not an absolute path. The executability of the resolved
+ * path is then cached.
+ *
+ * A cached result is dropped when the containing directory is signaled
+ * as modified by its GFileMonitor, or when it becomes too old (e.g. when
+ * the directory cannot be monitored). All resolutions are dropped when
+ * PATH changes.
+ *
+ * Declare the function only accessed from core library, i.e. not
+ * published as API.
+ */
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gboolean na_try_exec_is_executable( const gchar *tryexec );
+void     na_try_exec_prewarm      ( GList *tree );
+
+G_END_DECLS
+
+#endif /* __CORE_NA_TRY_EXEC_H__ */
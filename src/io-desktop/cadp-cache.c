@@ -0,0 +1,810 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gstdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <api/na-core-utils.h>
+#include <api/na-data-types.h>
+#include <api/na-ifactory-object-data.h>
+#include <api/na-object-api.h>
+
+#include "cadp-cache.h"
+#include "cadp-keys.h"
+
+/* the cache file starts with a magic string, followed by the version
+ * of its layout and a marker of the byte order of the machine which
+ * has written it; a cache which does not match is just ignored
+ */
+#define CACHE_MAGIC						"CADPCACH"
+#define CACHE_MAGIC_LENGTH				8
+#define CACHE_VERSION					1
+#define CACHE_BYTE_ORDER				0x01020304
+
+/* the nature of a serialized object
+ */
+enum {
+	CACHE_OBJECT_ACTION = 1,
+	CACHE_OBJECT_MENU,
+	CACHE_OBJECT_PROFILE
+};
+
+/* a cursor on the content of the cache file
+ */
+typedef struct {
+	const gchar *data;
+	gsize        length;
+	gsize        offset;
+	gboolean     error;
+}
+	CacheReader;
+
+/* the recorded data of an object:
+ * - nature: one of the CACHE_OBJECT_xxx values
+ * - data: the recorded values, indexed by name
+ * - profiles: for an action, the records of its profiles
+ */
+struct _CappCacheRecord {
+	guint       nature;
+	GHashTable *data;
+	GList      *profiles;
+};
+
+/* a recorded value, as expected by na_boxed_set_from_void()
+ */
+typedef struct {
+	guint       type;
+	void       *value;
+}
+	CacheValue;
+
+static gchar           *get_cache_path( void );
+static gchar           *get_locale( void );
+
+static gboolean         read_header( CacheReader *reader );
+static gboolean         read_dirs( CacheReader *reader, GSList *dirs, GArray *mtimes );
+static GSList          *read_files( CacheReader *reader, GHashTable *cache );
+static CappCacheRecord *read_record( CacheReader *reader );
+static void             read_data( CacheReader *reader, CappCacheRecord *record );
+static guint32          read_uint( CacheReader *reader );
+static gint64           read_int64( CacheReader *reader );
+static gchar           *read_string( CacheReader *reader );
+static gboolean         read_bytes( CacheReader *reader, void *dest, gsize length );
+static void             free_value( CacheValue *value );
+
+static void          write_object( GByteArray *buffer, const NAObjectId *object );
+static void          write_data( GByteArray *buffer, const NADataBoxed *boxed );
+static void          write_uint( GByteArray *buffer, guint32 value );
+static void          write_int64( GByteArray *buffer, gint64 value );
+static void          write_string( GByteArray *buffer, const gchar *value );
+
+/*
+ * cadp_cache_get_dirs_mtime:
+ * @dirs: the list of the searched directories.
+ *
+ * Returns: a new #GArray of the modification times of the @dirs, zero
+ * standing for a directory which does not exist, to be g_array_free()
+ * by the caller.
+ *
+ * This should be called before the directories are scanned, so that
+ * a file which would be created during the scan makes the directory
+ * be scanned again on next run.
+ */
+GArray *
+cadp_cache_get_dirs_mtime( GSList *dirs )
+{
+	GArray *mtimes;
+	GSList *it;
+	GStatBuf st;
+	gint64 mtime;
+
+	mtimes = g_array_sized_new( FALSE, FALSE, sizeof( gint64 ), g_slist_length( dirs ));
+
+	for( it = dirs ; it ; it = it->next ){
+		mtime = 0;
+		if( g_stat(( const gchar * ) it->data, &st ) == 0 ){
+			mtime = ( gint64 ) st.st_mtime;
+		}
+		g_array_append_val( mtimes, mtime );
+	}
+
+	return( mtimes );
+}
+
+/*
+ * cadp_cache_read:
+ * @dirs: the list of the searched directories.
+ * @mtimes: the current modification times of the @dirs.
+ * @cache: the hash table of #CappCachedItem, indexed by path, to be filled.
+ *
+ * Fills @cache with the records of the items found in the cache file.
+ *
+ * Returns: the recorded list of .desktop paths if none of the @dirs has
+ * changed since the cache has been written, or %NULL. The returned list
+ * should be na_core_utils_slist_free() by the caller.
+ */
+GSList *
+cadp_cache_read( GSList *dirs, GArray *mtimes, GHashTable *cache )
+{
+	static const gchar *thisfn = "cadp_cache_read";
+	gchar *path, *contents;
+	gsize length;
+	GError *error;
+	CacheReader reader;
+	gboolean dirs_valid;
+	GSList *paths;
+
+	paths = NULL;
+	error = NULL;
+	path = get_cache_path();
+
+	if( !g_file_get_contents( path, &contents, &length, &error )){
+		g_debug( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+
+	} else {
+		reader.data = contents;
+		reader.length = length;
+		reader.offset = 0;
+		reader.error = FALSE;
+
+		if( read_header( &reader )){
+			dirs_valid = read_dirs( &reader, dirs, mtimes );
+			paths = read_files( &reader, cache );
+
+			if( reader.error || !dirs_valid ){
+				na_core_utils_slist_free( paths );
+				paths = NULL;
+			}
+		}
+
+		g_debug( "%s: path=%s, items=%u, files=%u, error=%s", thisfn, path,
+				g_hash_table_size( cache ), g_slist_length( paths ), reader.error ? "True":"False" );
+
+		g_free( contents );
+	}
+
+	g_free( path );
+
+	return( paths );
+}
+
+/*
+ * cadp_cache_write:
+ * @dirs: the list of the searched directories.
+ * @mtimes: the modification times of the @dirs before they have been scanned.
+ * @paths: the list of the found .desktop paths.
+ * @cache: the hash table of #CappCachedItem, indexed by path.
+ *
+ * Writes the cache file, replacing the previous one.
+ *
+ * Only the materialized items are recorded.
+ */
+void
+cadp_cache_write( GSList *dirs, GArray *mtimes, GSList *paths, GHashTable *cache )
+{
+	static const gchar *thisfn = "cadp_cache_write";
+	GByteArray *buffer;
+	gchar *path, *dirname, *locale;
+	GSList *it;
+	guint i, count;
+	gint64 now, mtime;
+	CappCachedItem *cached;
+	GError *error;
+
+	buffer = g_byte_array_new();
+	g_byte_array_append( buffer, ( const guint8 * ) CACHE_MAGIC, CACHE_MAGIC_LENGTH );
+	write_uint( buffer, CACHE_VERSION );
+	write_uint( buffer, CACHE_BYTE_ORDER );
+
+	locale = get_locale();
+	write_string( buffer, locale );
+	g_free( locale );
+
+	/* a directory or a file modified during this very second may be
+	 * modified again without its modification time be changed: it is
+	 * recorded so that it will be checked again on next run
+	 */
+	now = ( gint64 ) time( NULL );
+
+	write_uint( buffer, g_slist_length( dirs ));
+	for( i = 0, it = dirs ; it ; ++i, it = it->next ){
+		mtime = g_array_index( mtimes, gint64, i );
+		write_string( buffer, ( const gchar * ) it->data );
+		write_int64( buffer, mtime >= now ? -1 : mtime );
+	}
+
+	for( count = 0, it = paths ; it ; it = it->next ){
+		cached = ( CappCachedItem * ) g_hash_table_lookup( cache, it->data );
+		if( cached && cached->item ){
+			count += 1;
+		}
+	}
+
+	write_uint( buffer, count );
+	for( it = paths ; it ; it = it->next ){
+		cached = ( CappCachedItem * ) g_hash_table_lookup( cache, it->data );
+		if( cached && cached->item ){
+			write_string( buffer, ( const gchar * ) it->data );
+			write_int64( buffer, cached->mtime >= now ? -1 : cached->mtime );
+			write_int64( buffer, cached->size );
+			write_object( buffer, NA_OBJECT_ID( cached->item ));
+		}
+	}
+
+	path = get_cache_path();
+	dirname = g_path_get_dirname( path );
+	g_mkdir_with_parents( dirname, 0700 );
+	error = NULL;
+
+	if( !g_file_set_contents( path, ( const gchar * ) buffer->data, buffer->len, &error )){
+		g_warning( "%s: %s", thisfn, error->message );
+		g_error_free( error );
+
+	} else {
+		g_debug( "%s: path=%s, files=%u, length=%u", thisfn, path, count, buffer->len );
+	}
+
+	g_free( dirname );
+	g_free( path );
+	g_byte_array_free( buffer, TRUE );
+}
+
+/*
+ * cadp_cache_free_item:
+ * @cached: a #CappCachedItem.
+ *
+ * Releases the @cached item.
+ */
+void
+cadp_cache_free_item( CappCachedItem *cached )
+{
+	if( cached->item ){
+		na_object_unref( cached->item );
+	}
+	if( cached->record ){
+		cadp_cache_record_free( cached->record );
+	}
+	g_free( cached );
+}
+
+/*
+ * cadp_cache_record_get_type:
+ * @record: the #CappCacheRecord of an item.
+ *
+ * Returns: the type of the recorded item, as a Type entry value.
+ */
+const gchar *
+cadp_cache_record_get_type( const CappCacheRecord *record )
+{
+	return( record->nature == CACHE_OBJECT_MENU ? CADP_VALUE_TYPE_MENU : CADP_VALUE_TYPE_ACTION );
+}
+
+/*
+ * cadp_cache_record_get_data:
+ * @record: a #CappCacheRecord.
+ * @name: the name of the data.
+ * @type: the expected type of the data.
+ * @value: [out]: the recorded value, as expected by na_boxed_set_from_void();
+ *  it is owned by the @record.
+ *
+ * Returns: %TRUE if a value of this @type has been recorded for @name.
+ */
+gboolean
+cadp_cache_record_get_data( const CappCacheRecord *record, const gchar *name, guint type, gconstpointer *value )
+{
+	CacheValue *recorded;
+
+	recorded = ( CacheValue * ) g_hash_table_lookup( record->data, name );
+
+	if( !recorded || recorded->type != type ){
+		return( FALSE );
+	}
+
+	*value = recorded->value;
+
+	return( TRUE );
+}
+
+/*
+ * cadp_cache_record_get_profile:
+ * @record: the #CappCacheRecord of an action.
+ * @profile_id: the identifier of the profile.
+ *
+ * Returns: the record of the profile, or %NULL.
+ */
+const CappCacheRecord *
+cadp_cache_record_get_profile( const CappCacheRecord *record, const gchar *profile_id )
+{
+	GList *it;
+	gconstpointer id;
+
+	for( it = record->profiles ; it ; it = it->next ){
+		if( cadp_cache_record_get_data(( const CappCacheRecord * ) it->data, NAFO_DATA_ID, NA_DATA_TYPE_STRING, &id ) &&
+				!g_strcmp0(( const gchar * ) id, profile_id )){
+			return(( const CappCacheRecord * ) it->data );
+		}
+	}
+
+	return( NULL );
+}
+
+/*
+ * cadp_cache_record_free:
+ * @record: a #CappCacheRecord.
+ *
+ * Releases the @record, with the records of its profiles.
+ */
+void
+cadp_cache_record_free( CappCacheRecord *record )
+{
+	g_hash_table_destroy( record->data );
+	g_list_foreach( record->profiles, ( GFunc ) cadp_cache_record_free, NULL );
+	g_list_free( record->profiles );
+	g_free( record );
+}
+
+static gchar *
+get_cache_path( void )
+{
+	return( g_build_filename( g_get_user_cache_dir(), PACKAGE, CADP_CACHE_FILENAME, NULL ));
+}
+
+static gchar *
+get_locale( void )
+{
+	return( g_strjoinv( ":", ( gchar ** ) g_get_language_names()));
+}
+
+static gboolean
+read_header( CacheReader *reader )
+{
+	static const gchar *thisfn = "cadp_cache_read_header";
+	gchar magic[CACHE_MAGIC_LENGTH];
+	guint32 version, byte_order;
+	gchar *locale, *current;
+	gboolean valid;
+
+	valid = read_bytes( reader, magic, CACHE_MAGIC_LENGTH ) &&
+			!memcmp( magic, CACHE_MAGIC, CACHE_MAGIC_LENGTH );
+
+	if( valid ){
+		version = read_uint( reader );
+		byte_order = read_uint( reader );
+		valid = !reader->error && version == CACHE_VERSION && byte_order == CACHE_BYTE_ORDER;
+	}
+
+	if( valid ){
+		locale = read_string( reader );
+		current = get_locale();
+		valid = !reader->error && !g_strcmp0( locale, current );
+		g_free( current );
+		g_free( locale );
+	}
+
+	if( !valid ){
+		g_debug( "%s: cache is not valid", thisfn );
+	}
+
+	return( valid );
+}
+
+static gboolean
+read_dirs( CacheReader *reader, GSList *dirs, GArray *mtimes )
+{
+	guint32 count, i;
+	GSList *it;
+	gchar *dir;
+	gint64 mtime;
+	gboolean valid;
+
+	count = read_uint( reader );
+	valid = ( count == g_slist_length( dirs ));
+
+	for( i = 0, it = dirs ; i < count && !reader->error ; ++i ){
+		dir = read_string( reader );
+		mtime = read_int64( reader );
+
+		if( valid ){
+			valid = !g_strcmp0( dir, ( const gchar * ) it->data ) &&
+					mtime == g_array_index( mtimes, gint64, i );
+			it = it->next;
+		}
+
+		g_free( dir );
+	}
+
+	return( valid && !reader->error );
+}
+
+static GSList *
+read_files( CacheReader *reader, GHashTable *cache )
+{
+	GSList *paths;
+	guint32 count, i;
+	gchar *path;
+	gint64 mtime, size;
+	CappCacheRecord *record;
+	CappCachedItem *cached;
+
+	paths = NULL;
+	count = read_uint( reader );
+
+	for( i = 0 ; i < count && !reader->error ; ++i ){
+		path = read_string( reader );
+		mtime = read_int64( reader );
+		size = read_int64( reader );
+		record = path ? read_record( reader ) : NULL;
+
+		if( record && record->nature == CACHE_OBJECT_PROFILE ){
+			cadp_cache_record_free( record );
+			record = NULL;
+		}
+
+		if( record ){
+			cached = g_new0( CappCachedItem, 1 );
+			cached->record = record;
+			cached->mtime = mtime;
+			cached->size = size;
+			g_hash_table_replace( cache, g_strdup( path ), cached );
+			paths = g_slist_prepend( paths, path );
+
+		} else {
+			reader->error = TRUE;
+			g_free( path );
+		}
+	}
+
+	return( g_slist_reverse( paths ));
+}
+
+/*
+ * the recorded data are those of the object after it has been read,
+ * i.e. defaults are already set
+ */
+static CappCacheRecord *
+read_record( CacheReader *reader )
+{
+	CappCacheRecord *record, *profile;
+	guint32 count, i;
+
+	record = g_new0( CappCacheRecord, 1 );
+	record->nature = read_uint( reader );
+	record->data = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) free_value );
+
+	switch( record->nature ){
+		case CACHE_OBJECT_ACTION:
+		case CACHE_OBJECT_MENU:
+		case CACHE_OBJECT_PROFILE:
+			break;
+		default:
+			reader->error = TRUE;
+	}
+
+	count = read_uint( reader );
+	for( i = 0 ; i < count && !reader->error ; ++i ){
+		read_data( reader, record );
+	}
+
+	if( record->nature == CACHE_OBJECT_ACTION ){
+		count = read_uint( reader );
+		for( i = 0 ; i < count && !reader->error ; ++i ){
+			profile = read_record( reader );
+			if( profile && profile->nature == CACHE_OBJECT_PROFILE ){
+				record->profiles = g_list_append( record->profiles, profile );
+
+			} else {
+				reader->error = TRUE;
+				if( profile ){
+					cadp_cache_record_free( profile );
+				}
+			}
+		}
+	}
+
+	if( reader->error ){
+		cadp_cache_record_free( record );
+		return( NULL );
+	}
+
+	return( record );
+}
+
+static void
+read_data( CacheReader *reader, CappCacheRecord *record )
+{
+	gchar *name;
+	guint32 type, count, i;
+	CacheValue *value;
+	GSList *slist;
+	GList *list;
+
+	name = read_string( reader );
+	type = read_uint( reader );
+
+	if( reader->error || !name ){
+		g_free( name );
+		return;
+	}
+
+	value = g_new0( CacheValue, 1 );
+	value->type = type;
+
+	switch( type ){
+		case NA_DATA_TYPE_BOOLEAN:
+		case NA_DATA_TYPE_UINT:
+			value->value = GUINT_TO_POINTER( read_uint( reader ));
+			break;
+
+		case NA_DATA_TYPE_STRING:
+		case NA_DATA_TYPE_LOCALE_STRING:
+			value->value = read_string( reader );
+			break;
+
+		case NA_DATA_TYPE_STRING_LIST:
+			slist = NULL;
+			count = read_uint( reader );
+			for( i = 0 ; i < count && !reader->error ; ++i ){
+				slist = g_slist_prepend( slist, read_string( reader ));
+			}
+			value->value = g_slist_reverse( slist );
+			break;
+
+		case NA_DATA_TYPE_UINT_LIST:
+			list = NULL;
+			count = read_uint( reader );
+			for( i = 0 ; i < count && !reader->error ; ++i ){
+				list = g_list_prepend( list, GUINT_TO_POINTER( read_uint( reader )));
+			}
+			value->value = g_list_reverse( list );
+			break;
+
+		default:
+			reader->error = TRUE;
+	}
+
+	g_hash_table_replace( record->data, name, value );
+}
+
+static void
+free_value( CacheValue *value )
+{
+	switch( value->type ){
+		case NA_DATA_TYPE_STRING:
+		case NA_DATA_TYPE_LOCALE_STRING:
+			g_free( value->value );
+			break;
+
+		case NA_DATA_TYPE_STRING_LIST:
+			na_core_utils_slist_free(( GSList * ) value->value );
+			break;
+
+		case NA_DATA_TYPE_UINT_LIST:
+			g_list_free(( GList * ) value->value );
+			break;
+	}
+
+	g_free( value );
+}
+
+static guint32
+read_uint( CacheReader *reader )
+{
+	guint32 value;
+
+	if( !read_bytes( reader, &value, sizeof( value ))){
+		value = 0;
+	}
+
+	return( value );
+}
+
+static gint64
+read_int64( CacheReader *reader )
+{
+	gint64 value;
+
+	if( !read_bytes( reader, &value, sizeof( value ))){
+		value = 0;
+	}
+
+	return( value );
+}
+
+/*
+ * a string is recorded as its length, followed by its bytes
+ * G_MAXUINT32 stands for a NULL string
+ */
+static gchar *
+read_string( CacheReader *reader )
+{
+	guint32 length;
+	gchar *value;
+
+	value = NULL;
+	length = read_uint( reader );
+
+	if( !reader->error && length != G_MAXUINT32 ){
+		if( length > reader->length - reader->offset ){
+			reader->error = TRUE;
+
+		} else {
+			value = g_strndup( reader->data + reader->offset, length );
+			reader->offset += length;
+		}
+	}
+
+	return( value );
+}
+
+/*
+ * the data may not be aligned: always copy them
+ */
+static gboolean
+read_bytes( CacheReader *reader, void *dest, gsize length )
+{
+	if( reader->error || length > reader->length - reader->offset ){
+		reader->error = TRUE;
+		return( FALSE );
+	}
+
+	memcpy( dest, reader->data + reader->offset, length );
+	reader->offset += length;
+
+	return( TRUE );
+}
+
+/*
+ * pointers (e.g. the parent, the subitems, the provider) are not
+ * recorded; the subitems of a menu will be rebuilt from their ids
+ */
+static void
+write_object( GByteArray *buffer, const NAObjectId *object )
+{
+	NADataGroup *groups, *ig;
+	NADataDef *def;
+	NADataBoxed *boxed;
+	GList *data, *it;
+
+	if( NA_IS_OBJECT_ACTION( object )){
+		write_uint( buffer, CACHE_OBJECT_ACTION );
+
+	} else if( NA_IS_OBJECT_MENU( object )){
+		write_uint( buffer, CACHE_OBJECT_MENU );
+
+	} else {
+		write_uint( buffer, CACHE_OBJECT_PROFILE );
+	}
+
+	data = NULL;
+	groups = NA_IFACTORY_OBJECT_GET_INTERFACE( object )->get_groups( NA_IFACTORY_OBJECT( object ));
+
+	for( ig = groups ; ig && ig->group ; ++ig ){
+		for( def = ig->def ; def && def->name ; ++def ){
+			if( def->type != NA_DATA_TYPE_POINTER ){
+				boxed = na_ifactory_object_get_data_boxed( NA_IFACTORY_OBJECT( object ), def->name );
+				if( boxed ){
+					data = g_list_prepend( data, boxed );
+				}
+			}
+		}
+	}
+
+	write_uint( buffer, g_list_length( data ));
+	for( it = data ; it ; it = it->next ){
+		write_data( buffer, NA_DATA_BOXED( it->data ));
+	}
+	g_list_free( data );
+
+	if( NA_IS_OBJECT_ACTION( object )){
+		data = na_object_get_items( object );
+		write_uint( buffer, g_list_length( data ));
+		for( it = data ; it ; it = it->next ){
+			write_object( buffer, NA_OBJECT_ID( it->data ));
+		}
+	}
+}
+
+static void
+write_data( GByteArray *buffer, const NADataBoxed *boxed )
+{
+	const NADataDef *def;
+	gchar *str;
+	GSList *slist, *is;
+	GList *list, *il;
+
+	def = na_data_boxed_get_data_def( boxed );
+	write_string( buffer, def->name );
+	write_uint( buffer, def->type );
+
+	switch( def->type ){
+		case NA_DATA_TYPE_BOOLEAN:
+			write_uint( buffer, na_boxed_get_boolean( NA_BOXED( boxed )));
+			break;
+
+		case NA_DATA_TYPE_UINT:
+			write_uint( buffer, na_boxed_get_uint( NA_BOXED( boxed )));
+			break;
+
+		case NA_DATA_TYPE_STRING:
+		case NA_DATA_TYPE_LOCALE_STRING:
+			str = na_boxed_get_string( NA_BOXED( boxed ));
+			write_string( buffer, str );
+			g_free( str );
+			break;
+
+		case NA_DATA_TYPE_STRING_LIST:
+			slist = na_boxed_get_string_list( NA_BOXED( boxed ));
+			write_uint( buffer, g_slist_length( slist ));
+			for( is = slist ; is ; is = is->next ){
+				write_string( buffer, ( const gchar * ) is->data );
+			}
+			na_core_utils_slist_free( slist );
+			break;
+
+		case NA_DATA_TYPE_UINT_LIST:
+			list = na_boxed_get_uint_list( NA_BOXED( boxed ));
+			write_uint( buffer, g_list_length( list ));
+			for( il = list ; il ; il = il->next ){
+				write_uint( buffer, GPOINTER_TO_UINT( il->data ));
+			}
+			g_list_free( list );
+			break;
+	}
+}
+
+static void
+write_uint( GByteArray *buffer, guint32 value )
+{
+	g_byte_array_append( buffer, ( const guint8 * ) &value, sizeof( value ));
+}
+
+static void
+write_int64( GByteArray *buffer, gint64 value )
+{
+	g_byte_array_append( buffer, ( const guint8 * ) &value, sizeof( value ));
+}
+
+static void
+write_string( GByteArray *buffer, const gchar *value )
+{
+	guint32 length;
+
+	length = value ? strlen( value ) : G_MAXUINT32;
+	write_uint( buffer, length );
+
+	if( value ){
+		g_byte_array_append( buffer, ( const guint8 * ) value, length );
+	}
+}
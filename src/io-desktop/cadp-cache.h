@@ -0,0 +1,89 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+#ifndef __CADP_CACHE_H__
+#define __CADP_CACHE_H__
+
+/*
+ * The items parsed from the .desktop files are kept in memory between
+ * two reads, and in a versioned binary cache file between two runs.
+ *
+ * The cache records the searched directories with their modification
+ * time, and the .desktop files with their size and modification time.
+ * When no directory has changed, the recorded list of files is used
+ * as is; each file is then only parsed again if its size or its
+ * modification time have changed.
+ *
+ * The cache file is read once, and decoded into records of the data of
+ * the items. An item is only materialized from its record when it is
+ * first needed, and then through the NAIFactoryProvider interface, the
+ * same way as when it is read from its .desktop file.
+ *
+ * As the localized strings are only read in the current locale, the
+ * cache is only valid for the locale it has been written with.
+ */
+
+#include <api/na-object-item.h>
+
+G_BEGIN_DECLS
+
+/* the recorded data of an item, or of one of its profiles
+ */
+typedef struct _CappCacheRecord CappCacheRecord;
+
+/* an item read from a .desktop file
+ * the item is kept pristine, and only its duplicates are returned
+ * the item is %NULL as long as it has not been materialized from its
+ * record
+ */
+typedef struct {
+	NAObjectItem    *item;
+	CappCacheRecord *record;
+	gint64           mtime;
+	gint64           size;
+}
+	CappCachedItem;
+
+#define CADP_CACHE_FILENAME		"desktop-items.cache"
+
+GArray *cadp_cache_get_dirs_mtime( GSList *dirs );
+
+GSList *cadp_cache_read          ( GSList *dirs, GArray *mtimes, GHashTable *cache );
+void    cadp_cache_write         ( GSList *dirs, GArray *mtimes, GSList *paths, GHashTable *cache );
+
+void    cadp_cache_free_item     ( CappCachedItem *cached );
+
+const gchar           *cadp_cache_record_get_type   ( const CappCacheRecord *record );
+gboolean               cadp_cache_record_get_data   ( const CappCacheRecord *record, const gchar *name, guint type, gconstpointer *value );
+const CappCacheRecord *cadp_cache_record_get_profile( const CappCacheRecord *record, const gchar *profile_id );
+void                   cadp_cache_record_free       ( CappCacheRecord *record );
+
+G_END_DECLS
+
+#endif /* __CADP_CACHE_H__ */
@@ -54,6 +54,7 @@ struct _CappDesktopFilePrivate {
 	gchar     *uri;
 	gchar     *type;
 	GKeyFile  *key_file;
+	gchar     *deferred;				/* path of a not yet loaded key file */
 };
 
 static GObjectClass *st_parent_class = NULL;
@@ -68,6 +69,7 @@ static CappDesktopFile *ndf_new( const gchar *uri );
 static gchar           *path2id( const gchar *path );
 static gchar           *uri2id( const gchar *uri );
 static gboolean         check_key_file( CappDesktopFile *ndf );
+static GKeyFile        *get_key_file( const CappDesktopFile *ndf );
 static void             remove_encoding_part( CappDesktopFile *ndf );
 
 GType
@@ -179,6 +181,7 @@ instance_finalize( GObject *object )
 	g_free( self->private->id );
 	g_free( self->private->uri );
 	g_free( self->private->type );
+	g_free( self->private->deferred );
 
 	if( self->private->key_file ){
 		g_key_file_free( self->private->key_file );
@@ -349,6 +352,47 @@ cadp_desktop_file_new_for_write( const gchar *path )
 	return( ndf );
 }
 
+/**
+ * cadp_desktop_file_new_deferred:
+ * @path: the full pathname of a .desktop file.
+ * @type: the type of the item, as a Type entry value.
+ *
+ * Retuns: a newly allocated #CappDesktopFile object.
+ *
+ * The key file will only be loaded when first accessed. This is used
+ * for the items which have been materialized from the cache, which
+ * have already been checked when they have been first parsed.
+ */
+CappDesktopFile *
+cadp_desktop_file_new_deferred( const gchar *path, const gchar *type )
+{
+	static const gchar *thisfn = "cadp_desktop_file_new_deferred";
+	CappDesktopFile *ndf;
+	GError *error;
+	gchar *uri;
+
+	ndf = NULL;
+	g_return_val_if_fail( path && g_utf8_strlen( path, -1 ) && g_path_is_absolute( path ), ndf );
+	g_return_val_if_fail( type && strlen( type ), ndf );
+
+	error = NULL;
+	uri = g_filename_to_uri( path, NULL, &error );
+	if( !uri || error ){
+		g_warning( "%s: %s: %s", thisfn, path, error->message );
+		g_error_free( error );
+		g_free( uri );
+		return( NULL );
+	}
+
+	ndf = ndf_new( uri );
+	ndf->private->type = g_strdup( type );
+	ndf->private->deferred = g_strdup( path );
+
+	g_free( uri );
+
+	return( ndf );
+}
+
 /**
  * cadp_desktop_file_get_key_file:
  * @ndf: the #CappDesktopFile instance.
@@ -366,7 +410,7 @@ cadp_desktop_file_get_key_file( const CappDesktopFile *ndf )
 
 	if( !ndf->private->dispose_has_run ){
 
-		key_file = ndf->private->key_file;
+		key_file = get_key_file( ndf );
 	}
 
 	return( key_file );
@@ -396,6 +440,38 @@ cadp_desktop_file_get_key_file_uri( const CappDesktopFile *ndf )
 	return( uri );
 }
 
+/**
+ * cadp_desktop_file_release_key_file:
+ * @ndf: the #CappDesktopFile instance.
+ *
+ * Releases the loaded key file, with all its comments and translations.
+ * It will be loaded again from the .desktop file when next accessed,
+ * e.g. when the item is written.
+ *
+ * This is a no-op if the .desktop file is not a local file, as it may
+ * then not be loaded again.
+ */
+void
+cadp_desktop_file_release_key_file( CappDesktopFile *ndf )
+{
+	static const gchar *thisfn = "cadp_desktop_file_release_key_file";
+	gchar *path;
+
+	g_return_if_fail( CADP_IS_DESKTOP_FILE( ndf ));
+
+	if( !ndf->private->dispose_has_run && !ndf->private->deferred ){
+
+		path = g_filename_from_uri( ndf->private->uri, NULL, NULL );
+		g_debug( "%s: ndf=%p, path=%s", thisfn, ( void * ) ndf, path );
+
+		if( path ){
+			g_key_file_free( ndf->private->key_file );
+			ndf->private->key_file = g_key_file_new();
+			ndf->private->deferred = path;
+		}
+	}
+}
+
 static CappDesktopFile *
 ndf_new( const gchar *uri )
 {
@@ -457,7 +533,7 @@ check_key_file( CappDesktopFile *ndf )
 	error = NULL;
 
 	/* start group must be [Desktop Entry] */
-	start_group = g_key_file_get_start_group( ndf->private->key_file );
+	start_group = g_key_file_get_start_group( get_key_file( ndf ));
 	if( strcmp( start_group, CADP_GROUP_DESKTOP )){
 		g_debug( "%s: %s: invalid start group, found %s, waited for %s",
 				thisfn, ndf->private->uri, start_group, CADP_GROUP_DESKTOP );
@@ -466,13 +542,13 @@ check_key_file( CappDesktopFile *ndf )
 
 	/* must not have Hidden=true value */
 	if( ret ){
-		has_key = g_key_file_has_key( ndf->private->key_file, start_group, CADP_KEY_HIDDEN, &error );
+		has_key = g_key_file_has_key( get_key_file( ndf ), start_group, CADP_KEY_HIDDEN, &error );
 		if( error ){
 			g_debug( "%s: %s: %s", thisfn, ndf->private->uri, error->message );
 			ret = FALSE;
 
 		} else if( has_key ){
-			hidden = g_key_file_get_boolean( ndf->private->key_file, start_group, CADP_KEY_HIDDEN, &error );
+			hidden = g_key_file_get_boolean( get_key_file( ndf ), start_group, CADP_KEY_HIDDEN, &error );
 			if( error ){
 				g_debug( "%s: %s: %s", thisfn, ndf->private->uri, error->message );
 				ret = FALSE;
@@ -489,14 +565,14 @@ check_key_file( CappDesktopFile *ndf )
 	 */
 	if( ret ){
 		type = NULL;
-		has_key = g_key_file_has_key( ndf->private->key_file, start_group, CADP_KEY_TYPE, &error );
+		has_key = g_key_file_has_key( get_key_file( ndf ), start_group, CADP_KEY_TYPE, &error );
 		if( error ){
 			g_debug( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 			ret = FALSE;
 
 		} else if( has_key ){
-			type = g_key_file_get_string( ndf->private->key_file, start_group, CADP_KEY_TYPE, &error );
+			type = g_key_file_get_string( get_key_file( ndf ), start_group, CADP_KEY_TYPE, &error );
 			if( error ){
 				g_debug( "%s: %s", thisfn, error->message );
 				g_free( type );
@@ -525,6 +601,32 @@ check_key_file( CappDesktopFile *ndf )
 	return( ret );
 }
 
+/*
+ * load the key file on first access if it has been deferred
+ */
+static GKeyFile *
+get_key_file( const CappDesktopFile *ndf )
+{
+	static const gchar *thisfn = "cadp_desktop_file_get_key_file";
+	GError *error;
+
+	if( ndf->private->deferred ){
+		g_debug( "%s: path=%s", thisfn, ndf->private->deferred );
+		error = NULL;
+
+		g_key_file_load_from_file( ndf->private->key_file, ndf->private->deferred, G_KEY_FILE_KEEP_COMMENTS | G_KEY_FILE_KEEP_TRANSLATIONS, &error );
+		if( error ){
+			g_warning( "%s: %s: %s", thisfn, ndf->private->deferred, error->message );
+			g_error_free( error );
+		}
+
+		g_free( ndf->private->deferred );
+		ndf->private->deferred = NULL;
+	}
+
+	return( ndf->private->key_file );
+}
+
 /**
  * cadp_desktop_file_get_type:
  * @ndf: the #CappDesktopFile instance.
@@ -597,7 +699,7 @@ cadp_desktop_file_get_profiles( const CappDesktopFile *ndf )
 
 	if( !ndf->private->dispose_has_run ){
 
-		groups = g_key_file_get_groups( ndf->private->key_file, NULL );
+		groups = g_key_file_get_groups( get_key_file( ndf ), NULL );
 		if( groups ){
 			ig = groups;
 			profile_pfx = g_strdup_printf( "%s ", CADP_GROUP_PROFILE );
@@ -644,7 +746,7 @@ cadp_desktop_file_has_profile( const CappDesktopFile *ndf, const gchar *profile_
 	if( !ndf->private->dispose_has_run ){
 
 		group_name = g_strdup_printf( "%s %s", CADP_GROUP_PROFILE, profile_id );
-		has_profile = g_key_file_has_group( ndf->private->key_file, group_name );
+		has_profile = g_key_file_has_group( get_key_file( ndf ), group_name );
 		g_free( group_name );
 	}
 
@@ -678,14 +780,14 @@ cadp_desktop_file_remove_key( const CappDesktopFile *ndf, const gchar *group, co
 
 	if( !ndf->private->dispose_has_run ){
 
-		g_key_file_remove_key( ndf->private->key_file, group, key, NULL );
+		g_key_file_remove_key( get_key_file( ndf ), group, key, NULL );
 
 		locales = ( char ** ) g_get_language_names();
 		iloc = locales;
 
 		while( *iloc ){
 			locale_key = g_strdup_printf( "%s[%s]", key, *iloc );
-			g_key_file_remove_key( ndf->private->key_file, group, locale_key, NULL );
+			g_key_file_remove_key( get_key_file( ndf ), group, locale_key, NULL );
 			g_free( locale_key );
 			iloc++;
 		}
@@ -709,7 +811,7 @@ cadp_desktop_file_remove_profile( const CappDesktopFile *ndf, const gchar *profi
 	if( !ndf->private->dispose_has_run ){
 
 		group_name = g_strdup_printf( "%s %s", CADP_GROUP_PROFILE, profile_id );
-		g_key_file_remove_group( ndf->private->key_file, group_name, NULL );
+		g_key_file_remove_group( get_key_file( ndf ), group_name, NULL );
 		g_free( group_name );
 	}
 }
@@ -742,13 +844,13 @@ cadp_desktop_file_get_boolean( const CappDesktopFile *ndf, const gchar *group, c
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = g_key_file_has_key( get_key_file( ndf ), group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			read_value = g_key_file_get_boolean( ndf->private->key_file, group, entry, &error );
+			read_value = g_key_file_get_boolean( get_key_file( ndf ), group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -791,7 +893,7 @@ cadp_desktop_file_get_locale_string( const CappDesktopFile *ndf, const gchar *gr
 
 		error = NULL;
 
-		read_value = g_key_file_get_locale_string( ndf->private->key_file, group, entry, NULL, &error );
+		read_value = g_key_file_get_locale_string( get_key_file( ndf ), group, entry, NULL, &error );
 		if( !read_value || error ){
 			if( error->code != G_KEY_FILE_ERROR_KEY_NOT_FOUND ){
 				g_warning( "%s: %s", thisfn, error->message );
@@ -837,13 +939,13 @@ cadp_desktop_file_get_string( const CappDesktopFile *ndf, const gchar *group, co
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = g_key_file_has_key( get_key_file( ndf ), group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			read_value = g_key_file_get_string( ndf->private->key_file, group, entry, &error );
+			read_value = g_key_file_get_string( get_key_file( ndf ), group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -888,13 +990,13 @@ cadp_desktop_file_get_string_list( const CappDesktopFile *ndf, const gchar *grou
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = g_key_file_has_key( get_key_file( ndf ), group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			read_array = g_key_file_get_string_list( ndf->private->key_file, group, entry, NULL, &error );
+			read_array = g_key_file_get_string_list( get_key_file( ndf ), group, entry, NULL, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -939,13 +1041,13 @@ cadp_desktop_file_get_uint( const CappDesktopFile *ndf, const gchar *group, cons
 	if( !ndf->private->dispose_has_run ){
 
 		error = NULL;
-		has_entry = g_key_file_has_key( ndf->private->key_file, group, entry, &error );
+		has_entry = g_key_file_has_key( get_key_file( ndf ), group, entry, &error );
 		if( error ){
 			g_warning( "%s: %s", thisfn, error->message );
 			g_error_free( error );
 
 		} else if( has_entry ){
-			value = ( guint ) g_key_file_get_integer( ndf->private->key_file, group, entry, &error );
+			value = ( guint ) g_key_file_get_integer( get_key_file( ndf ), group, entry, &error );
 			if( error ){
 				g_warning( "%s: %s", thisfn, error->message );
 				g_error_free( error );
@@ -975,7 +1077,7 @@ cadp_desktop_file_set_boolean( const CappDesktopFile *ndf, const gchar *group, c
 
 	if( !ndf->private->dispose_has_run ){
 
-		g_key_file_set_boolean( ndf->private->key_file, group, key, value );
+		g_key_file_set_boolean( get_key_file( ndf ), group, key, value );
 	}
 }
 
@@ -1065,7 +1167,7 @@ cadp_desktop_file_set_locale_string( const CappDesktopFile *ndf, const gchar *gr
 			}
 
 			if( write ){
-				g_key_file_set_locale_string( ndf->private->key_file, group, key, locales[i], value );
+				g_key_file_set_locale_string( get_key_file( ndf ), group, key, locales[i], value );
 			}
 		}
 
@@ -1089,7 +1191,7 @@ cadp_desktop_file_set_string( const CappDesktopFile *ndf, const gchar *group, co
 
 	if( !ndf->private->dispose_has_run ){
 
-		g_key_file_set_string( ndf->private->key_file, group, key, value );
+		g_key_file_set_string( get_key_file( ndf ), group, key, value );
 	}
 }
 
@@ -1112,7 +1214,7 @@ cadp_desktop_file_set_string_list( const CappDesktopFile *ndf, const gchar *grou
 	if( !ndf->private->dispose_has_run ){
 
 		array = na_core_utils_slist_to_array( value );
-		g_key_file_set_string_list( ndf->private->key_file, group, key, ( const gchar * const * ) array, g_slist_length( value ));
+		g_key_file_set_string_list( get_key_file( ndf ), group, key, ( const gchar * const * ) array, g_slist_length( value ));
 		g_strfreev( array );
 	}
 }
@@ -1133,7 +1235,7 @@ cadp_desktop_file_set_uint( const CappDesktopFile *ndf, const gchar *group, cons
 
 	if( !ndf->private->dispose_has_run ){
 
-		g_key_file_set_integer( ndf->private->key_file, group, key, value );
+		g_key_file_set_integer( get_key_file( ndf ), group, key, value );
 	}
 }
 
@@ -1166,11 +1268,11 @@ cadp_desktop_file_write( CappDesktopFile *ndf )
 
 	if( !ndf->private->dispose_has_run ){
 
-		if( ndf->private->key_file ){
+		if( get_key_file( ndf )){
 			remove_encoding_part( ndf );
 		}
 
-		data = g_key_file_to_data( ndf->private->key_file, &length, NULL );
+		data = g_key_file_to_data( get_key_file( ndf ), &length, NULL );
 		file = g_file_new_for_uri( ndf->private->uri );
 		g_debug( "%s: uri=%s", thisfn, ndf->private->uri );
 
@@ -1234,15 +1336,15 @@ remove_encoding_part( CappDesktopFile *ndf )
 		g_error_free( error );
 
 	} else {
-		groups = g_key_file_get_groups( ndf->private->key_file, NULL );
+		groups = g_key_file_get_groups( get_key_file( ndf ), NULL );
 
 		for( ig = 0 ; ig < g_strv_length( groups ) ; ++ig ){
-			keys = g_key_file_get_keys( ndf->private->key_file, groups[ig], NULL, NULL );
+			keys = g_key_file_get_keys( get_key_file( ndf ), groups[ig], NULL, NULL );
 
 			for( ik = 0 ; ik < g_strv_length( keys ) ; ++ik ){
 
 				if( g_regex_match( regex, keys[ik], 0, &info )){
-					g_key_file_remove_key( ndf->private->key_file, groups[ig], keys[ik], &error );
+					g_key_file_remove_key( get_key_file( ndf ), groups[ig], keys[ik], &error );
 					if( error ){
 						g_warning( "%s: %s", thisfn, error->message );
 						g_error_free( error );
@@ -79,9 +79,11 @@ CappDesktopFile *cadp_desktop_file_new              ( void );
 CappDesktopFile *cadp_desktop_file_new_from_path    ( const gchar *path );
 CappDesktopFile *cadp_desktop_file_new_from_uri     ( const gchar *uri );
 CappDesktopFile *cadp_desktop_file_new_for_write    ( const gchar *path );
+CappDesktopFile *cadp_desktop_file_new_deferred     ( const gchar *path, const gchar *type );
 
 GKeyFile        *cadp_desktop_file_get_key_file     ( const CappDesktopFile *ndf );
 gchar           *cadp_desktop_file_get_key_file_uri ( const CappDesktopFile *ndf );
+void             cadp_desktop_file_release_key_file ( CappDesktopFile *ndf );
 gboolean         cadp_desktop_file_write            ( CappDesktopFile *ndf );
 
 gchar           *cadp_desktop_file_get_file_type    ( const CappDesktopFile *ndf );
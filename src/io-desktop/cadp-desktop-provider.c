@@ -37,6 +37,8 @@
 #include <api/na-core-utils.h>
 #include <api/na-ifactory-provider.h>
 
+#include <core/na-settings.h>
+
 #include "cadp-desktop-provider.h"
 #include "cadp-formats.h"
 #include "cadp-keys.h"
@@ -176,6 +178,8 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->timeout.handler = ( NATimeoutFunc ) on_monitor_timeout;
 	self->private->timeout.user_data = self;
 	self->private->timeout.source_id = 0;
+	self->private->dirty = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+	self->private->cache = NULL;
 }
 
 static void
@@ -196,6 +200,14 @@ instance_dispose( GObject *object )
 
 		cadp_desktop_provider_release_monitors( self );
 
+		g_hash_table_destroy( self->private->dirty );
+		self->private->dirty = NULL;
+
+		if( self->private->cache ){
+			g_hash_table_destroy( self->private->cache );
+			self->private->cache = NULL;
+		}
+
 		/* chain up to the parent class */
 		if( G_OBJECT_CLASS( st_parent_class )->dispose ){
 			G_OBJECT_CLASS( st_parent_class )->dispose( object );
@@ -361,16 +373,27 @@ cadp_desktop_provider_add_monitor( CappDesktopProvider *provider, const gchar *d
 /**
  * cadp_desktop_provider_on_monitor_event:
  * @provider: this #CappDesktopProvider object.
+ * @file: the file or directory which has been signaled by GIO.
  *
  * Factorize events received from GIO when monitoring desktop directories.
+ *
+ * The signaled path is recorded so that the next read of the items only
+ * has to parse again the .desktop files which have actually changed.
  */
 void
-cadp_desktop_provider_on_monitor_event( CappDesktopProvider *provider )
+cadp_desktop_provider_on_monitor_event( CappDesktopProvider *provider, GFile *file )
 {
+	gchar *path;
+
 	g_return_if_fail( CADP_IS_DESKTOP_PROVIDER( provider ));
 
 	if( !provider->private->dispose_has_run ){
 
+		path = file ? g_file_get_path( file ) : NULL;
+		if( path ){
+			g_hash_table_replace( provider->private->dirty, path, GUINT_TO_POINTER( TRUE ));
+		}
+
 		na_timeout_event( &provider->private->timeout );
 	}
 }
@@ -394,6 +417,28 @@ cadp_desktop_provider_release_monitors( CappDesktopProvider *provider )
 	}
 }
 
+/**
+ * cadp_desktop_provider_is_compact_load:
+ *
+ * Returns: %TRUE if the key files should be released as soon as the
+ * items have been read or written, %FALSE if they should be kept with
+ * the items.
+ *
+ * This is the 'compact-load' key of our i/o provider group.
+ */
+gboolean
+cadp_desktop_provider_is_compact_load( void )
+{
+	gboolean compact;
+	gchar *group;
+
+	group = g_strdup_printf( "%s %s", NA_IPREFS_IO_PROVIDER_GROUP, PROVIDER_ID );
+	compact = na_settings_get_boolean_ex( group, NA_IPREFS_IO_PROVIDER_COMPACT_LOAD, NULL, NULL );
+	g_free( group );
+
+	return( compact );
+}
+
 static void
 on_monitor_timeout( CappDesktopProvider *provider )
 {
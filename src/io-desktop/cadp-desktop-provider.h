@@ -40,6 +40,8 @@
  * should only be used through the NAIIOProvider interface.
  */
 
+#include <gio/gio.h>
+
 #include <api/na-object-item.h>
 #include <api/na-timeout.h>
 
@@ -58,9 +60,11 @@ G_BEGIN_DECLS
  */
 typedef struct _CappDesktopProviderPrivate {
 	/*< private >*/
-	gboolean  dispose_has_run;
-	GList    *monitors;
-	NATimeout timeout;
+	gboolean    dispose_has_run;
+	GList      *monitors;
+	NATimeout   timeout;
+	GHashTable *dirty;				/* paths signaled by the monitors */
+	GHashTable *cache;				/* path -> last parsed item */
 }
 	CappDesktopProviderPrivate;
 
@@ -89,9 +93,11 @@ GType cadp_desktop_provider_get_type     ( void );
 void  cadp_desktop_provider_register_type( GTypeModule *module );
 
 void  cadp_desktop_provider_add_monitor     ( CappDesktopProvider *provider, const gchar *dir );
-void  cadp_desktop_provider_on_monitor_event( CappDesktopProvider *provider );
+void  cadp_desktop_provider_on_monitor_event( CappDesktopProvider *provider, GFile *file );
 void  cadp_desktop_provider_release_monitors( CappDesktopProvider *provider );
 
+gboolean cadp_desktop_provider_is_compact_load( void );
+
 G_END_DECLS
 
 #endif /* __CADP_DESKTOP_PROVIDER_H__ */
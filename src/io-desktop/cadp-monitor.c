@@ -246,5 +246,9 @@ cadp_monitor_new( const CappDesktopProvider *provider, const gchar *path )
 static void
 on_monitor_changed( GFileMonitor *monitor, GFile *file, GFile *other_file, GFileMonitorEvent event_type, CappMonitor *my_monitor )
 {
-	cadp_desktop_provider_on_monitor_event( my_monitor->private->provider );
+	if( other_file ){
+		cadp_desktop_provider_on_monitor_event( my_monitor->private->provider, other_file );
+	}
+
+	cadp_desktop_provider_on_monitor_event( my_monitor->private->provider, file );
 }
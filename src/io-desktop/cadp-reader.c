@@ -32,6 +32,7 @@
 #endif
 
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -41,10 +42,12 @@
 #include <api/na-ifactory-provider.h>
 #include <api/na-object-api.h>
 
+#include "cadp-cache.h"
 #include "cadp-desktop-provider.h"
 #include "cadp-keys.h"
 #include "cadp-reader.h"
 #include "cadp-utils.h"
+#include "cadp-writer.h"
 #include "cadp-xdg-dirs.h"
 
 typedef struct {
@@ -53,24 +56,54 @@ typedef struct {
 }
 	DesktopPath;
 
-/* the structure passed as reader data to NAIFactoryObject
+/* the reading of a .desktop file, as run in a worker thread
+ * - cached: the cached item, if it is still valid
+ * - ndf: the loaded key file, when the file has to be parsed again
  */
 typedef struct {
+	DesktopPath     *dps;
+	GStatBuf         st;
+	CappCachedItem  *cached;
 	CappDesktopFile *ndf;
-	NAObjectAction  *action;
+}
+	ReaderJob;
+
+/* the structure passed as reader data to NAIFactoryObject
+ * record is set when the object is read from the cache rather than
+ * from the .desktop file
+ */
+typedef struct {
+	CappDesktopFile       *ndf;
+	NAObjectAction        *action;
+	const CappCacheRecord *record;
 }
 	CappReaderData;
 
 #define ERR_NOT_DESKTOP		_( "The Desktop I/O Provider is not able to handle the URI" )
 
-static GList            *get_list_of_desktop_paths( CappDesktopProvider *provider, GSList **mesages );
-static void              get_list_of_desktop_files( const CappDesktopProvider *provider, GList **files, const gchar *dir, GSList **messages );
-static gboolean          is_already_loaded( const CappDesktopProvider *provider, GList *files, const gchar *desktop_id );
-static GList            *desktop_path_from_id( const CappDesktopProvider *provider, GList *files, const gchar *dir, const gchar *id );
-static NAIFactoryObject *item_from_desktop_path( const CappDesktopProvider *provider, DesktopPath *dps, GSList **messages );
-static NAIFactoryObject *item_from_desktop_file( const CappDesktopProvider *provider, CappDesktopFile *ndf, GSList **messages );
+/* the .desktop files are loaded in a pool of worker threads, at most
+ * READER_MAX_THREADS at a time; this is mostly waiting for the I/O
+ * (e.g. on a NFS-mounted /usr/share), so it is not bound to the count
+ * of processors
+ */
+#define READER_MAX_THREADS	8
+
+static GSList           *get_list_of_desktop_dirs( void );
+static GPtrArray        *get_list_of_desktop_paths( CappDesktopProvider *provider, GSList *dirs, GSList **mesages );
+static GPtrArray        *get_list_from_cache( GSList *paths );
+static void              get_list_of_desktop_files( const CappDesktopProvider *provider, GPtrArray *files, GHashTable *ids, const gchar *dir, GSList **messages );
+static gboolean          is_already_loaded( const CappDesktopProvider *provider, GHashTable *ids, const gchar *desktop_id );
+static DesktopPath      *desktop_path_from_id( const CappDesktopProvider *provider, const gchar *dir, const gchar *id );
+static NAIFactoryObject *item_from_desktop_file( const CappDesktopProvider *provider, CappDesktopFile *ndf, const CappCacheRecord *record, GSList **messages );
 static void              desktop_weak_notify( CappDesktopFile *ndf, GObject *item );
-static void              free_desktop_paths( GList *paths );
+static void              free_desktop_path( DesktopPath *dps );
+static void              run_jobs( CappDesktopProvider *provider, ReaderJob *jobs, guint count );
+static void              run_job( ReaderJob *job, CappDesktopProvider *provider );
+static CappCachedItem   *get_cached_item( const CappDesktopProvider *provider, DesktopPath *dps, GStatBuf *st );
+static gboolean          materialize_cached_item( const CappDesktopProvider *provider, DesktopPath *dps, CappCachedItem *cached, GSList **messages );
+static void              cache_item( CappDesktopProvider *provider, DesktopPath *dps, NAIFactoryObject *item, GStatBuf *st );
+static NAObjectItem     *duplicate_item( const CappDesktopProvider *provider, NAObjectItem *item );
+static gboolean          is_stale( const gchar *path, CappCachedItem *cached, GHashTable *seen );
 
 static void              read_start_read_subitems_key( const NAIFactoryProvider *provider, NAObjectItem *item, CappReaderData *reader_data, GSList **messages );
 static void              read_start_profile_attach_profile( const NAIFactoryProvider *provider, NAObjectProfile *profile, CappReaderData *reader_data, GSList **messages );
@@ -88,22 +121,92 @@ GList *
 cadp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 {
 	static const gchar *thisfn = "cadp_iio_provider_read_items";
+	CappDesktopProvider *self;
 	GList *items;
-	GList *desktop_paths, *ip;
+	GSList *dirs, *id, *paths;
+	GArray *mtimes;
+	GPtrArray *desktop_paths;
 	NAIFactoryObject *item;
+	ReaderJob *jobs, *job;
+	GHashTable *seen;
+	guint count, i, parsed, removed;
+	gboolean scanned, compact;
 
 	g_debug( "%s: provider=%p (%s), messages=%p",
 			thisfn, ( void * ) provider, G_OBJECT_TYPE_NAME( provider ), ( void * ) messages );
 
 	g_return_val_if_fail( NA_IS_IIO_PROVIDER( provider ), NULL );
 
+	self = CADP_DESKTOP_PROVIDER( provider );
 	items = NULL;
-	cadp_desktop_provider_release_monitors( CADP_DESKTOP_PROVIDER( provider ));
+	desktop_paths = NULL;
+	parsed = 0;
+	cadp_desktop_provider_release_monitors( self );
+
+	dirs = get_list_of_desktop_dirs();
+	mtimes = cadp_cache_get_dirs_mtime( dirs );
+
+	for( id = dirs ; id ; id = id->next ){
+		cadp_desktop_provider_add_monitor( self, ( const gchar * ) id->data );
+	}
+
+	/* on first read, load the records of the items from the cache
+	 * file, and trust its list of files if no directory has changed
+	 */
+	if( !self->private->cache ){
+		self->private->cache = g_hash_table_new_full(
+				g_str_hash, g_str_equal, g_free, ( GDestroyNotify ) cadp_cache_free_item );
+
+		paths = cadp_cache_read( dirs, mtimes, self->private->cache );
+		desktop_paths = get_list_from_cache( paths );
+		na_core_utils_slist_free( paths );
+	}
+
+	scanned = ( desktop_paths == NULL );
+	if( scanned ){
+		desktop_paths = get_list_of_desktop_paths( self, dirs, messages );
+	}
+
+	/* check and load the files concurrently, then build the items
+	 * here, in the order of the list, i.e. the same as when reading
+	 * them one after the other
+	 */
+	count = desktop_paths->len;
+	jobs = g_new0( ReaderJob, count );
+	seen = g_hash_table_new( g_str_hash, g_str_equal );
+
+	for( i = 0 ; i < count ; ++i ){
+		jobs[i].dps = ( DesktopPath * ) g_ptr_array_index( desktop_paths, i );
+		g_hash_table_insert( seen, jobs[i].dps->path, jobs[i].dps );
+	}
+
+	run_jobs( self, jobs, count );
+	compact = cadp_desktop_provider_is_compact_load();
+
+	for( i = 0 ; i < count ; ++i ){
+		job = &jobs[i];
 
-	desktop_paths = get_list_of_desktop_paths( CADP_DESKTOP_PROVIDER( provider ), messages );
-	for( ip = desktop_paths ; ip ; ip = ip->next ){
+		if( job->cached && !job->cached->item && !materialize_cached_item( self, job->dps, job->cached, messages )){
+			g_hash_table_remove( self->private->cache, job->dps->path );
+			job->cached = NULL;
+			job->ndf = cadp_desktop_file_new_from_path( job->dps->path );
+		}
+
+		if( job->cached ){
+			item = NA_IFACTORY_OBJECT( duplicate_item( self, job->cached->item ));
+
+		} else {
+			item = job->ndf ? item_from_desktop_file( self, job->ndf, NULL, messages ) : NULL;
+			cache_item( self, job->dps, item, &job->st );
 
-		item = item_from_desktop_path( CADP_DESKTOP_PROVIDER( provider ), ( DesktopPath * ) ip->data, messages );
+			/* the read data are kept in the item, in the current
+			 * locale: the key file will be loaded again if needed
+			 */
+			if( item && compact ){
+				cadp_desktop_file_release_key_file( job->ndf );
+			}
+			parsed += 1;
+		}
 
 		if( item ){
 			items = g_list_prepend( items, item );
@@ -111,31 +214,49 @@ cadp_iio_provider_read_items( const NAIIOProvider *provider, GSList **messages )
 		}
 	}
 
-	free_desktop_paths( desktop_paths );
+	g_free( jobs );
+	items = g_list_reverse( items );
 
-	g_debug( "%s: count=%d", thisfn, g_list_length( items ));
+	/* forget the files which have disappeared, and the signaled paths
+	 * which have now been considered
+	 */
+	removed = g_hash_table_foreach_remove( self->private->cache, ( GHRFunc ) is_stale, seen );
+	g_hash_table_remove_all( self->private->dirty );
+	g_hash_table_destroy( seen );
+
+	if( scanned || parsed || removed ){
+		paths = NULL;
+		for( i = 0 ; i < count ; ++i ){
+			paths = g_slist_prepend( paths, (( DesktopPath * ) g_ptr_array_index( desktop_paths, i ))->path );
+		}
+		paths = g_slist_reverse( paths );
+		cadp_cache_write( dirs, mtimes, paths, self->private->cache );
+		g_slist_free( paths );
+	}
+
+	g_ptr_array_free( desktop_paths, TRUE );
+	g_array_free( mtimes, TRUE );
+	na_core_utils_slist_free( dirs );
+
+	g_debug( "%s: count=%d, parsed=%u, scanned=%s", thisfn, g_list_length( items ), parsed, scanned ? "True":"False" );
 	return( items );
 }
 
 /*
- * returns a list of DesktopPath items
+ * returns the list of the directories to be searched for
  *
  * we get the ordered list of XDG_DATA_DIRS, and the ordered list of
- *  subdirs to add; then for each item of each list, we search for
- *  .desktop files in the resulted built path
- *
- * the returned list is so a list of DesktopPath struct, in
- * the ordered of preference (most preferred first)
+ *  subdirs to add; the returned list is so the list of the resulting
+ *  built paths, in the order of preference (most preferred first)
  */
-static GList *
-get_list_of_desktop_paths( CappDesktopProvider *provider, GSList **messages )
+static GSList *
+get_list_of_desktop_dirs( void )
 {
-	GList *files;
+	GSList *dirs;
 	GSList *xdg_dirs, *idir;
 	GSList *subdirs, *isub;
-	gchar *dir;
 
-	files = NULL;
+	dirs = NULL;
 	xdg_dirs = cadp_xdg_dirs_get_data_dirs();
 	subdirs = na_core_utils_slist_from_split( CADP_DESKTOP_PROVIDER_SUBDIRS, G_SEARCHPATH_SEPARATOR_S );
 
@@ -147,16 +268,73 @@ get_list_of_desktop_paths( CappDesktopProvider *provider, GSList **messages )
 		 */
 		for( isub = subdirs ; isub ; isub = isub->next ){
 
-			dir = g_build_filename(( gchar * ) idir->data, ( gchar * ) isub->data, NULL );
-			cadp_desktop_provider_add_monitor( provider, dir );
-			get_list_of_desktop_files( provider, &files, dir, messages );
-			g_free( dir );
+			dirs = g_slist_prepend( dirs, g_build_filename(( gchar * ) idir->data, ( gchar * ) isub->data, NULL ));
 		}
 	}
 
 	na_core_utils_slist_free( subdirs );
 	na_core_utils_slist_free( xdg_dirs );
 
+	return( g_slist_reverse( dirs ));
+}
+
+/*
+ * returns an array of DesktopPath items
+ *
+ * for each directory, we search for .desktop files; the returned array
+ * is so an array of DesktopPath struct, in the order of preference of
+ * the directories
+ *
+ * the desktop ids already found are kept in a set, so that the scan is
+ * linear in the count of files
+ */
+static GPtrArray *
+get_list_of_desktop_paths( CappDesktopProvider *provider, GSList *dirs, GSList **messages )
+{
+	GPtrArray *files;
+	GHashTable *ids;
+	GSList *idir;
+
+	files = g_ptr_array_new_with_free_func(( GDestroyNotify ) free_desktop_path );
+	ids = g_hash_table_new_full( g_str_hash, g_str_equal, g_free, NULL );
+
+	for( idir = dirs ; idir ; idir = idir->next ){
+		get_list_of_desktop_files( provider, files, ids, ( const gchar * ) idir->data, messages );
+	}
+
+	g_hash_table_destroy( ids );
+
+	return( files );
+}
+
+/*
+ * returns an array of DesktopPath items from the list of paths recorded
+ * in the cache file, keeping the same order, or %NULL if the list is
+ * empty
+ */
+static GPtrArray *
+get_list_from_cache( GSList *paths )
+{
+	GPtrArray *files;
+	GSList *ip;
+	DesktopPath *dps;
+	gchar *bname;
+
+	if( !paths ){
+		return( NULL );
+	}
+
+	files = g_ptr_array_new_with_free_func(( GDestroyNotify ) free_desktop_path );
+
+	for( ip = paths ; ip ; ip = ip->next ){
+		dps = g_new0( DesktopPath, 1 );
+		dps->path = g_strdup(( const gchar * ) ip->data );
+		bname = g_path_get_basename( dps->path );
+		dps->id = na_core_utils_str_remove_suffix( bname, CADP_DESKTOP_FILE_SUFFIX );
+		g_free( bname );
+		g_ptr_array_add( files, dps );
+	}
+
 	return( files );
 }
 
@@ -165,7 +343,7 @@ get_list_of_desktop_paths( CappDesktopProvider *provider, GSList **messages )
  * only adds to the list those which have not been yet loaded
  */
 static void
-get_list_of_desktop_files( const CappDesktopProvider *provider, GList **files, const gchar *dir, GSList **messages )
+get_list_of_desktop_files( const CappDesktopProvider *provider, GPtrArray *files, GHashTable *ids, const gchar *dir, GSList **messages )
 {
 	static const gchar *thisfn = "cadp_reader_get_list_of_desktop_files";
 	GDir *dir_handle;
@@ -174,7 +352,7 @@ get_list_of_desktop_files( const CappDesktopProvider *provider, GList **files, c
 	gchar *desktop_id;
 
 	g_debug( "%s: provider=%p, files=%p (count=%d), dir=%s, messages=%p",
-			thisfn, ( void * ) provider, ( void * ) files, g_list_length( *files ), dir, ( void * ) messages );
+			thisfn, ( void * ) provider, ( void * ) files, files->len, dir, ( void * ) messages );
 
 	error = NULL;
 	dir_handle = NULL;
@@ -196,8 +374,8 @@ get_list_of_desktop_files( const CappDesktopProvider *provider, GList **files, c
 		while(( name = g_dir_read_name( dir_handle ))){
 			if( g_str_has_suffix( name, CADP_DESKTOP_FILE_SUFFIX )){
 				desktop_id = na_core_utils_str_remove_suffix( name, CADP_DESKTOP_FILE_SUFFIX );
-				if( !is_already_loaded( provider, *files, desktop_id )){
-					*files = desktop_path_from_id( provider, *files, dir, desktop_id );
+				if( !is_already_loaded( provider, ids, desktop_id )){
+					g_ptr_array_add( files, desktop_path_from_id( provider, dir, desktop_id ));
 				}
 				g_free( desktop_id );
 			}
@@ -210,30 +388,34 @@ close_dir_handle:
 	}
 }
 
+/*
+ * desktop ids are compared case-insensitively: the set is keyed by the
+ * ASCII-lowercased id
+ * records the id if it was not yet found
+ */
 static gboolean
-is_already_loaded( const CappDesktopProvider *provider, GList *files, const gchar *desktop_id )
+is_already_loaded( const CappDesktopProvider *provider, GHashTable *ids, const gchar *desktop_id )
 {
 	gboolean found;
-	GList *ip;
-	DesktopPath *dps;
+	gchar *key;
 
-	found = FALSE;
-	for( ip = files ; ip && !found ; ip = ip->next ){
-		dps = ( DesktopPath * ) ip->data;
-		if( !g_ascii_strcasecmp( dps->id, desktop_id )){
-			found = TRUE;
-		}
+	key = g_ascii_strdown( desktop_id, -1 );
+	found = ( g_hash_table_lookup( ids, key ) != NULL );
+
+	if( found ){
+		g_free( key );
+	} else {
+		g_hash_table_insert( ids, key, GUINT_TO_POINTER( TRUE ));
 	}
 
 	return( found );
 }
 
-static GList *
-desktop_path_from_id( const CappDesktopProvider *provider, GList *files, const gchar *dir, const gchar *id )
+static DesktopPath *
+desktop_path_from_id( const CappDesktopProvider *provider, const gchar *dir, const gchar *id )
 {
 	DesktopPath *dps;
 	gchar *bname;
-	GList *list;
 
 	dps = g_new0( DesktopPath, 1 );
 
@@ -243,34 +425,15 @@ desktop_path_from_id( const CappDesktopProvider *provider, GList *files, const g
 
 	dps->id = g_strdup( id );
 
-	list = g_list_prepend( files, dps );
-
-	return( list );
-}
-
-/*
- * Returns a newly allocated NAIFactoryObject-derived object, initialized
- * from the .desktop file pointed to by DesktopPath struct
- */
-static NAIFactoryObject *
-item_from_desktop_path( const CappDesktopProvider *provider, DesktopPath *dps, GSList **messages )
-{
-	CappDesktopFile *ndf;
-
-	ndf = cadp_desktop_file_new_from_path( dps->path );
-	if( !ndf ){
-		return( NULL );
-	}
-
-	return( item_from_desktop_file( provider, ndf, messages ));
+	return( dps );
 }
 
 /*
  * Returns a newly allocated NAIFactoryObject-derived object, initialized
- * from the .desktop file
+ * from the .desktop file, or from its @record in the cache
  */
 static NAIFactoryObject *
-item_from_desktop_file( const CappDesktopProvider *provider, CappDesktopFile *ndf, GSList **messages )
+item_from_desktop_file( const CappDesktopProvider *provider, CappDesktopFile *ndf, const CappCacheRecord *record, GSList **messages )
 {
 	/*static const gchar *thisfn = "cadp_reader_item_from_desktop_file";*/
 	NAIFactoryObject *item;
@@ -299,6 +462,7 @@ item_from_desktop_file( const CappDesktopProvider *provider, CappDesktopFile *nd
 
 		reader_data = g_new0( CappReaderData, 1 );
 		reader_data->ndf = ndf;
+		reader_data->record = record;
 
 		na_ifactory_provider_read_item( NA_IFACTORY_PROVIDER( provider ), reader_data, item, messages );
 
@@ -325,20 +489,183 @@ desktop_weak_notify( CappDesktopFile *ndf, GObject *item )
 	g_object_unref( ndf );
 }
 
+/*
+ * runs the jobs in a pool of worker threads
+ *
+ * the workers only stat the files, lookup the cache and load the key
+ * files; the items are built by the caller, as the NAIFactoryObject
+ * machinery is not thread-safe
+ *
+ * the cache and the set of signaled paths are only read here, and
+ * the monitors cannot modify them while we are waiting for the pool
+ */
 static void
-free_desktop_paths( GList *paths )
+run_jobs( CappDesktopProvider *provider, ReaderJob *jobs, guint count )
 {
-	GList *ip;
-	DesktopPath *dps;
+	static const gchar *thisfn = "cadp_reader_run_jobs";
+	GThreadPool *pool;
+	GError *error;
+	guint i;
 
-	for( ip = paths ; ip ; ip = ip->next ){
-		dps = ( DesktopPath * ) ip->data;
-		g_free( dps->path );
-		g_free( dps->id );
-		g_free( dps );
+	pool = NULL;
+
+	if( count > 1 ){
+		/* make sure the class is registered from this thread */
+		cadp_desktop_file_get_type();
+
+		error = NULL;
+		pool = g_thread_pool_new(( GFunc ) run_job, provider, READER_MAX_THREADS, FALSE, &error );
+		if( !pool ){
+			g_warning( "%s: g_thread_pool_new: %s", thisfn, error->message );
+			g_error_free( error );
+		}
+	}
+
+	for( i = 0 ; i < count ; ++i ){
+		if( pool ){
+			g_thread_pool_push( pool, &jobs[i], NULL );
+		} else {
+			run_job( &jobs[i], provider );
+		}
+	}
+
+	if( pool ){
+		g_thread_pool_free( pool, FALSE, TRUE );
+	}
+}
+
+/*
+ * this is run in a worker thread
+ */
+static void
+run_job( ReaderJob *job, CappDesktopProvider *provider )
+{
+	job->cached = get_cached_item( provider, job->dps, &job->st );
+
+	if( !job->cached ){
+		job->ndf = cadp_desktop_file_new_from_path( job->dps->path );
+	}
+}
+
+/*
+ * Returns the item last parsed from this path, or %NULL if the file
+ * has to be parsed
+ *
+ * the file is parsed again when it has been signaled by a monitor, or
+ * when its size or modification time have changed, e.g. because it has
+ * been modified while not monitored
+ */
+static CappCachedItem *
+get_cached_item( const CappDesktopProvider *provider, DesktopPath *dps, GStatBuf *st )
+{
+	CappCachedItem *cached;
+
+	memset( st, '\0', sizeof( GStatBuf ));
+
+	if( g_stat( dps->path, st ) != 0 ){
+		return( NULL );
+	}
+
+	if( g_hash_table_lookup( provider->private->dirty, dps->path )){
+		return( NULL );
+	}
+
+	cached = ( CappCachedItem * ) g_hash_table_lookup( provider->private->cache, dps->path );
+
+	if( !cached || cached->mtime != ( gint64 ) st->st_mtime || cached->size != ( gint64 ) st->st_size ){
+		return( NULL );
+	}
+
+	return( cached );
+}
+
+/*
+ * build the item from its record, as if it was read from its .desktop
+ * file; the key file itself will only be loaded if the item has to be
+ * written
+ *
+ * the record is no more needed once the item has been built
+ */
+static gboolean
+materialize_cached_item( const CappDesktopProvider *provider, DesktopPath *dps, CappCachedItem *cached, GSList **messages )
+{
+	CappDesktopFile *ndf;
+	NAIFactoryObject *item;
+
+	item = NULL;
+	ndf = cadp_desktop_file_new_deferred( dps->path, cadp_cache_record_get_type( cached->record ));
+
+	if( ndf ){
+		item = item_from_desktop_file( provider, ndf, cached->record, messages );
+		if( !item ){
+			g_object_unref( ndf );
+		}
 	}
 
-	g_list_free( paths );
+	cadp_cache_record_free( cached->record );
+	cached->record = NULL;
+	cached->item = item ? NA_OBJECT_ITEM( item ) : NULL;
+
+	return( item != NULL );
+}
+
+/*
+ * keep a pristine duplicate of the just parsed item
+ * the recorded size and modification time are those from before the
+ * parsing, so that a modification during the parsing will be detected
+ */
+static void
+cache_item( CappDesktopProvider *provider, DesktopPath *dps, NAIFactoryObject *item, GStatBuf *st )
+{
+	CappCachedItem *cached;
+
+	if( item ){
+		cached = g_new0( CappCachedItem, 1 );
+		cached->item = duplicate_item( provider, NA_OBJECT_ITEM( item ));
+		cached->mtime = ( gint64 ) st->st_mtime;
+		cached->size = ( gint64 ) st->st_size;
+		g_hash_table_replace( provider->private->cache, g_strdup( dps->path ), cached );
+
+	} else {
+		g_hash_table_remove( provider->private->cache, dps->path );
+	}
+}
+
+/*
+ * the duplicate shares the NADataBoxed of the item, and refs its
+ * CappDesktopFile; it must not keep the item as its origin, as each
+ * of them may be released independently of the other
+ */
+static NAObjectItem *
+duplicate_item( const CappDesktopProvider *provider, NAObjectItem *item )
+{
+	NAObjectItem *dup;
+	GList *it;
+
+	dup = NA_OBJECT_ITEM( na_object_duplicate( item, DUPLICATE_REC ));
+
+	na_object_set_origin( dup, NULL );
+	for( it = na_object_get_items( dup ) ; it ; it = it->next ){
+		na_object_set_origin( it->data, NULL );
+	}
+
+	cadp_iio_provider_duplicate_data( NA_IIO_PROVIDER( provider ), dup, item, NULL );
+
+	return( dup );
+}
+
+static gboolean
+is_stale( const gchar *path, CappCachedItem *cached, GHashTable *seen )
+{
+	return( g_hash_table_lookup( seen, path ) == NULL );
+}
+
+static void
+free_desktop_path( DesktopPath *dps )
+{
+	g_free( dps->path );
+	g_free( dps->id );
+	g_free( dps );
 }
 
 /**
@@ -386,7 +713,7 @@ cadp_reader_iimporter_import_from_uri( const NAIImporter *instance, void *parms_
 	if( ndf ){
 		parms->imported = ( NAObjectItem * ) item_from_desktop_file(
 				( const CappDesktopProvider * ) CADP_DESKTOP_PROVIDER( instance ),
-				ndf, &parms->messages );
+				ndf, NULL, &parms->messages );
 
 		if( parms->imported ){
 			g_return_val_if_fail( NA_IS_OBJECT_ITEM( parms->imported ), IMPORTER_CODE_NOT_WILLING_TO );
@@ -452,6 +779,14 @@ read_start_read_subitems_key( const NAIFactoryProvider *provider, NAObjectItem *
 {
 	GSList *subitems;
 	gboolean key_found;
+	gconstpointer value;
+
+	if( reader_data->record ){
+		if( cadp_cache_record_get_data( reader_data->record, NAFO_DATA_SUBITEMS_SLIST, NA_DATA_TYPE_STRING_LIST, &value )){
+			na_object_set_items_slist( item, value );
+		}
+		return;
+	}
 
 	subitems = cadp_desktop_file_get_string_list( reader_data->ndf,
 			CADP_GROUP_DESKTOP,
@@ -479,6 +814,9 @@ read_start_profile_attach_profile( const NAIFactoryProvider *provider, NAObjectP
  * - the data type (+ reading default value)
  * - group and key names
  *
+ * when the object is read from the cache, the recorded value is used
+ * instead, whether the data has a desktop entry or not
+ *
  * Returns: NULL if the key has not been found
  * letting the caller deal with default values
  */
@@ -495,6 +833,7 @@ cadp_reader_ifactory_provider_read_data( const NAIFactoryProvider *reader, void
 	gboolean bool_value;
 	GSList *slist_value;
 	guint uint_value;
+	gconstpointer value;
 
 	g_return_val_if_fail( NA_IS_IFACTORY_PROVIDER( reader ), NULL );
 	g_return_val_if_fail( CADP_IS_DESKTOP_PROVIDER( reader ), NULL );
@@ -507,7 +846,13 @@ cadp_reader_ifactory_provider_read_data( const NAIFactoryProvider *reader, void
 		nrd = ( CappReaderData * ) reader_data;
 		g_return_val_if_fail( CADP_IS_DESKTOP_FILE( nrd->ndf ), NULL );
 
-		if( def->desktop_entry ){
+		if( nrd->record ){
+			if( cadp_cache_record_get_data( nrd->record, def->name, def->type, &value )){
+				boxed = na_data_boxed_new( def );
+				na_boxed_set_from_void( NA_BOXED( boxed ), value );
+			}
+
+		} else if( def->desktop_entry ){
 
 			if( NA_IS_OBJECT_ITEM( object )){
 				group = g_strdup( CADP_GROUP_DESKTOP );
@@ -670,16 +1015,24 @@ read_done_action_load_profile( const NAIFactoryProvider *provider, CappReaderDat
 {
 	static const gchar *thisfn = "cadp_reader_read_done_action_load_profile";
 	NAObjectProfile *profile;
+	CappReaderData profile_data;
 
 	g_debug( "%s: loading profile=%s", thisfn, profile_id );
 
 	profile = na_object_profile_new_with_defaults();
 	na_object_set_id( profile, profile_id );
 
-	if( cadp_desktop_file_has_profile( reader_data->ndf, profile_id )){
+	/* the profile is read from its own record in the cache
+	 */
+	profile_data = *reader_data;
+	if( reader_data->record ){
+		profile_data.record = cadp_cache_record_get_profile( reader_data->record, profile_id );
+	}
+
+	if( reader_data->record ? profile_data.record != NULL : cadp_desktop_file_has_profile( reader_data->ndf, profile_id )){
 		na_ifactory_provider_read_item(
 				NA_IFACTORY_PROVIDER( provider ),
-				reader_data,
+				&profile_data,
 				NA_IFACTORY_OBJECT( profile ),
 				messages );
 
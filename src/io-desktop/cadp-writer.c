@@ -241,6 +241,9 @@ write_item( const NAIIOProvider *provider, const NAObjectItem *item, CappDesktop
 
 	if( !cadp_desktop_file_write( ndf )){
 		ret = NA_IIO_PROVIDER_CODE_WRITE_ERROR;
+
+	} else if( cadp_desktop_provider_is_compact_load()){
+		cadp_desktop_file_release_key_file( ndf );
 	}
 
 	return( ret );
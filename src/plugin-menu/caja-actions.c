@@ -43,10 +43,13 @@
 #include <api/na-object-api.h>
 #include <api/na-timeout.h>
 
+#include <core/na-context-program.h>
 #include <core/na-pivot.h>
 #include <core/na-about.h>
 #include <core/na-selected-info.h>
+#include <core/na-show-if-true.h>
 #include <core/na-tokens.h>
+#include <core/na-try-exec.h>
 
 #include "caja-actions.h"
 
@@ -64,8 +67,46 @@ struct _CajaActionsPrivate {
 	gulong    items_changed_handler;
 	gulong    settings_changed_handler;
 	NATimeout change_timeout;
+	gboolean  settings_changed;			/* whether the menus must be rebuilt even if items are unchanged */
+	guint     attributes;				/* file attributes required by loaded items */
+	guint     fields;					/* tokens fields required by loaded items */
 };
 
+/* the data which may embed parameters, and so have to be expanded for
+ * each new selection; the mask of those which actually embed parameters
+ * is computed once when the items are loaded, and attached to each item
+ * and profile, so that static items are neither duplicated nor parsed
+ * - cheap: whether the data is checked by the cheap predicates, i.e.
+ *   before the ShowIfTrue command is run
+ */
+typedef struct {
+	const gchar *name;
+	gboolean     utf8;
+	gboolean     cheap;
+}
+	DynamicData;
+
+static const DynamicData st_dynamic_data[] = {
+		{ NAFO_DATA_LABEL,              TRUE,  FALSE },
+		{ NAFO_DATA_TOOLTIP,            TRUE,  FALSE },
+		{ NAFO_DATA_ICON,               TRUE,  FALSE },
+		{ NAFO_DATA_TOOLBAR_LABEL,      TRUE,  FALSE },
+		{ NAFO_DATA_WORKING_DIR,        FALSE, FALSE },
+		{ NAFO_DATA_TRY_EXEC,           FALSE, TRUE },
+		{ NAFO_DATA_SHOW_IF_REGISTERED, FALSE, TRUE },
+		{ NAFO_DATA_SHOW_IF_TRUE,       FALSE, FALSE },
+		{ NAFO_DATA_SHOW_IF_RUNNING,    FALSE, FALSE },
+		{ NULL }
+};
+
+enum {
+	DYNAMIC_ITEMS_SLIST = 1 << 16,		/* a dynamic entry in the subitems list */
+	DYNAMIC_PROFILES    = 1 << 17,		/* at least one profile is dynamic */
+	DYNAMIC_COMPUTED    = 1 << 18,		/* the mask has been computed */
+};
+
+#define DYNAMIC_DATA					"caja-actions-dynamic-data"
+
 static GObjectClass *st_parent_class  = NULL;
 static GType         st_actions_type  = 0;
 static gint          st_burst_timeout = 100;		/* burst timeout in msec */
@@ -85,10 +126,16 @@ static GList            *menu_provider_get_toolbar_items( CajaMenuProvider *prov
 #endif
 
 static GList            *build_caja_menu( CajaActions *plugin, guint target, GList *selection );
-static GList            *build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *tokens );
+static GList            *build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *tokens, NAContextCache *cache, GHashTable *candidates );
+static GSList           *get_show_if_true_commands( GList *tree, guint target, GList *selection, NATokens *tokens, NAContextCache *cache, GHashTable *candidates );
+static GSList           *get_show_if_true_profile_command( NAObjectAction *action, guint target, GList *selection, NATokens *tokens, NAContextCache *cache, GSList *commands );
+static gboolean          has_dynamic_cheap_data( const NAObject *object );
+static gboolean          is_indexed_candidate( GHashTable *candidates, const NAObjectItem *item );
 static NAObjectItem     *expand_tokens_item( const NAObjectItem *item, NATokens *tokens );
-static void              expand_tokens_context( NAIContext *context, NATokens *tokens );
-static NAObjectProfile  *get_candidate_profile( NAObjectAction *action, guint target, GList *files );
+static void              expand_tokens_data( NAObject *object, guint dynamic, NATokens *tokens );
+static void              expand_tokens_string( NAObject *object, const gchar *name, NATokens *tokens, gboolean utf8 );
+static guint             get_dynamic_data( const NAObject *object );
+static NAObjectProfile  *get_candidate_profile( NAObjectAction *action, guint target, GList *files, NAContextCache *cache );
 static CajaMenuItem *create_item_from_profile( NAObjectProfile *profile, guint target, GList *files, NATokens *tokens );
 static CajaMenuItem *create_item_from_menu( NAObjectMenu *menu, GList *subitems, guint target );
 static CajaMenuItem *create_menu_item( const NAObjectItem *item, guint target );
@@ -105,6 +152,11 @@ static void              execute_about( CajaMenuItem *item, CajaActions *plugin
 static void              on_pivot_items_changed_handler( NAPivot *pivot, CajaActions *plugin );
 static void              on_settings_key_changed_handler( const gchar *group, const gchar *key, gconstpointer new_value, gboolean mandatory, CajaActions *plugin );
 static void              on_change_event_timeout( CajaActions *plugin );
+static void              on_items_loaded( CajaActions *plugin );
+static guint             get_required_attributes( GList *tree );
+static guint             get_required_fields( GList *tree );
+static guint             get_required_fields_context( NAIContext *context );
+static guint             set_dynamic_data( GList *tree );
 
 GType
 caja_actions_get_type( void )
@@ -183,6 +235,7 @@ instance_init( GTypeInstance *instance, gpointer klass )
 	self->private->change_timeout.handler = ( NATimeoutFunc ) on_change_event_timeout;
 	self->private->change_timeout.user_data = self;
 	self->private->change_timeout.source_id = 0;
+	self->private->settings_changed = FALSE;
 }
 
 /*
@@ -221,6 +274,7 @@ instance_constructed( GObject *object )
 		 */
 		na_pivot_set_loadable( priv->pivot, !PIVOT_LOAD_DISABLED & !PIVOT_LOAD_INVALID );
 		na_pivot_load_items( priv->pivot );
+		on_items_loaded( CAJA_ACTIONS( object ));
 
 		/* register against NAPivot to be notified of items changes
 		 */
@@ -350,7 +404,7 @@ menu_provider_get_background_items( CajaMenuProvider *provider, GtkWidget *windo
 
 	if( !CAJA_ACTIONS( provider )->private->dispose_has_run ){
 
-		selected = na_selected_info_get_list_from_item( current_folder );
+		selected = na_selected_info_get_list_from_item( current_folder, CAJA_ACTIONS( provider )->private->attributes );
 
 		if( selected ){
 			uri = caja_file_info_get_uri( current_folder );
@@ -395,7 +449,7 @@ menu_provider_get_file_items( CajaMenuProvider *provider, GtkWidget *window, GLi
 			return(( GList * ) NULL );
 		}
 
-		selected = na_selected_info_get_list_from_list(( GList * ) files );
+		selected = na_selected_info_get_list_from_list(( GList * ) files, CAJA_ACTIONS( provider )->private->attributes );
 
 		if( selected ){
 			g_debug( "%s: provider=%p, window=%p, files=%p, count=%d",
@@ -447,7 +501,7 @@ menu_provider_get_toolbar_items( CajaMenuProvider *provider, GtkWidget *window,
 
 	if( !CAJA_ACTIONS( provider )->private->dispose_has_run ){
 
-		selected = na_selected_info_get_list_from_item( current_folder );
+		selected = na_selected_info_get_list_from_item( current_folder, CAJA_ACTIONS( provider )->private->attributes );
 
 		if( selected ){
 			uri = caja_file_info_get_uri( current_folder );
@@ -490,17 +544,36 @@ build_caja_menu( CajaActions *plugin, guint target, GList *selection )
 {
 	GList *caja_menu;
 	NATokens *tokens;
+	NAContextCache *cache;
 	GList *tree;
+	GHashTable *candidates;
 	gboolean items_add_about_item;
 	gboolean items_create_root_menu;
 
 	g_return_val_if_fail( NA_IS_PIVOT( plugin->private->pivot ), NULL );
 
-	tokens = na_tokens_new_from_selection( selection );
+	tokens = na_tokens_new_from_selection_with_fields( selection, plugin->private->fields );
+
+	/* many items share the same conditions: evaluate each distinct
+	 * condition only once for this selection, and only once for each
+	 * distinct mimetype, scheme, dirname, etc. of the selected files
+	 */
+	cache = na_context_cache_new( selection );
 
 	tree = na_pivot_get_items( plugin->private->pivot );
 
-	caja_menu = build_caja_menu_rec( tree, target, selection, tokens );
+	/* most of the items are not relevant for a given selection: only
+	 * fully check those which are found in the index
+	 */
+	candidates = na_pivot_get_candidate_items( plugin->private->pivot, target, selection );
+
+	caja_menu = build_caja_menu_rec( tree, target, selection, tokens, cache, candidates );
+
+	na_context_cache_free( cache );
+
+	if( candidates ){
+		g_hash_table_destroy( candidates );
+	}
 
 	/* the NATokens object has been attached (and reffed) by each found
 	 * candidate profile, so it will be actually finalized only on actual
@@ -525,7 +598,7 @@ build_caja_menu( CajaActions *plugin, guint target, GList *selection )
 }
 
 static GList *
-build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *tokens )
+build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *tokens, NAContextCache *cache, GHashTable *candidates )
 {
 	static const gchar *thisfn = "caja_actions_build_caja_menu_rec";
 	GList *caja_menu;
@@ -535,32 +608,53 @@ build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *toke
 	GList *submenu;
 	NAObjectProfile *profile;
 	CajaMenuItem *menu_item;
-	gchar *label;
+	const gchar *label;
+	GSList *commands;
 
 	caja_menu = NULL;
 
+	/* run concurrently the ShowIfTrue commands which decide of the
+	 * visibility of the items of this level, so that we wait at most
+	 * once for the deadline
+	 * the commands of a submenu are only run when the menu itself has
+	 * been found candidate
+	 */
+	commands = get_show_if_true_commands( tree, target, selection, tokens, cache, candidates );
+	na_show_if_true_prefetch( commands );
+	na_core_utils_slist_free( commands );
+
 	for( it = tree ; it ; it = it->next ){
 
 		g_return_val_if_fail( NA_IS_OBJECT_ITEM( it->data ), NULL );
-		label = na_object_get_label( it->data );
+		label = na_object_peek_label( it->data );
 		g_debug( "%s: examining %s", thisfn, label );
 
-		if( !na_icontext_is_candidate( NA_ICONTEXT( it->data ), target, selection )){
-			g_debug( "%s: is not candidate (NAIContext): %s", thisfn, label );
-			g_free( label );
+		if( !is_indexed_candidate( candidates, NA_OBJECT_ITEM( it->data ))){
+			g_debug( "%s: is not candidate (index): %s", thisfn, label );
 			continue;
 		}
 
-		item = expand_tokens_item( NA_OBJECT_ITEM( it->data ), tokens );
+		if( !na_icontext_is_candidate_cached( NA_ICONTEXT( it->data ), target, selection, cache )){
+			g_debug( "%s: is not candidate (NAIContext): %s", thisfn, label );
+			continue;
+		}
 
-		/* but we have to re-check for validity as a label may become
-		 * dynamically empty - thus the NAObjectItem invalid :(
+		/* an item which does not embed any parameter is used as is
 		 */
-		if( !na_object_is_valid( item )){
-			g_debug( "%s: item %s becomes invalid after tokens expansion", thisfn, label );
-			g_object_unref( item );
-			g_free( label );
-			continue;
+		if( !( get_dynamic_data( NA_OBJECT( it->data )) & ~DYNAMIC_COMPUTED )){
+			item = NA_OBJECT_ITEM( g_object_ref( it->data ));
+
+		} else {
+			item = expand_tokens_item( NA_OBJECT_ITEM( it->data ), tokens );
+
+			/* but we have to re-check for validity as a label may become
+			 * dynamically empty - thus the NAObjectItem invalid :(
+			 */
+			if( !na_object_is_valid( item )){
+				g_debug( "%s: item %s becomes invalid after tokens expansion", thisfn, label );
+				g_object_unref( item );
+				continue;
+			}
 		}
 
 		/* recursively build sub-menus
@@ -572,7 +666,7 @@ build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *toke
 			subitems = na_object_get_items( NA_OBJECT( it->data ));
 			g_debug( "%s: menu has %d items", thisfn, g_list_length( subitems ));
 
-			submenu = build_caja_menu_rec( subitems, target, selection, tokens );
+			submenu = build_caja_menu_rec( subitems, target, selection, tokens, cache, candidates );
 			g_debug( "%s: submenu has %d items", thisfn, g_list_length( submenu ));
 
 			if( submenu ){
@@ -585,7 +679,6 @@ build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *toke
 				}
 			}
 			g_object_unref( item );
-			g_free( label );
 			continue;
 		}
 
@@ -593,7 +686,7 @@ build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *toke
 
 		/* if we have an action, searches for a candidate profile
 		 */
-		profile = get_candidate_profile( NA_OBJECT_ACTION( item ), target, selection );
+		profile = get_candidate_profile( NA_OBJECT_ACTION( item ), target, selection, cache );
 		if( profile ){
 			menu_item = create_item_from_profile( profile, target, selection, tokens );
 			caja_menu = g_list_append( caja_menu, menu_item );
@@ -603,12 +696,110 @@ build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *toke
 		}
 
 		g_object_unref( item );
-		g_free( label );
 	}
 
 	return( caja_menu );
 }
 
+/*
+ * get_show_if_true_commands:
+ *
+ * Returns: the list of the ShowIfTrue commands which will have to be run
+ * to decide of the visibility of the items of this level.
+ *
+ * As in build_caja_menu_rec(), the ShowIfTrue command of an item is
+ * only run if the item has succeeded to the cheap predicates. When the
+ * action has no ShowIfTrue command, the one of its first profile which
+ * may be candidate is run; the next profiles are only checked if this
+ * one is rejected, so their commands are left to the full check.
+ */
+static GSList *
+get_show_if_true_commands( GList *tree, guint target, GList *selection, NATokens *tokens, NAContextCache *cache, GHashTable *candidates )
+{
+	GSList *commands;
+	GList *it;
+	const gchar *command;
+
+	commands = NULL;
+
+	for( it = tree ; it ; it = it->next ){
+
+		if( !is_indexed_candidate( candidates, NA_OBJECT_ITEM( it->data )) ||
+				!na_icontext_is_candidate_cheap( NA_ICONTEXT( it->data ), target, selection, cache )){
+			continue;
+		}
+
+		command = na_object_peek_show_if_true( it->data );
+		if( command && strlen( command )){
+			commands = g_slist_prepend( commands, g_strdup( command ));
+
+		} else if( NA_IS_OBJECT_ACTION( it->data )){
+			commands = get_show_if_true_profile_command( NA_OBJECT_ACTION( it->data ), target, selection, tokens, cache, commands );
+		}
+	}
+
+	return( commands );
+}
+
+/*
+ * the profiles are checked after tokens expansion: a profile whose
+ * cheap conditions embed parameters cannot be checked here, and stops
+ * the search
+ */
+static GSList *
+get_show_if_true_profile_command( NAObjectAction *action, guint target, GList *selection, NATokens *tokens, NAContextCache *cache, GSList *commands )
+{
+	GList *ip;
+	const gchar *command;
+
+	for( ip = na_object_get_items( action ) ; ip ; ip = ip->next ){
+
+		if( has_dynamic_cheap_data( NA_OBJECT( ip->data ))){
+			break;
+		}
+
+		if( na_icontext_is_candidate_cheap( NA_ICONTEXT( ip->data ), target, selection, cache )){
+			command = na_object_peek_show_if_true( ip->data );
+			if( command && strlen( command )){
+				if( strchr( command, '%' )){
+					commands = g_slist_prepend( commands, na_tokens_parse_for_display( tokens, command, FALSE ));
+				} else {
+					commands = g_slist_prepend( commands, g_strdup( command ));
+				}
+			}
+			break;
+		}
+	}
+
+	return( commands );
+}
+
+static gboolean
+has_dynamic_cheap_data( const NAObject *object )
+{
+	guint dynamic, i;
+
+	dynamic = get_dynamic_data( object );
+
+	for( i = 0 ; st_dynamic_data[i].name ; ++i ){
+		if( st_dynamic_data[i].cheap && ( dynamic & ( 1 << i ))){
+			return( TRUE );
+		}
+	}
+
+	return( FALSE );
+}
+
+/*
+ * @candidates: the set of the items found in the index for the current
+ *  selection, or %NULL if the index is not available
+ */
+static gboolean
+is_indexed_candidate( GHashTable *candidates, const NAObjectItem *item )
+{
+	return( !candidates || g_hash_table_contains( candidates, item ));
+}
+
 /*
  * expand_tokens_item:
  * @item: a NAObjectItem read from the NAPivot.
@@ -622,154 +813,138 @@ build_caja_menu_rec( GList *tree, guint target, GList *selection, NATokens *toke
  * - the action and its profiles
  *
  * Returns: a duplicated object which has to be g_object_unref() by the caller.
+ *
+ * The duplicated object shares its data with @src: only the data which
+ * are actually modified by the expansion are allocated.
  */
 static NAObjectItem *
 expand_tokens_item( const NAObjectItem *src, NATokens *tokens )
 {
 	gchar *old, *new;
 	GSList *subitems_slist, *its, *new_slist;
-	GList *subitems, *it;
+	GList *subitems, *it, *isrc;
 	NAObjectItem *item;
 
 	item = NA_OBJECT_ITEM( na_object_duplicate( src, DUPLICATE_OBJECT ));
 
-	/* label, tooltip and icon name
-	 * plus the toolbar label if this is an action
+	/* label, tooltip and icon name, plus the toolbar label if this is
+	 * an action, and the conditions of the NAIContext
+	 * the mask of the dynamic data is read from the source object, as it
+	 * is not copied to the duplicate
 	 */
-	old = na_object_get_label( item );
-	new = na_tokens_parse_for_display( tokens, old, TRUE );
-	na_object_set_label( item, new );
-	g_free( old );
-	g_free( new );
-
-	old = na_object_get_tooltip( item );
-	new = na_tokens_parse_for_display( tokens, old, TRUE );
-	na_object_set_tooltip( item, new );
-	g_free( old );
-	g_free( new );
-
-	old = na_object_get_icon( item );
-	new = na_tokens_parse_for_display( tokens, old, TRUE );
-	na_object_set_icon( item, new );
-	g_free( old );
-	g_free( new );
-
-	if( NA_IS_OBJECT_ACTION( item )){
-		old = na_object_get_toolbar_label( item );
-		new = na_tokens_parse_for_display( tokens, old, TRUE );
-		na_object_set_toolbar_label( item, new );
-		g_free( old );
-		g_free( new );
-	}
-
-	/* A NAObjectItem, whether it is an action or a menu, is also a NAIContext
-	 */
-	expand_tokens_context( NA_ICONTEXT( item ), tokens );
+	expand_tokens_data( NA_OBJECT( item ), get_dynamic_data( NA_OBJECT( src )), tokens );
 
 	/* subitems lists, whether this is the profiles list of an action
 	 * or the items list of a menu, may be dynamic and embed a command;
 	 * this command itself may embed parameters
 	 */
-	subitems_slist = na_object_get_items_slist( item );
-	new_slist = NULL;
-	for( its = subitems_slist ; its ; its = its->next ){
-		old = ( gchar * ) its->data;
-		if( old[0] == '[' && old[strlen(old)-1] == ']' ){
-			new = na_tokens_parse_for_display( tokens, old, FALSE );
-		} else {
-			new = g_strdup( old );
+	if( get_dynamic_data( NA_OBJECT( src )) & DYNAMIC_ITEMS_SLIST ){
+		subitems_slist = na_object_peek_items_slist( item );
+		new_slist = NULL;
+		for( its = subitems_slist ; its ; its = its->next ){
+			old = ( gchar * ) its->data;
+			if( old[0] == '[' && old[strlen(old)-1] == ']' ){
+				new = na_tokens_parse_for_display( tokens, old, FALSE );
+			} else {
+				new = g_strdup( old );
+			}
+			new_slist = g_slist_prepend( new_slist, new );
 		}
-		new_slist = g_slist_prepend( new_slist, new );
+		na_object_set_items_slist( item, new_slist );
+		na_core_utils_slist_free( new_slist );
 	}
-	na_object_set_items_slist( item, new_slist );
-	na_core_utils_slist_free( subitems_slist );
-	na_core_utils_slist_free( new_slist );
 
 	/* last, deal with profiles of an action
+	 * desktop Exec key = MateConf path+parameters: do not touch them here
 	 */
 	if( NA_IS_OBJECT_ACTION( item )){
 
 		subitems = na_object_get_items( item );
+		isrc = na_object_get_items( src );
 
-		for( it = subitems ; it ; it = it->next ){
-
-			/* desktop Exec key = MateConf path+parameters
-			 * do not touch them here
-			 */
-			old = na_object_get_working_dir( it->data );
-			new = na_tokens_parse_for_display( tokens, old, FALSE );
-			na_object_set_working_dir( it->data, new );
-			g_free( old );
-			g_free( new );
-
-			/* a NAObjectProfile is also a NAIContext
-			 */
-			expand_tokens_context( NA_ICONTEXT( it->data ), tokens );
+		for( it = subitems ; it && isrc ; it = it->next, isrc = isrc->next ){
+			expand_tokens_data( NA_OBJECT( it->data ), get_dynamic_data( NA_OBJECT( isrc->data )), tokens );
 		}
 	}
 
 	return( item );
 }
 
+/*
+ * expand the data of the object which have been found to embed parameters
+ * @dynamic: the mask of these data
+ */
 static void
-expand_tokens_context( NAIContext *context, NATokens *tokens )
+expand_tokens_data( NAObject *object, guint dynamic, NATokens *tokens )
 {
-	gchar *old, *new;
+	guint i;
 
-	old = na_object_get_try_exec( context );
-	new = na_tokens_parse_for_display( tokens, old, FALSE );
-	na_object_set_try_exec( context, new );
-	g_free( old );
-	g_free( new );
+	for( i = 0 ; st_dynamic_data[i].name ; ++i ){
+		if( dynamic & ( 1 << i )){
+			expand_tokens_string( object, st_dynamic_data[i].name, tokens, st_dynamic_data[i].utf8 );
+		}
+	}
+}
 
-	old = na_object_get_show_if_registered( context );
-	new = na_tokens_parse_for_display( tokens, old, FALSE );
-	na_object_set_show_if_registered( context, new );
-	g_free( old );
-	g_free( new );
+/*
+ * only set the data when the expansion has actually modified it, so
+ * that the NADataBoxed stays shared with the original object
+ */
+static void
+expand_tokens_string( NAObject *object, const gchar *name, NATokens *tokens, gboolean utf8 )
+{
+	const gchar *old;
+	gchar *new;
 
-	old = na_object_get_show_if_true( context );
-	new = na_tokens_parse_for_display( tokens, old, FALSE );
-	na_object_set_show_if_true( context, new );
-	g_free( old );
-	g_free( new );
+	old = ( const gchar * ) na_ifactory_object_peek_as_void( NA_IFACTORY_OBJECT( object ), name );
+	new = na_tokens_parse_for_display( tokens, old, utf8 );
+
+	if( g_strcmp0( old, new )){
+		na_ifactory_object_set_from_void( NA_IFACTORY_OBJECT( object ), name, new );
+	}
 
-	old = na_object_get_show_if_running( context );
-	new = na_tokens_parse_for_display( tokens, old, FALSE );
-	na_object_set_show_if_running( context, new );
-	g_free( old );
 	g_free( new );
 }
 
+/*
+ * Returns: the mask of the dynamic data of the @object, or all bits set
+ * if it has not been computed (e.g. the object has not been loaded)
+ */
+static guint
+get_dynamic_data( const NAObject *object )
+{
+	guint dynamic;
+
+	dynamic = GPOINTER_TO_UINT( g_object_get_data( G_OBJECT( object ), DYNAMIC_DATA ));
+
+	return( dynamic & DYNAMIC_COMPUTED ? dynamic : G_MAXUINT );
+}
+
 /*
  * could also be a NAObjectAction method - but this is not used elsewhere
  */
 static NAObjectProfile *
-get_candidate_profile( NAObjectAction *action, guint target, GList *files )
+get_candidate_profile( NAObjectAction *action, guint target, GList *files, NAContextCache *cache )
 {
 	static const gchar *thisfn = "caja_actions_get_candidate_profile";
 	NAObjectProfile *candidate = NULL;
-	gchar *action_label;
-	gchar *profile_label;
+	const gchar *action_label;
 	GList *profiles, *ip;
 
-	action_label = na_object_get_label( action );
+	action_label = na_object_peek_label( action );
 	profiles = na_object_get_items( action );
 
 	for( ip = profiles ; ip && !candidate ; ip = ip->next ){
 		NAObjectProfile *profile = NA_OBJECT_PROFILE( ip->data );
 
-		if( na_icontext_is_candidate( NA_ICONTEXT( profile ), target, files )){
-			profile_label = na_object_get_label( profile );
-			g_debug( "%s: selecting %s (profile=%p '%s')", thisfn, action_label, ( void * ) profile, profile_label );
-			g_free( profile_label );
+		if( na_icontext_is_candidate_cached( NA_ICONTEXT( profile ), target, files, cache )){
+			g_debug( "%s: selecting %s (profile=%p '%s')",
+					thisfn, action_label, ( void * ) profile, na_object_peek_label( profile ));
 
 			candidate = profile;
 		}
 	}
 
-	g_free( action_label );
-
 	return( candidate );
 }
 
@@ -846,23 +1021,16 @@ static CajaMenuItem *
 create_menu_item( const NAObjectItem *item, guint target )
 {
 	CajaMenuItem *menu_item;
-	gchar *id, *name, *label, *tooltip, *icon;
+	gchar *name;
 
-	id = na_object_get_id( item );
-	name = g_strdup_printf( "%s-%s-%s-%d", PACKAGE, G_OBJECT_TYPE_NAME( item ), id, target );
-	label = na_object_get_label( item );
-	tooltip = na_object_get_tooltip( item );
-	icon = na_object_get_icon( item );
+	name = g_strdup_printf( "%s-%s-%s-%d", PACKAGE, G_OBJECT_TYPE_NAME( item ), na_object_peek_id( item ), target );
 
-	menu_item = caja_menu_item_new( name, label, tooltip, icon );
+	menu_item = caja_menu_item_new( name,
+			na_object_peek_label( item ), na_object_peek_tooltip( item ), na_object_peek_icon( item ));
 
 	g_object_weak_ref( G_OBJECT( menu_item ), ( GWeakNotify ) weak_notify_menu_item, NULL );
 
-	g_free( icon );
- 	g_free( tooltip );
- 	g_free( label );
  	g_free( name );
- 	g_free( id );
 
 	return( menu_item );
 }
@@ -1039,19 +1207,190 @@ on_settings_key_changed_handler( const gchar *group, const gchar *key, gconstpoi
 
 	if( !plugin->private->dispose_has_run ){
 
+		plugin->private->settings_changed = TRUE;
 		na_timeout_event( &plugin->private->change_timeout );
 	}
 }
 
 /*
  * automatically reloads the items, then signal the file manager.
+ * the file manager is not signaled if neither the items nor the
+ * preferences have changed, e.g. when only the timestamps of the
+ * .desktop files have been updated
  */
 static void
 on_change_event_timeout( CajaActions *plugin )
 {
 	static const gchar *thisfn = "caja_actions_on_change_event_timeout";
+	gboolean changed;
+
 	g_debug( "%s: timeout expired", thisfn );
 
-	na_pivot_load_items( plugin->private->pivot );
-	caja_menu_provider_emit_items_updated_signal( CAJA_MENU_PROVIDER( plugin ));
+	changed = na_pivot_load_items( plugin->private->pivot );
+
+	if( changed || plugin->private->settings_changed ){
+		plugin->private->settings_changed = FALSE;
+		on_items_loaded( plugin );
+
+		caja_menu_provider_emit_items_updated_signal( CAJA_MENU_PROVIDER( plugin ));
+
+	} else {
+		g_debug( "%s: items are unchanged", thisfn );
+	}
+}
+
+/*
+ * items have just been (re)loaded: compute what the menus will need,
+ * and prewarm what may be computed once for all
+ */
+static void
+on_items_loaded( CajaActions *plugin )
+{
+	GList *tree;
+
+	tree = na_pivot_get_items( plugin->private->pivot );
+
+	plugin->private->attributes = get_required_attributes( tree );
+	plugin->private->fields = get_required_fields( tree );
+
+	set_dynamic_data( tree );
+
+	na_try_exec_prewarm( tree );
+}
+
+/*
+ * the file attributes which have to be queried for the selected items
+ * are those needed to evaluate the conditions of at least one of the
+ * loaded menus, actions or profiles
+ */
+static guint
+get_required_attributes( GList *tree )
+{
+	guint attributes;
+	GList *it;
+
+	attributes = 0;
+
+	for( it = tree ; it ; it = it->next ){
+		attributes |= na_context_program_get_required_attributes( NA_ICONTEXT( it->data ));
+
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			attributes |= get_required_attributes( na_object_get_items( it->data ));
+		}
+	}
+
+	return( attributes );
+}
+
+/*
+ * the tokens fields which have to be gathered from the selection
+ * in order to expand the parameters of the loaded items
+ */
+static guint
+get_required_fields( GList *tree )
+{
+	guint fields;
+	GList *it;
+	GSList *subitems_slist, *its;
+
+	fields = 0;
+
+	for( it = tree ; it ; it = it->next ){
+
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			fields |= na_tokens_get_fields( na_object_peek_label( it->data ));
+
+			fields |= na_tokens_get_fields( na_object_peek_tooltip( it->data ));
+
+			fields |= na_tokens_get_fields( na_object_peek_icon( it->data ));
+
+			if( NA_IS_OBJECT_ACTION( it->data )){
+				fields |= na_tokens_get_fields( na_object_peek_toolbar_label( it->data ));
+			}
+
+			subitems_slist = na_object_peek_items_slist( it->data );
+			for( its = subitems_slist ; its ; its = its->next ){
+				fields |= na_tokens_get_fields(( const gchar * ) its->data );
+			}
+
+			fields |= get_required_fields( na_object_get_items( it->data ));
+
+		} else if( NA_IS_OBJECT_PROFILE( it->data )){
+			fields |= na_tokens_get_fields( na_object_peek_path( it->data ));
+
+			fields |= na_tokens_get_fields( na_object_peek_parameters( it->data ));
+
+			fields |= na_tokens_get_fields( na_object_peek_working_dir( it->data ));
+		}
+
+		fields |= get_required_fields_context( NA_ICONTEXT( it->data ));
+	}
+
+	return( fields );
+}
+
+static guint
+get_required_fields_context( NAIContext *context )
+{
+	guint fields;
+
+	fields = na_tokens_get_fields( na_object_peek_try_exec( context ));
+
+	fields |= na_tokens_get_fields( na_object_peek_show_if_registered( context ));
+
+	fields |= na_tokens_get_fields( na_object_peek_show_if_true( context ));
+
+	fields |= na_tokens_get_fields( na_object_peek_show_if_running( context ));
+
+	return( fields );
+}
+
+/*
+ * compute and attach the mask of the dynamic data of each item and
+ * profile of the @tree
+ *
+ * Returns: the mask of the dynamic data of the whole tree.
+ */
+static guint
+set_dynamic_data( GList *tree )
+{
+	guint all, dynamic, i;
+	GList *it;
+	GSList *subitems_slist, *its;
+	const gchar *value;
+
+	all = 0;
+
+	for( it = tree ; it ; it = it->next ){
+		dynamic = 0;
+
+		for( i = 0 ; st_dynamic_data[i].name ; ++i ){
+			value = ( const gchar * ) na_ifactory_object_peek_as_void( NA_IFACTORY_OBJECT( it->data ), st_dynamic_data[i].name );
+			if( value && strchr( value, '%' )){
+				dynamic |= ( 1 << i );
+			}
+		}
+
+		if( NA_IS_OBJECT_ITEM( it->data )){
+			subitems_slist = na_object_peek_items_slist( it->data );
+			for( its = subitems_slist ; its ; its = its->next ){
+				value = ( const gchar * ) its->data;
+				if( value[0] == '[' && value[strlen( value )-1] == ']' ){
+					dynamic |= DYNAMIC_ITEMS_SLIST;
+				}
+			}
+
+			/* the submenus are built from the original items, while the
+			 * profiles of an action are expanded with it
+			 */
+			if( set_dynamic_data( na_object_get_items( it->data )) && NA_IS_OBJECT_ACTION( it->data )){
+				dynamic |= DYNAMIC_PROFILES;
+			}
+		}
+
+		g_object_set_data( G_OBJECT( it->data ), DYNAMIC_DATA, GUINT_TO_POINTER( dynamic | DYNAMIC_COMPUTED ));
+		all |= dynamic;
+	}
+
+	return( all );
 }
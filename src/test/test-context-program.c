@@ -0,0 +1,589 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+/*
+ * Checks the compiled Basenames and Folders conditions against the
+ * previous implementation, which matched each selected file against
+ * each pattern with g_pattern_match_simple() and g_str_has_prefix().
+ *
+ * The Folders conditions are also checked while the programs are
+ * released and compiled again, so that the patterns are removed from
+ * and added back to the shared folders index, both with and without a
+ * selection cache.
+ *
+ * The selected files are created in a temporary directory; a '~' in
+ * the Folders conditions below stands for this directory.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <api/na-core-utils.h>
+#include <api/na-object-api.h>
+
+#include <core/na-context-program.h>
+#include <core/na-selected-info.h>
+
+/* the files against which the Basenames conditions are checked
+ */
+static const gchar *names[] = {
+		"archive.tar.gz",
+		"ARCHIVE.TAR.GZ",
+		"Archive.Tar.Gz",
+		".tar.gz",
+		"tar.gz",
+		"gz",
+		"notes.txt",
+		"file1.txt",
+		"file10.txt",
+		"main.c",
+		"main.o",
+		"README",
+		"readme",
+		"Makefile",
+		"Makefile.am",
+		"Makefile.in",
+		"xaybz",
+		"été.txt",
+		"Été.txt",
+		NULL
+};
+
+/* semicolon-separated lists of patterns, each of them being checked
+ * with and without matchcase
+ */
+static const gchar *basenames[] = {
+		"*.tar.gz",
+		"*.TAR.GZ",
+		"*.txt;*.c;README",
+		"*;!*.o",
+		"!*.tar.gz",
+		"*.gz;!*.tar.gz",
+		"file?.txt",
+		"Makefile;*.am;!Makefile.in",
+		"*a*b*",
+		"é*.txt",
+		"*.tar.gz;*.TAR.GZ;!*.Tar.Gz",
+		"*",
+		NULL
+};
+
+/* the directories, relative to the temporary directory, where a file
+ * is created; a file is also created in the temporary directory itself
+ */
+static const gchar *dirs[] = {
+		"home",
+		"home/user",
+		"home/user/docs",
+		"home/user/private",
+		"home/user/private/keys",
+		"homeless",
+		"tmp",
+		"tmp/x",
+		"usr",
+		"usr/share",
+		"srv/project/src",
+		NULL
+};
+
+static const gchar *folders[] = {
+		"~/home",
+		"~/home/",
+		"~/home/user",
+		"~/home/user/",
+		"~/home/user/docs/",
+		"!~/tmp",
+		"~/home;!~/home/user/private/",
+		"!~/home/;!~/usr",
+		"~/home/*/docs",
+		"~/usr/*",
+		"*/src",
+		"~/ho",
+		"~/",
+		"~/;!~/tmp/",
+		"/nonexistent/",
+		"/",
+		NULL
+};
+
+static GList      *create_files( const gchar *dir, const gchar **names );
+static GSList     *get_conditions( const gchar *conditions, const gchar *root );
+static gboolean    baseline_basenames( GSList *basenames, gboolean matchcase, GList *files );
+static gboolean    baseline_folders( GSList *folders, GList *files );
+static gboolean    is_positive_assertion( const gchar *assertion );
+static guint       check_basenames( GList *files );
+static NAIContext *new_folders_context( const gchar *conditions, const gchar *root );
+static guint       check_folders( NAIContext **contexts, GList *files, NAContextCache *cache );
+static guint       check_condition( NAIContext *context, guint cond, gboolean expected, GList *files, NAContextCache *cache );
+static void        remove_tree( const gchar *path );
+
+int
+main( int argc, char** argv )
+{
+	gchar *root, *dir;
+	GError *error;
+	GList *files, *dir_files;
+	const gchar *file_names[] = { "file", NULL };
+	NAIContext *contexts[G_N_ELEMENTS( folders )];
+	NAContextCache *cache;
+	guint i, errors;
+
+#if !GLIB_CHECK_VERSION( 2,36, 0 )
+	g_type_init();
+#endif
+
+	g_printf( "Compiled conditions test.\n\n" );
+
+	error = NULL;
+	root = g_dir_make_tmp( "na-context-XXXXXX", &error );
+	if( !root ){
+		g_printerr( "%s\n", error->message );
+		g_error_free( error );
+		return( EXIT_FAILURE );
+	}
+
+	/* the Basenames conditions
+	 */
+	dir = g_build_filename( root, "names", NULL );
+	g_mkdir( dir, 0750 );
+	files = create_files( dir, names );
+	g_free( dir );
+
+	errors = check_basenames( files );
+	g_printf( "Basenames: %u condition(s) checked against %u files: %u error(s)\n",
+			g_strv_length(( gchar ** ) basenames ), g_list_length( files ), errors );
+	g_list_free_full( files, ( GDestroyNotify ) g_object_unref );
+
+	/* the Folders conditions
+	 */
+	files = create_files( root, file_names );
+	for( i = 0 ; dirs[i] ; ++i ){
+		dir = g_build_filename( root, dirs[i], NULL );
+		g_mkdir_with_parents( dir, 0750 );
+		dir_files = create_files( dir, file_names );
+		files = g_list_concat( files, dir_files );
+		g_free( dir );
+	}
+
+	for( i = 0 ; folders[i] ; ++i ){
+		contexts[i] = new_folders_context( folders[i], root );
+	}
+	contexts[i] = NULL;
+
+	cache = na_context_cache_new( files );
+	i = check_folders( contexts, files, cache );
+	g_printf( "Folders: %u condition(s) checked against %u dirnames: %u error(s)\n",
+			g_strv_length(( gchar ** ) folders ), g_list_length( files ), i );
+	errors += i;
+
+	/* release one program out of two, so that their patterns are
+	 * removed from the index, while the cache is kept
+	 */
+	for( i = 0 ; folders[i] ; i += 2 ){
+		g_object_unref( contexts[i] );
+		contexts[i] = new_folders_context( "~/unused/", root );
+	}
+	i = check_folders( contexts, files, cache );
+	g_printf( "Folders: after the release of half of the programs: %u error(s)\n", i );
+	errors += i;
+
+	/* compile them again
+	 */
+	for( i = 0 ; folders[i] ; i += 2 ){
+		g_object_unref( contexts[i] );
+		contexts[i] = new_folders_context( folders[i], root );
+	}
+	i = check_folders( contexts, files, cache );
+	g_printf( "Folders: after they have been compiled again: %u error(s)\n", i );
+	errors += i;
+
+	/* release all the programs, so that the index is emptied, before
+	 * compiling them again
+	 */
+	for( i = 0 ; folders[i] ; ++i ){
+		g_object_unref( contexts[i] );
+	}
+	for( i = 0 ; folders[i] ; ++i ){
+		contexts[i] = new_folders_context( folders[i], root );
+	}
+	i = check_folders( contexts, files, cache );
+	g_printf( "Folders: after the release of all the programs: %u error(s)\n", i );
+	errors += i;
+
+	for( i = 0 ; folders[i] ; ++i ){
+		g_object_unref( contexts[i] );
+	}
+	na_context_cache_free( cache );
+	g_list_free_full( files, ( GDestroyNotify ) g_object_unref );
+
+	remove_tree( root );
+	g_free( root );
+
+	return( errors ? EXIT_FAILURE : EXIT_SUCCESS );
+}
+
+/*
+ * creates an empty file for each of the @names in @dir, and returns
+ * the list of the corresponding NASelectedInfo's
+ */
+static GList *
+create_files( const gchar *dir, const gchar **names )
+{
+	GList *files;
+	gchar *path, *uri, *errmsg;
+	guint i;
+
+	files = NULL;
+
+	for( i = 0 ; names[i] ; ++i ){
+		path = g_build_filename( dir, names[i], NULL );
+		g_file_set_contents( path, "", 0, NULL );
+		uri = g_filename_to_uri( path, NULL, NULL );
+
+		errmsg = NULL;
+		files = g_list_prepend( files, na_selected_info_create_for_uri( uri, NULL, &errmsg ));
+		if( errmsg ){
+			g_printerr( "%s: %s\n", uri, errmsg );
+			g_free( errmsg );
+		}
+
+		g_free( uri );
+		g_free( path );
+	}
+
+	return( g_list_reverse( files ));
+}
+
+/*
+ * Returns: the list of the semicolon-separated @conditions, where '~'
+ * is replaced with @root, as a #GSList which should be
+ * na_core_utils_slist_free() by the caller.
+ */
+static GSList *
+get_conditions( const gchar *conditions, const gchar *root )
+{
+	gchar **parts;
+	gchar *text;
+	GSList *list;
+
+	parts = g_strsplit( conditions, "~", -1 );
+	text = g_strjoinv( root, parts );
+	list = na_core_utils_slist_from_split( text, ";" );
+	g_free( text );
+	g_strfreev( parts );
+
+	return( list );
+}
+
+/*
+ * the previous is_candidate_for_basenames() of na-icontext.c
+ */
+static gboolean
+baseline_basenames( GSList *basenames, gboolean matchcase, GList *files )
+{
+	gboolean ok = TRUE;
+	GSList *ib;
+	GList *it;
+	gchar *tmp;
+
+	if( basenames ){
+		if( strcmp( basenames->data, "*" ) != 0 || g_slist_length( basenames ) > 1 ){
+
+			for( it = files ; it && ok ; it = it->next ){
+				gchar *pattern, *bname, *bname_utf8;
+				gboolean match, positive;
+				gchar *pattern_utf8;
+
+				bname = na_selected_info_get_basename( NA_SELECTED_INFO( it->data ));
+				bname_utf8 = g_filename_to_utf8( bname, -1, NULL, NULL, NULL );
+				if( !matchcase ){
+					tmp = g_utf8_strdown( bname_utf8, -1 );
+					g_free( bname_utf8 );
+					bname_utf8 = tmp;
+				}
+				match = FALSE;
+
+				for( ib = basenames ; ib && ok ; ib = ib->next ){
+					pattern = matchcase ?
+						g_strdup(( gchar * ) ib->data ) :
+						g_utf8_strdown(( gchar * ) ib->data, -1 );
+					positive = is_positive_assertion( pattern );
+					pattern_utf8 = g_filename_to_utf8( positive ? pattern : pattern+1, -1, NULL, NULL, NULL );
+
+					if( !positive || !match ){
+						if( g_pattern_match_simple( pattern_utf8, bname_utf8 )){
+							if( positive ){
+								match = TRUE;
+							} else {
+								ok = FALSE;
+							}
+						}
+					}
+
+					g_free( pattern_utf8 );
+					g_free( pattern );
+				}
+
+				if( !match ){
+					ok = FALSE;
+				}
+
+				g_free( bname_utf8 );
+				g_free( bname );
+			}
+		}
+	}
+
+	return( ok );
+}
+
+/*
+ * the previous is_candidate_for_folders() of na-icontext.c
+ */
+static gboolean
+baseline_folders( GSList *folders, GList *files )
+{
+	gboolean ok = TRUE;
+
+	if( folders ){
+		if( strcmp( folders->data, "/" ) != 0 || g_slist_length( folders ) > 1 ){
+			GSList *distincts = NULL;
+			GList *it;
+
+			for( it = files ; it && ok ; it = it->next ){
+				gchar *dirname = na_selected_info_get_dirname( NA_SELECTED_INFO( it->data ));
+
+				if( na_core_utils_slist_count( distincts, dirname ) == 0 ){
+					GSList *id;
+					gchar *dirname_utf8, *pattern_utf8;
+					const gchar *pattern;
+					gboolean match, positive;
+					gboolean has_pattern;
+
+					distincts = g_slist_prepend( distincts, g_strdup( dirname ));
+					dirname_utf8 = g_filename_to_utf8( dirname, -1, NULL, NULL, NULL );
+
+					for( id = folders ; id && ok ; id = id->next ){
+						pattern = ( const gchar * ) id->data;
+						positive = is_positive_assertion( pattern );
+						pattern_utf8 = g_filename_to_utf8( positive ? pattern : pattern+1, -1, NULL, NULL, NULL );
+						has_pattern = ( g_strstr_len( pattern_utf8, -1, "*" ) != NULL );
+
+						match = ( has_pattern && g_pattern_match_simple( pattern_utf8, dirname_utf8 )) ||
+								g_str_has_prefix( dirname_utf8, pattern_utf8 );
+
+						ok &= ( match && positive ) || ( !match && !positive );
+
+						g_free( pattern_utf8 );
+					}
+
+					g_free( dirname_utf8 );
+				}
+
+				g_free( dirname );
+			}
+
+			na_core_utils_slist_free( distincts );
+		}
+	}
+
+	return( ok );
+}
+
+static gboolean
+is_positive_assertion( const gchar *assertion )
+{
+	gboolean positive = TRUE;
+
+	if( assertion ){
+		gchar *dupped = g_strdup( assertion );
+		const gchar *stripped = g_strstrip( dupped );
+		if( stripped ){
+			positive = ( stripped[0] != '!' );
+		}
+		g_free( dupped );
+	}
+
+	return( positive );
+}
+
+/*
+ * each condition is checked against each file, and against the whole
+ * list of files, with and without matchcase
+ */
+static guint
+check_basenames( GList *files )
+{
+	NAObjectProfile *profile;
+	GSList *conditions;
+	GList *it, *single;
+	NAContextCache *cache;
+	gboolean matchcase;
+	guint i, m, errors;
+
+	errors = 0;
+	cache = na_context_cache_new( files );
+
+	for( i = 0 ; basenames[i] ; ++i ){
+		conditions = na_core_utils_slist_from_split( basenames[i], ";" );
+
+		for( m = 0 ; m < 2 ; ++m ){
+			matchcase = ( m == 0 );
+			profile = na_object_profile_new_with_defaults();
+			na_object_set_basenames( profile, conditions );
+			na_object_set_matchcase( profile, matchcase );
+
+			for( it = files ; it ; it = it->next ){
+				single = g_list_append( NULL, it->data );
+				errors += check_condition( NA_ICONTEXT( profile ), NA_CONTEXT_COND_BASENAMES,
+						baseline_basenames( conditions, matchcase, single ), single, NULL );
+				g_list_free( single );
+			}
+
+			errors += check_condition( NA_ICONTEXT( profile ), NA_CONTEXT_COND_BASENAMES,
+					baseline_basenames( conditions, matchcase, files ), files, cache );
+
+			g_object_unref( profile );
+		}
+
+		na_core_utils_slist_free( conditions );
+	}
+
+	na_context_cache_free( cache );
+
+	return( errors );
+}
+
+static NAIContext *
+new_folders_context( const gchar *conditions, const gchar *root )
+{
+	NAObjectProfile *profile;
+	GSList *list;
+
+	profile = na_object_profile_new_with_defaults();
+	list = get_conditions( conditions, root );
+	na_object_set_folders( profile, list );
+	na_core_utils_slist_free( list );
+
+	/* compile the program now, so that its patterns are indexed
+	 */
+	na_context_program_get( NA_ICONTEXT( profile ));
+
+	return( NA_ICONTEXT( profile ));
+}
+
+/*
+ * each context is checked against each file, and against the whole
+ * list of files
+ */
+static guint
+check_folders( NAIContext **contexts, GList *files, NAContextCache *cache )
+{
+	GSList *conditions;
+	GList *it, *single;
+	guint i, errors;
+
+	errors = 0;
+
+	for( i = 0 ; contexts[i] ; ++i ){
+		conditions = na_object_get_folders( contexts[i] );
+
+		for( it = files ; it ; it = it->next ){
+			single = g_list_append( NULL, it->data );
+			errors += check_condition( contexts[i], NA_CONTEXT_COND_FOLDERS,
+					baseline_folders( conditions, single ), single, NULL );
+			g_list_free( single );
+		}
+
+		errors += check_condition( contexts[i], NA_CONTEXT_COND_FOLDERS,
+				baseline_folders( conditions, files ), files, cache );
+
+		na_core_utils_slist_free( conditions );
+	}
+
+	return( errors );
+}
+
+/*
+ * Returns: 1 if the compiled @cond condition of @context does not give
+ * the @expected result for @files, zero else.
+ */
+static guint
+check_condition( NAIContext *context, guint cond, gboolean expected, GList *files, NAContextCache *cache )
+{
+	gboolean got;
+	gchar *text;
+	GSList *conditions;
+
+	got = na_context_program_is_candidate_for( na_context_program_get( context ), cond, files, cache );
+
+	if( got == expected ){
+		return( 0 );
+	}
+
+	conditions = ( cond == NA_CONTEXT_COND_BASENAMES ) ?
+			na_object_get_basenames( context ) : na_object_get_folders( context );
+	text = na_core_utils_slist_to_text( conditions );
+	g_printf( "%s (matchcase=%s) against %s%s: got %s, expected %s\n",
+			text, na_object_get_matchcase( context ) ? "True":"False",
+			na_selected_info_peek_uri( NA_SELECTED_INFO( files->data )), files->next ? ", ..." : "",
+			got ? "True":"False", expected ? "True":"False" );
+	g_free( text );
+	na_core_utils_slist_free( conditions );
+
+	return( 1 );
+}
+
+static void
+remove_tree( const gchar *path )
+{
+	GDir *dir;
+	const gchar *name;
+	gchar *child;
+
+	if( g_file_test( path, G_FILE_TEST_IS_DIR )){
+		dir = g_dir_open( path, 0, NULL );
+		if( dir ){
+			while(( name = g_dir_read_name( dir )) != NULL ){
+				child = g_build_filename( path, name, NULL );
+				remove_tree( child );
+				g_free( child );
+			}
+			g_dir_close( dir );
+		}
+	}
+
+	g_remove( path );
+}
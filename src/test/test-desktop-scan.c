@@ -0,0 +1,324 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+/*
+ * Times the load of the items from synthetic trees of .desktop files,
+ * spread over several XDG data directories, so that the growth of the
+ * scan with the count of files can be checked.
+ *
+ * As GLib reads the XDG directories only once, each size is measured
+ * in a child process, which is run with the XDG environment variables
+ * pointing to the generated tree.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <core/na-pivot.h>
+
+#define DIRS_COUNT					4
+
+static const guint sizes[] = { 1250, 2500, 5000, 10000, 0 };
+
+static gint count = 0;
+
+static GOptionEntry entries[] = {
+
+	{ "count", 'c', 0, G_OPTION_ARG_INT, &count,
+			"Load the items from the current XDG directories, which hold this count of files", "<N>" },
+	{ NULL }
+};
+
+static gdouble  measure( const gchar *prgname, guint size );
+static void     generate_tree( const gchar *root, guint size );
+static void     write_desktop_file( const gchar *dir, guint i );
+static gchar  **get_environment( const gchar *root );
+static void     remove_tree( const gchar *path );
+static void     load_items( guint size );
+
+int
+main( int argc, char **argv )
+{
+	GOptionContext *context;
+	GError *error;
+	gdouble elapsed, first;
+	guint i;
+
+#if !GLIB_CHECK_VERSION( 2,36, 0 )
+	g_type_init();
+#endif
+
+	context = g_option_context_new( "- time the scan of the .desktop files" );
+	g_option_context_add_main_entries( context, entries, NULL );
+	error = NULL;
+	if( !g_option_context_parse( context, &argc, &argv, &error )){
+		g_printerr( "%s\n", error->message );
+		g_error_free( error );
+		return( EXIT_FAILURE );
+	}
+	g_option_context_free( context );
+
+	if( count > 0 ){
+		load_items( count );
+		return( EXIT_SUCCESS );
+	}
+
+	g_printf( "Desktop files scan test (%d directories).\n\n", DIRS_COUNT );
+	first = 0;
+
+	for( i = 0 ; sizes[i] ; ++i ){
+		elapsed = measure( argv[0], sizes[i] );
+		if( elapsed < 0 ){
+			return( EXIT_FAILURE );
+		}
+		if( !first ){
+			first = elapsed / sizes[0];
+		}
+		g_printf( "files=%5u: reload=%8.1f ms, per file=%6.2f us, ratio to %u files=%.2f\n",
+				sizes[i], elapsed, 1000 * elapsed / sizes[i], sizes[0],
+				first > 0 ? ( elapsed / sizes[i] ) / first : 0 );
+	}
+
+	return( EXIT_SUCCESS );
+}
+
+/*
+ * Returns: the elapsed time of the reload in the child, in msec, or -1
+ */
+static gdouble
+measure( const gchar *prgname, guint size )
+{
+	gchar *root, *output, *arg, *end;
+	gchar **envp;
+	gchar *argv[4];
+	GError *error;
+	gint status;
+	gdouble elapsed;
+
+	error = NULL;
+	root = g_dir_make_tmp( "test-desktop-scan-XXXXXX", &error );
+	if( !root ){
+		g_printerr( "%s\n", error->message );
+		g_error_free( error );
+		return( -1 );
+	}
+
+	generate_tree( root, size );
+	envp = get_environment( root );
+
+	arg = g_strdup_printf( "%u", size );
+	argv[0] = ( gchar * ) prgname;
+	argv[1] = "--count";
+	argv[2] = arg;
+	argv[3] = NULL;
+
+	elapsed = -1;
+	output = NULL;
+
+	if( !g_spawn_sync( NULL, argv, envp, 0, NULL, NULL, &output, NULL, &status, &error )){
+		g_printerr( "%s\n", error->message );
+		g_error_free( error );
+
+	} else if( status != 0 || !output ){
+		g_printerr( "%s: child has failed (status=%d)\n", prgname, status );
+
+	} else {
+		elapsed = g_ascii_strtod( output, &end );
+		if( end == output ){
+			elapsed = -1;
+		}
+	}
+
+	g_free( output );
+	g_free( arg );
+	g_strfreev( envp );
+	remove_tree( root );
+	g_free( root );
+
+	return( elapsed );
+}
+
+/*
+ * the files are spread over the directories, and one file out of ten
+ * is also found with the same id in the next directory, so that the
+ * already loaded ids have to be skipped
+ */
+static void
+generate_tree( const gchar *root, guint size )
+{
+	gchar *dirs[DIRS_COUNT];
+	gchar *data;
+	guint i;
+
+	for( i = 0 ; i < DIRS_COUNT ; ++i ){
+		data = g_strdup_printf( "data%u", i );
+		dirs[i] = g_build_filename( root, data, "file-manager", "actions", NULL );
+		g_mkdir_with_parents( dirs[i], 0700 );
+		g_free( data );
+	}
+
+	for( i = 0 ; i < size ; ++i ){
+		write_desktop_file( dirs[i % DIRS_COUNT], i );
+		if( i % 10 == 0 ){
+			write_desktop_file( dirs[( i+1 ) % DIRS_COUNT], i );
+		}
+	}
+
+	for( i = 0 ; i < DIRS_COUNT ; ++i ){
+		g_free( dirs[i] );
+	}
+}
+
+static void
+write_desktop_file( const gchar *dir, guint i )
+{
+	gchar *bname, *path, *content;
+
+	bname = g_strdup_printf( "test-action-%05u.desktop", i );
+	path = g_build_filename( dir, bname, NULL );
+	content = g_strdup_printf(
+			"[Desktop Entry]\n"
+			"Type=Action\n"
+			"Name=Test action %u\n"
+			"Profiles=profile-zero;\n"
+			"\n"
+			"[X-Action-Profile profile-zero]\n"
+			"Name=Default profile\n"
+			"Exec=echo %%f\n"
+			"MimeTypes=text/*;\n", i );
+
+	g_file_set_contents( path, content, -1, NULL );
+
+	g_free( content );
+	g_free( path );
+	g_free( bname );
+}
+
+/*
+ * the cache and the configuration are also redirected, so that the
+ * first load is a full scan and parse, whatever be the user setup
+ */
+static gchar **
+get_environment( const gchar *root )
+{
+	gchar **envp;
+	gchar *value, *dir;
+	GString *dirs;
+	guint i;
+
+	envp = g_get_environ();
+
+	value = g_build_filename( root, "data0", NULL );
+	envp = g_environ_setenv( envp, "XDG_DATA_HOME", value, TRUE );
+	g_free( value );
+
+	dirs = g_string_new( "" );
+	for( i = 1 ; i < DIRS_COUNT ; ++i ){
+		dir = g_strdup_printf( "data%u", i );
+		value = g_build_filename( root, dir, NULL );
+		g_string_append_printf( dirs, "%s%s", i > 1 ? G_SEARCHPATH_SEPARATOR_S : "", value );
+		g_free( value );
+		g_free( dir );
+	}
+	envp = g_environ_setenv( envp, "XDG_DATA_DIRS", dirs->str, TRUE );
+	g_string_free( dirs, TRUE );
+
+	value = g_build_filename( root, "cache", NULL );
+	envp = g_environ_setenv( envp, "XDG_CACHE_HOME", value, TRUE );
+	g_free( value );
+
+	value = g_build_filename( root, "config", NULL );
+	envp = g_environ_setenv( envp, "XDG_CONFIG_HOME", value, TRUE );
+	g_free( value );
+
+	return( envp );
+}
+
+static void
+remove_tree( const gchar *path )
+{
+	GDir *dir;
+	const gchar *name;
+	gchar *child;
+
+	if( g_file_test( path, G_FILE_TEST_IS_DIR )){
+		dir = g_dir_open( path, 0, NULL );
+		if( dir ){
+			while(( name = g_dir_read_name( dir )) != NULL ){
+				child = g_build_filename( path, name, NULL );
+				remove_tree( child );
+				g_free( child );
+			}
+			g_dir_close( dir );
+		}
+	}
+
+	g_remove( path );
+}
+
+/*
+ * this is run in the child: the first load scans and parses all the
+ * files, while the reload only scans them again, the parsed items
+ * being kept in memory; the elapsed time of the reload, in msec, is
+ * output first, so that it can be read back by the parent
+ */
+static void
+load_items( guint size )
+{
+	NAPivot *pivot;
+	GTimer *timer;
+	gdouble first, reload;
+	guint loaded;
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	pivot = na_pivot_new();
+	na_pivot_set_loadable( pivot, PIVOT_LOAD_ALL );
+
+	timer = g_timer_new();
+	na_pivot_load_items( pivot );
+	first = 1000 * g_timer_elapsed( timer, NULL );
+
+	g_timer_start( timer );
+	na_pivot_load_items( pivot );
+	reload = 1000 * g_timer_elapsed( timer, NULL );
+
+	loaded = g_list_length( na_pivot_get_items( pivot ));
+
+	g_printf( "%s\n", g_ascii_formatd( buf, sizeof( buf ), "%.3f", reload ));
+	g_printerr( "files=%u: items=%u, first load=%.1f ms, reload=%.1f ms\n", size, loaded, first, reload );
+
+	g_timer_destroy( timer );
+	g_object_unref( pivot );
+}
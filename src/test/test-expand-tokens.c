@@ -0,0 +1,639 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+
+/*
+ * Checks the expansion of the parameters of the command-lines against
+ * the previous implementation, which walked the GSList's of the tokens
+ * for each parameter, and times it for selections of up to 10000 items,
+ * so that its linear growth can be checked.
+ *
+ * The selected files are created in a temporary directory, with names
+ * which embed spaces, quotes and percent signs.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib/gprintf.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <api/na-core-utils.h>
+
+#include <core/na-selected-info.h>
+#include <core/na-tokens.h>
+
+#define MIMETYPE					"application/x-compressed-tar"
+
+/* the singular form command-lines which also embed plural parameters
+ * are expanded as many times as there are items, each expansion being
+ * as long as the selection: they are only checked against this count
+ * of items
+ */
+#define MIXED_COUNT					100
+
+static const guint sizes[] = { 1250, 2500, 5000, 10000, 0 };
+
+/* the command-lines to be expanded
+ * a percent sign which terminates the command-line is not tested, as
+ * the previous implementation read beyond the end of the string
+ */
+static const gchar *commands[] = {
+		"/bin/echo %f",
+		"/bin/echo %F",
+		"/bin/echo %b",
+		"/bin/echo %B",
+		"/bin/echo %u",
+		"/bin/echo %U",
+		"/bin/echo %d",
+		"/bin/echo %D",
+		"/bin/echo --name=%w --ext=%x %m",
+		"/bin/echo %W %X %M",
+		"/bin/echo 100%% of %c: %f",
+		"/bin/echo '%f' \"%u\" %%f %z",
+		"/bin/echo %s://%h%p/%n %O %f",
+		"/bin/echo",
+		NULL
+};
+
+static const gchar *mixed_commands[] = {
+		"/bin/echo %f %F",
+		"/bin/echo %b in %D (%c)",
+		"/bin/echo %u %U %%",
+		"/bin/echo %o %F",
+		NULL
+};
+
+/* the tokens as they were stored by the previous implementation
+ */
+typedef struct {
+	guint    count;
+	GSList  *uris;
+	GSList  *filenames;
+	GSList  *basedirs;
+	GSList  *basenames;
+	GSList  *basenames_woext;
+	GSList  *exts;
+	GSList  *mimetypes;
+	gchar   *hostname;
+	gchar   *username;
+	guint    port;
+	gchar   *scheme;
+}
+	BaselineTokens;
+
+static GList          *create_selection( const gchar *root, guint size );
+static GList          *get_head( GList *selection, guint count );
+static BaselineTokens *baseline_new( GList *selection );
+static void            baseline_free( BaselineTokens *tokens );
+static GSList         *baseline_parse_for_execution( const BaselineTokens *tokens, const gchar *exec );
+static gboolean        baseline_is_singular( const gchar *exec );
+static gchar          *baseline_parse( const BaselineTokens *tokens, const gchar *input, guint i, gboolean quoted );
+static GString        *baseline_quote_nth( GString *input, GSList *names, guint i, gboolean quoted );
+static GString        *baseline_quote_string( GString *input, const gchar *name, gboolean quoted );
+static GString        *baseline_quote_string_list( GString *input, GSList *names, gboolean quoted );
+static guint           check_commands( GList *selection, const gchar **execs );
+static gdouble         time_expansion( GList *selection, gdouble *baseline_ms );
+static void            remove_tree( const gchar *path );
+
+int
+main( int argc, char** argv )
+{
+	gchar *root;
+	GError *error;
+	GList *selection, *head;
+	guint i, size, errors;
+	gdouble elapsed, baseline_ms, first;
+
+#if !GLIB_CHECK_VERSION( 2,36, 0 )
+	g_type_init();
+#endif
+
+	g_printf( "Tokens expansion test.\n\n" );
+
+	error = NULL;
+	root = g_dir_make_tmp( "na-tokens-XXXXXX", &error );
+	if( !root ){
+		g_printerr( "%s\n", error->message );
+		g_error_free( error );
+		return( EXIT_FAILURE );
+	}
+
+	size = sizes[G_N_ELEMENTS( sizes )-2];
+	selection = create_selection( root, size );
+
+	/* check the expansions against the previous implementation
+	 */
+	errors = check_commands( selection, commands );
+
+	head = get_head( selection, MIXED_COUNT );
+	errors += check_commands( head, mixed_commands );
+	g_list_free( head );
+
+	g_printf( "%u command-lines checked against %u items (%u for mixed forms): %u error(s)\n\n",
+			g_strv_length(( gchar ** ) commands ) + g_strv_length(( gchar ** ) mixed_commands ),
+			size, MIXED_COUNT, errors );
+
+	/* time the expansion of the command-lines for each size
+	 */
+	first = 0;
+	g_printf( "%8s %12s %12s %8s %14s\n", "items", "expand (ms)", "per item (us)", "ratio", "baseline (ms)" );
+
+	for( i = 0 ; sizes[i] ; ++i ){
+		head = get_head( selection, sizes[i] );
+		elapsed = time_expansion( head, &baseline_ms );
+		g_list_free( head );
+
+		if( !first ){
+			first = elapsed / sizes[0];
+		}
+		g_printf( "%8u %12.3f %12.3f %8.2f %14.3f\n",
+				sizes[i], elapsed, 1000 * elapsed / sizes[i],
+				first > 0 ? elapsed / sizes[i] / first : 0, baseline_ms );
+	}
+
+	g_list_free_full( selection, ( GDestroyNotify ) g_object_unref );
+	remove_tree( root );
+	g_free( root );
+
+	return( errors ? EXIT_FAILURE : EXIT_SUCCESS );
+}
+
+/*
+ * creates @size empty files, spread over two directories, and returns
+ * the list of the corresponding NASelectedInfo's, in creation order
+ */
+static GList *
+create_selection( const gchar *root, guint size )
+{
+	static const gchar *dirs[] = { "first dir", "it's the second dir", NULL };
+	GList *selection;
+	gchar *dir, *name, *path, *uri, *errmsg;
+	guint i;
+
+	for( i = 0 ; dirs[i] ; ++i ){
+		dir = g_build_filename( root, dirs[i], NULL );
+		g_mkdir( dir, 0750 );
+		g_free( dir );
+	}
+
+	selection = NULL;
+
+	for( i = 0 ; i < size ; ++i ){
+		name = g_strdup_printf( "file %05u \"%s\" 100%%.tar.gz", i, i % 3 ? "quoted" : "it's" );
+		path = g_build_filename( root, dirs[i % 2], name, NULL );
+		g_file_set_contents( path, "", 0, NULL );
+		uri = g_filename_to_uri( path, NULL, NULL );
+
+		errmsg = NULL;
+		selection = g_list_prepend( selection, na_selected_info_create_for_uri( uri, MIMETYPE, &errmsg ));
+		if( errmsg ){
+			g_printerr( "%s: %s\n", uri, errmsg );
+			g_free( errmsg );
+		}
+
+		g_free( uri );
+		g_free( path );
+		g_free( name );
+	}
+
+	return( g_list_reverse( selection ));
+}
+
+/*
+ * returns the first @count items of the @selection, as a new list which
+ * should be g_list_free() by the caller
+ */
+static GList *
+get_head( GList *selection, guint count )
+{
+	GList *head, *it;
+	guint i;
+
+	head = NULL;
+
+	for( it = selection, i = 0 ; it && i < count ; it = it->next, ++i ){
+		head = g_list_prepend( head, it->data );
+	}
+
+	return( g_list_reverse( head ));
+}
+
+static BaselineTokens *
+baseline_new( GList *selection )
+{
+	BaselineTokens *tokens;
+	NASelectedInfo *nsi;
+	GList *it;
+	gchar *basename, *bname_woext, *ext;
+
+	tokens = g_new0( BaselineTokens, 1 );
+	tokens->count = g_list_length( selection );
+
+	for( it = selection ; it ; it = it->next ){
+		nsi = NA_SELECTED_INFO( it->data );
+
+		if( it == selection ){
+			tokens->hostname = na_selected_info_get_uri_host( nsi );
+			tokens->username = na_selected_info_get_uri_user( nsi );
+			tokens->port = na_selected_info_get_uri_port( nsi );
+			tokens->scheme = na_selected_info_get_uri_scheme( nsi );
+		}
+
+		basename = na_selected_info_get_basename( nsi );
+		na_core_utils_dir_split_ext( basename, &bname_woext, &ext );
+
+		tokens->uris = g_slist_prepend( tokens->uris, na_selected_info_get_uri( nsi ));
+		tokens->filenames = g_slist_prepend( tokens->filenames, na_selected_info_get_path( nsi ));
+		tokens->basedirs = g_slist_prepend( tokens->basedirs, na_selected_info_get_dirname( nsi ));
+		tokens->basenames = g_slist_prepend( tokens->basenames, basename );
+		tokens->basenames_woext = g_slist_prepend( tokens->basenames_woext, bname_woext );
+		tokens->exts = g_slist_prepend( tokens->exts, ext );
+		tokens->mimetypes = g_slist_prepend( tokens->mimetypes, na_selected_info_get_mime_type( nsi ));
+	}
+
+	tokens->uris = g_slist_reverse( tokens->uris );
+	tokens->filenames = g_slist_reverse( tokens->filenames );
+	tokens->basedirs = g_slist_reverse( tokens->basedirs );
+	tokens->basenames = g_slist_reverse( tokens->basenames );
+	tokens->basenames_woext = g_slist_reverse( tokens->basenames_woext );
+	tokens->exts = g_slist_reverse( tokens->exts );
+	tokens->mimetypes = g_slist_reverse( tokens->mimetypes );
+
+	return( tokens );
+}
+
+static void
+baseline_free( BaselineTokens *tokens )
+{
+	na_core_utils_slist_free( tokens->uris );
+	na_core_utils_slist_free( tokens->filenames );
+	na_core_utils_slist_free( tokens->basedirs );
+	na_core_utils_slist_free( tokens->basenames );
+	na_core_utils_slist_free( tokens->basenames_woext );
+	na_core_utils_slist_free( tokens->exts );
+	na_core_utils_slist_free( tokens->mimetypes );
+	g_free( tokens->hostname );
+	g_free( tokens->username );
+	g_free( tokens->scheme );
+	g_free( tokens );
+}
+
+/*
+ * the command-lines which were run by the previous implementation of
+ * na_tokens_execute_action()
+ */
+static GSList *
+baseline_parse_for_execution( const BaselineTokens *tokens, const gchar *exec )
+{
+	GSList *commands;
+	guint i;
+
+	commands = NULL;
+
+	if( baseline_is_singular( exec )){
+		for( i = 0 ; i < tokens->count ; ++i ){
+			commands = g_slist_prepend( commands, baseline_parse( tokens, exec, i, TRUE ));
+		}
+
+	} else {
+		commands = g_slist_prepend( commands, baseline_parse( tokens, exec, 0, TRUE ));
+	}
+
+	return( g_slist_reverse( commands ));
+}
+
+static gboolean
+baseline_is_singular( const gchar *exec )
+{
+	const gchar *iter;
+
+	iter = exec;
+
+	while(( iter = g_strstr_len( iter, -1, "%" )) != NULL ){
+
+		if( strchr( "bdfmouwx", iter[1] )){
+			return( TRUE );
+		}
+		if( strchr( "BDFMOUWX", iter[1] )){
+			return( FALSE );
+		}
+
+		iter += 2;
+	}
+
+	return( FALSE );
+}
+
+/*
+ * the previous parse_singular(), which looked each singular parameter
+ * up in the lists, and always expanded the plural ones to the whole
+ * selection
+ */
+static gchar *
+baseline_parse( const BaselineTokens *tokens, const gchar *input, guint i, gboolean quoted )
+{
+	GString *output;
+	const gchar *iter, *prev_iter;
+
+	output = g_string_new( "" );
+	iter = input;
+	prev_iter = iter;
+
+	while(( iter = g_strstr_len( iter, -1, "%" ))){
+		output = g_string_append_len( output, prev_iter, strlen( prev_iter ) - strlen( iter ));
+
+		switch( iter[1] ){
+			case 'b':
+				output = baseline_quote_nth( output, tokens->basenames, i, quoted );
+				break;
+
+			case 'B':
+				output = baseline_quote_string_list( output, tokens->basenames, quoted );
+				break;
+
+			case 'c':
+				g_string_append_printf( output, "%d", tokens->count );
+				break;
+
+			case 'd':
+				output = baseline_quote_nth( output, tokens->basedirs, i, quoted );
+				break;
+
+			case 'D':
+				output = baseline_quote_string_list( output, tokens->basedirs, quoted );
+				break;
+
+			case 'f':
+				output = baseline_quote_nth( output, tokens->filenames, i, quoted );
+				break;
+
+			case 'F':
+				output = baseline_quote_string_list( output, tokens->filenames, quoted );
+				break;
+
+			case 'h':
+				if( tokens->hostname ){
+					output = baseline_quote_string( output, tokens->hostname, quoted );
+				}
+				break;
+
+			case 'm':
+				output = baseline_quote_nth( output, tokens->mimetypes, i, FALSE );
+				break;
+
+			case 'M':
+				output = baseline_quote_string_list( output, tokens->mimetypes, FALSE );
+				break;
+
+			case 'n':
+				if( tokens->username ){
+					output = baseline_quote_string( output, tokens->username, quoted );
+				}
+				break;
+
+			case 'p':
+				if( tokens->port > 0 ){
+					g_string_append_printf( output, "%d", tokens->port );
+				}
+				break;
+
+			case 's':
+				if( tokens->scheme ){
+					output = baseline_quote_string( output, tokens->scheme, quoted );
+				}
+				break;
+
+			case 'u':
+				output = baseline_quote_nth( output, tokens->uris, i, quoted );
+				break;
+
+			case 'U':
+				output = baseline_quote_string_list( output, tokens->uris, quoted );
+				break;
+
+			case 'w':
+				output = baseline_quote_nth( output, tokens->basenames_woext, i, quoted );
+				break;
+
+			case 'W':
+				output = baseline_quote_string_list( output, tokens->basenames_woext, quoted );
+				break;
+
+			case 'x':
+				output = baseline_quote_nth( output, tokens->exts, i, quoted );
+				break;
+
+			case 'X':
+				output = baseline_quote_string_list( output, tokens->exts, quoted );
+				break;
+
+			case '%':
+				output = g_string_append_c( output, '%' );
+				break;
+		}
+
+		iter += 2;
+		prev_iter = iter;
+	}
+
+	output = g_string_append_len( output, prev_iter, strlen( prev_iter ));
+
+	return( g_string_free( output, FALSE ));
+}
+
+static GString *
+baseline_quote_nth( GString *input, GSList *names, guint i, gboolean quoted )
+{
+	const gchar *nth;
+
+	nth = ( const gchar * ) g_slist_nth_data( names, i );
+	if( nth ){
+		input = baseline_quote_string( input, nth, quoted );
+	}
+
+	return( input );
+}
+
+static GString *
+baseline_quote_string( GString *input, const gchar *name, gboolean quoted )
+{
+	gchar *tmp;
+
+	if( quoted ){
+		tmp = g_shell_quote( name );
+		input = g_string_append( input, tmp );
+		g_free( tmp );
+
+	} else {
+		input = g_string_append( input, name );
+	}
+
+	return( input );
+}
+
+/*
+ * when not quoted, the previous implementation reversed the list in
+ * place, so the display of plural parameters is not compared
+ */
+static GString *
+baseline_quote_string_list( GString *input, GSList *names, gboolean quoted )
+{
+	GSList *it;
+
+	for( it = names ; it ; it = it->next ){
+		if( it != names ){
+			input = g_string_append_c( input, ' ' );
+		}
+		input = baseline_quote_string( input, ( const gchar * ) it->data, quoted );
+	}
+
+	return( input );
+}
+
+/*
+ * expands each of the @execs command-lines both for execution and for
+ * display, and compares the result with the previous implementation
+ *
+ * Returns: the count of the command-lines whose expansion differs.
+ */
+static guint
+check_commands( GList *selection, const gchar **execs )
+{
+	NATokens *tokens;
+	BaselineTokens *baseline;
+	GSList *got, *expected, *ig, *ie;
+	gchar *got_display, *expected_display;
+	guint i, errors, n;
+
+	tokens = na_tokens_new_from_selection( selection );
+	baseline = baseline_new( selection );
+	errors = 0;
+
+	for( i = 0 ; execs[i] ; ++i ){
+		got = na_tokens_parse_for_execution( tokens, execs[i], 1 );
+		expected = baseline_parse_for_execution( baseline, execs[i] );
+
+		if( g_slist_length( got ) != g_slist_length( expected )){
+			g_printf( "%s: %u command(s) instead of %u\n",
+					execs[i], g_slist_length( got ), g_slist_length( expected ));
+			errors += 1;
+
+		} else {
+			for( ig = got, ie = expected, n = 0 ; ig ; ig = ig->next, ie = ie->next, ++n ){
+				if( strcmp(( const gchar * ) ig->data, ( const gchar * ) ie->data )){
+					g_printf( "%s: command #%u differs:\n got: %s\n expected: %s\n",
+							execs[i], n, ( const gchar * ) ig->data, ( const gchar * ) ie->data );
+					errors += 1;
+					break;
+				}
+			}
+		}
+
+		na_core_utils_slist_free( got );
+		na_core_utils_slist_free( expected );
+
+		if( !strpbrk( execs[i], "BDFMUWX" )){
+			got_display = na_tokens_parse_for_display( tokens, execs[i], FALSE );
+			expected_display = baseline_parse( baseline, execs[i], 0, FALSE );
+			if( strcmp( got_display, expected_display )){
+				g_printf( "%s: display differs:\n got: %s\n expected: %s\n",
+						execs[i], got_display, expected_display );
+				errors += 1;
+			}
+			g_free( expected_display );
+			g_free( got_display );
+		}
+	}
+
+	baseline_free( baseline );
+	g_object_unref( tokens );
+
+	return( errors );
+}
+
+/*
+ * Returns: the elapsed time of the expansion of all the command-lines
+ * for the @selection, in msec; the time of the previous implementation
+ * is set in @baseline_ms.
+ */
+static gdouble
+time_expansion( GList *selection, gdouble *baseline_ms )
+{
+	NATokens *tokens;
+	BaselineTokens *baseline;
+	GTimer *timer;
+	gdouble elapsed;
+	guint i;
+
+	tokens = na_tokens_new_from_selection( selection );
+	baseline = baseline_new( selection );
+	timer = g_timer_new();
+
+	for( i = 0 ; commands[i] ; ++i ){
+		na_core_utils_slist_free( na_tokens_parse_for_execution( tokens, commands[i], 1 ));
+	}
+	elapsed = 1000 * g_timer_elapsed( timer, NULL );
+
+	g_timer_start( timer );
+	for( i = 0 ; commands[i] ; ++i ){
+		na_core_utils_slist_free( baseline_parse_for_execution( baseline, commands[i] ));
+	}
+	*baseline_ms = 1000 * g_timer_elapsed( timer, NULL );
+
+	g_timer_destroy( timer );
+	baseline_free( baseline );
+	g_object_unref( tokens );
+
+	return( elapsed );
+}
+
+static void
+remove_tree( const gchar *path )
+{
+	GDir *dir;
+	const gchar *name;
+	gchar *child;
+
+	if( g_file_test( path, G_FILE_TEST_IS_DIR )){
+		dir = g_dir_open( path, 0, NULL );
+		if( dir ){
+			while(( name = g_dir_read_name( dir )) != NULL ){
+				child = g_build_filename( path, name, NULL );
+				remove_tree( child );
+				g_free( child );
+			}
+			g_dir_close( dir );
+		}
+	}
+
+	g_remove( path );
+}
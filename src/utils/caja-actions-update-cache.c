@@ -0,0 +1,184 @@
+/*
+ * Caja-Actions
+ * A Caja extension which offers configurable context menu actions.
+ *
+ * Copyright (C) 2005 The GNOME Foundation
+ * Copyright (C) 2006-2008 Frederic Ruaudel and others (see AUTHORS)
+ * Copyright (C) 2009-2012 Pierre Wieser and others (see AUTHORS)
+ * Copyright (C) 2012-2017 Wolfgang Ulbrich and others (see AUTHORS)
+ *
+ * Caja-Actions is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General  Public  License  as
+ * published by the Free Software Foundation; either  version  2  of
+ * the License, or (at your option) any later version.
+ *
+ * Caja-Actions is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even  the  implied  warranty  of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See  the  GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public  License
+ * along with Caja-Actions; see the file  COPYING.  If  not,  see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * Authors:
+ *   Frederic Ruaudel <grumz@grumz.net>
+ *   Rodrigo Moya <rodrigo@mate-db.org>
+ *   Pierre Wieser <pwieser@trychlos.org>
+ *   ... and many others (see AUTHORS)
+ */
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <locale.h>
+#include <stdlib.h>
+
+#include <api/na-core-utils.h>
+#include <api/na-object-api.h>
+
+#include <core/na-pivot.h>
+
+#include "console-utils.h"
+
+static gboolean   verbose          = FALSE;
+static gboolean   version          = FALSE;
+
+/* i18n: caja-actions-update-cache program summary */
+static const gchar *program_summary = N_( "Update the cache of the menus and actions read from .desktop files." );
+
+static GOptionEntry entries[] = {
+
+	{ "verbose"              , 'V', 0, G_OPTION_ARG_NONE        , &verbose,
+			N_( "Print the count of loaded menus and actions" ), NULL },
+	{ NULL }
+};
+
+static GOptionEntry misc_entries[] = {
+
+	{ "version"              , 'v', 0, G_OPTION_ARG_NONE        , &version,
+			N_( "Output the version number" ), NULL },
+	{ NULL }
+};
+
+static GOptionContext  *init_options( void );
+static guint            count_items( GList *tree );
+static void             exit_with_usage( void );
+
+/*
+ * The .desktop files are only parsed again if they, or their directory,
+ * have changed since the cache has been written; the cache is then
+ * rewritten by the I/O provider itself.
+ *
+ * As the cache is per user, and depends on the locale, this should be
+ * run as the user, e.g. at session startup, or after actions have been
+ * deployed.
+ */
+int
+main( int argc, char** argv )
+{
+	int status = EXIT_SUCCESS;
+	GOptionContext *context;
+	GError *error = NULL;
+	NAPivot *pivot;
+
+#if !GLIB_CHECK_VERSION( 2,36, 0 )
+	g_type_init();
+#endif
+
+	setlocale( LC_ALL, "" );
+	console_init_log_handler();
+
+	context = init_options();
+
+	if( !g_option_context_parse( context, &argc, &argv, &error )){
+		g_printerr( _( "Syntax error: %s\n" ), error->message );
+		g_error_free (error);
+		exit_with_usage();
+	}
+
+	g_option_context_free( context );
+
+	if( version ){
+		na_core_utils_print_version();
+		exit( status );
+	}
+
+	pivot = na_pivot_new();
+	na_pivot_set_loadable( pivot, PIVOT_LOAD_ALL );
+	na_pivot_load_items( pivot );
+
+	if( verbose ){
+		/* i18n: %u stands for the count of loaded menus and actions */
+		g_print( _( "%u menus and actions loaded.\n" ), count_items( na_pivot_get_items( pivot )));
+	}
+
+	g_object_unref( pivot );
+
+	exit( status );
+}
+
+/*
+ * init options context
+ */
+static GOptionContext *
+init_options( void )
+{
+	GOptionContext *context;
+	gchar* description;
+	GOptionGroup *misc_group;
+
+	context = g_option_context_new( program_summary );
+	g_option_context_set_translation_domain( context, GETTEXT_PACKAGE );
+
+#ifdef ENABLE_NLS
+	bindtextdomain( GETTEXT_PACKAGE, MATELOCALEDIR );
+# ifdef HAVE_BIND_TEXTDOMAIN_CODESET
+	bind_textdomain_codeset( GETTEXT_PACKAGE, "UTF-8" );
+# endif
+	textdomain( GETTEXT_PACKAGE );
+	g_option_context_add_main_entries( context, entries, GETTEXT_PACKAGE );
+#else
+	g_option_context_add_main_entries( context, entries, NULL );
+#endif
+
+	description = console_cmdline_get_description();
+	g_option_context_set_description( context, description );
+	g_free( description );
+
+	misc_group = g_option_group_new(
+			"misc", _( "Miscellaneous options" ), _( "Miscellaneous options" ), NULL, NULL );
+	g_option_group_add_entries( misc_group, misc_entries );
+	g_option_group_set_translation_domain( misc_group, GETTEXT_PACKAGE );
+	g_option_context_add_group( context, misc_group );
+
+	return( context );
+}
+
+static guint
+count_items( GList *tree )
+{
+	guint count;
+	GList *it;
+
+	for( count = 0, it = tree ; it ; it = it->next ){
+		count += 1;
+		if( NA_IS_OBJECT_MENU( it->data )){
+			count += count_items( na_object_get_items( it->data ));
+		}
+	}
+
+	return( count );
+}
+
+/*
+ * print a help message and exit with failure
+ */
+static void
+exit_with_usage( void )
+{
+	g_printerr( _( "Try %s --help for usage.\n" ), g_get_prgname());
+	exit( EXIT_FAILURE );
+}